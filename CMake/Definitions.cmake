@@ -93,6 +93,8 @@ foreach(
   REMAP_KEYBOARD_KEYS
   DEVILUTIONX_DEFAULT_RESAMPLER
   STREAM_ALL_AUDIO_MIN_FILE_SIZE
+  DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE
+  DEVILUTIONX_ASSET_PREFETCH_BUDGET
   DEVILUTIONX_DISPLAY_TEXTURE_FORMAT
   DEVILUTIONX_SCREENSHOT_FORMAT
   DARWIN_MAJOR_VERSION
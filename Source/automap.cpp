@@ -7,6 +7,9 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <optional>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -1529,6 +1532,210 @@ std::unique_ptr<AutomapTile[]> LoadAutomapData(size_t &tileCount)
 	}
 }
 
+/**
+ * @brief Draws the automap tiles in the same order as the original game.
+ *
+ * Each row draws `columns` tiles, then `columns + 1` tiles shifted half a tile down and left.
+ */
+void DrawAutomapTiles(const Surface &out, Point screen, Point map, int columns, int rows)
+{
+	for (int i = 0; i < rows; i++) {
+		Point tile1 = screen;
+		for (int j = 0; j < columns; j++) {
+			DrawAutomapTile(out, tile1, { map.x + j, map.y - j });
+			tile1.x += AmOffset(AmWidthOffset::DoubleTileRight, AmHeightOffset::None).deltaX;
+		}
+		map.y++;
+
+		Point tile2 = screen + AmOffset(AmWidthOffset::FullTileLeft, AmHeightOffset::FullTileDown);
+		for (int j = 0; j <= columns; j++) {
+			DrawAutomapTile(out, tile2, { map.x + j, map.y - j });
+			tile2.x += AmOffset(AmWidthOffset::DoubleTileRight, AmHeightOffset::None).deltaX;
+		}
+		map.x++;
+		screen.y += AmOffset(AmWidthOffset::None, AmHeightOffset::DoubleTileDown).deltaY;
+	}
+}
+
+/**
+ * @brief Returns where `DrawAutomapTiles` draws the tile `map`, relative to the first tile at `origin`.
+ */
+Displacement GetAutomapTileOffset(Point origin, Point map)
+{
+	const int u = map.x - origin.x;
+	const int v = map.y - origin.y;
+	const int rowOffset = u + v;
+	const int columnOffset = u - v;
+	const int doubleTileWidth = AmOffset(AmWidthOffset::DoubleTileRight, AmHeightOffset::None).deltaX;
+	const int doubleTileHeight = AmOffset(AmWidthOffset::None, AmHeightOffset::DoubleTileDown).deltaY;
+	if (rowOffset % 2 == 0)
+		return { columnOffset / 2 * doubleTileWidth, rowOffset / 2 * doubleTileHeight };
+	return Displacement { (columnOffset + 1) / 2 * doubleTileWidth, (rowOffset - 1) / 2 * doubleTileHeight }
+	    + AmOffset(AmWidthOffset::FullTileLeft, AmHeightOffset::FullTileDown);
+}
+
+/**
+ * @brief Whether two tiles are always one double tile apart, regardless of which of the two rows of `DrawAutomapTiles` they are in.
+ *
+ * Not the case for scales where a double tile is not exactly twice as large as a full tile due to rounding.
+ */
+bool IsAutomapTileGridUniform()
+{
+	const Displacement doubleTile = AmOffset(AmWidthOffset::DoubleTileRight, AmHeightOffset::DoubleTileDown);
+	const Displacement fullTile = AmOffset(AmWidthOffset::FullTileRight, AmHeightOffset::FullTileDown);
+	return doubleTile.deltaX == 2 * fullTile.deltaX && doubleTile.deltaY == 2 * fullTile.deltaY;
+}
+
+/** @brief How many double tiles the cached layer extends past the view on each side, so that scrolling does not require redrawing it. */
+constexpr int AutomapLayerMarginTiles = 2;
+
+/** @brief Everything other than the scroll position and the explored tiles that affects how the automap tiles look. */
+struct AutomapLayerKey {
+	AutomapType type;
+	int scale;
+	Point viewPosition;
+	Size viewSize;
+	dungeon_type levelType;
+	bool setLevel;
+	_setlevels setLevelNum;
+	quest_state poisonedWaterState;
+
+	bool operator==(const AutomapLayerKey &other) const = default;
+};
+
+struct AutomapLayerSpan {
+	int x;
+	int y;
+	int length;
+};
+
+/**
+ * @brief The automap tiles around the view, drawn once and then copied to the screen every frame.
+ *
+ * Only used for the opaque map and the minimap. The transparent map blends every pixel
+ * with what is below it, including earlier lines, so it is always drawn directly.
+ */
+struct AutomapLayer {
+	std::optional<OwnedSurface> surface;
+	/** @brief 1 for every pixel of `surface` that was drawn. */
+	std::vector<uint8_t> mask;
+	/** @brief Horizontal runs of drawn pixels. */
+	std::vector<AutomapLayerSpan> spans;
+	AutomapLayerKey key;
+	/** @brief The first tile drawn into the layer. */
+	Point map;
+	/** @brief Position of the first tile in the layer. */
+	Point screen;
+	uint8_t automapView[DMAXX][DMAXY];
+	uint8_t dungeon[DMAXX][DMAXY];
+	bool valid = false;
+};
+
+AutomapLayer CachedAutomapLayer;
+
+AutomapLayerKey GetAutomapLayerKey(const Surface &out, int scale)
+{
+	const bool isMinimap = GetAutomapType() == AutomapType::Minimap;
+	return AutomapLayerKey {
+		GetAutomapType(),
+		scale,
+		isMinimap ? MinimapRect.position : Point { 0, 0 },
+		isMinimap ? MinimapRect.size : Size { out.w(), out.h() },
+		leveltype,
+		setlevel,
+		setlvlnum,
+		Quests[Q_PWATER]._qactive,
+	};
+}
+
+void BuildAutomapLayer(const AutomapLayerKey &key, Point screen, Point map, int cells)
+{
+	AutomapLayer &layer = CachedAutomapLayer;
+	const Displacement doubleTile = AmOffset(AmWidthOffset::DoubleTileRight, AmHeightOffset::DoubleTileDown);
+	const Displacement margin = doubleTile * AutomapLayerMarginTiles;
+	const Size size { key.viewSize.width + 2 * margin.deltaX, key.viewSize.height + 2 * margin.deltaY };
+	if (!layer.surface || layer.surface->w() != size.width || layer.surface->h() != size.height)
+		layer.surface.emplace(size);
+	layer.mask.assign(static_cast<size_t>(layer.surface->pitch()) * size.height, 0);
+
+	// Start one tile further out than the margin in every direction.
+	// Moving the first tile by an even number of rows keeps the tile grid the same.
+	const int extraTiles = AutomapLayerMarginTiles + 1;
+	const Displacement layerOrigin = (key.viewPosition - margin) - Point { 0, 0 };
+	layer.map = map + Displacement { -2 * extraTiles, 0 };
+	layer.screen = screen - layerOrigin - doubleTile * extraTiles;
+
+	SetAutomapLayerMask(layer.mask.data());
+	DrawAutomapTiles(*layer.surface, layer.screen, layer.map, cells + 2 * extraTiles, cells + 2 + 2 * extraTiles);
+	SetAutomapLayerMask(nullptr);
+
+	layer.spans.clear();
+	for (int y = 0; y < size.height; y++) {
+		const uint8_t *row = &layer.mask[static_cast<size_t>(y) * layer.surface->pitch()];
+		for (int x = 0; x < size.width;) {
+			if (row[x] == 0) {
+				x++;
+				continue;
+			}
+			const int begin = x;
+			while (x < size.width && row[x] != 0)
+				x++;
+			layer.spans.push_back({ begin, y, x - begin });
+		}
+	}
+
+	layer.key = key;
+	memcpy(layer.automapView, AutomapView, sizeof(layer.automapView));
+	memcpy(layer.dungeon, dungeon, sizeof(layer.dungeon));
+	layer.valid = true;
+}
+
+/**
+ * @brief Draws the automap tiles from `CachedAutomapLayer`, rebuilding it first if needed.
+ *
+ * Takes the same parameters as `DrawAutomapTiles` for the visible tiles.
+ */
+void DrawAutomapTilesFromLayer(const Surface &out, Point screen, Point map, int cells, int scale)
+{
+	AutomapLayer &layer = CachedAutomapLayer;
+	const AutomapLayerKey key = GetAutomapLayerKey(out, scale);
+
+	bool rebuild = !layer.valid
+	    || layer.key != key
+	    || memcmp(layer.automapView, AutomapView, sizeof(layer.automapView)) != 0
+	    || memcmp(layer.dungeon, dungeon, sizeof(layer.dungeon)) != 0;
+
+	// Where the layer needs to be drawn so that its tiles line up with the ones on screen.
+	Displacement offset = screen - (layer.screen + GetAutomapTileOffset(layer.map, map));
+	if (!rebuild) {
+		const bool sameGrid = ((map.x + map.y - layer.map.x - layer.map.y) % 2) == 0 || IsAutomapTileGridUniform();
+		const Point viewInLayer = key.viewPosition - offset;
+		rebuild = !sameGrid
+		    || viewInLayer.x < 0 || viewInLayer.y < 0
+		    || viewInLayer.x + key.viewSize.width > layer.surface->w()
+		    || viewInLayer.y + key.viewSize.height > layer.surface->h();
+	}
+	if (rebuild) {
+		BuildAutomapLayer(key, screen, map, cells);
+		offset = screen - (layer.screen + GetAutomapTileOffset(layer.map, map));
+	}
+
+	const int clipLeft = std::max(key.viewPosition.x, 0);
+	const int clipTop = std::max(key.viewPosition.y, 0);
+	const int clipRight = std::min(key.viewPosition.x + key.viewSize.width, out.w());
+	const int clipBottom = std::min(key.viewPosition.y + key.viewSize.height, out.h());
+	for (const AutomapLayerSpan &span : layer.spans) {
+		const int y = span.y + offset.deltaY;
+		if (y < clipTop || y >= clipBottom)
+			continue;
+		const int begin = std::max(span.x + offset.deltaX, clipLeft);
+		const int end = std::min(span.x + span.length + offset.deltaX, clipRight);
+		if (begin >= end)
+			continue;
+		memcpy(out.at(begin, y), layer.surface->at(begin - offset.deltaX, span.y), end - begin);
+	}
+}
+
 } // namespace
 
 bool AutomapActive;
@@ -1679,6 +1886,7 @@ void InitAutomap()
 	}
 
 	memset(AutomapView, 0, sizeof(AutomapView));
+	CachedAutomapLayer.valid = false;
 
 	for (auto &column : dFlags)
 		for (auto &dFlag : column)
@@ -1825,23 +2033,17 @@ void DrawAutomap(const Surface &out)
 		}
 	}
 
-	Point map = { Automap.x - cells, Automap.y - 1 };
-
-	for (int i = 0; i <= cells + 1; i++) {
-		Point tile1 = screen;
-		for (int j = 0; j < cells; j++) {
-			DrawAutomapTile(out, tile1, { map.x + j, map.y - j });
-			tile1.x += AmOffset(AmWidthOffset::DoubleTileRight, AmHeightOffset::None).deltaX;
-		}
-		map.y++;
+	const Point map = { Automap.x - cells, Automap.y - 1 };
 
-		Point tile2 = screen + AmOffset(AmWidthOffset::FullTileLeft, AmHeightOffset::FullTileDown);
-		for (int j = 0; j <= cells; j++) {
-			DrawAutomapTile(out, tile2, { map.x + j, map.y - j });
-			tile2.x += AmOffset(AmWidthOffset::DoubleTileRight, AmHeightOffset::None).deltaX;
-		}
-		map.x++;
-		screen.y += AmOffset(AmWidthOffset::None, AmHeightOffset::DoubleTileDown).deltaY;
+	bool useLayer = GetAutomapType() != AutomapType::Transparent;
+#ifdef _DEBUG
+	if (DebugVision)
+		useLayer = false;
+#endif
+	if (useLayer) {
+		DrawAutomapTilesFromLayer(out, screen, map, cells, scale);
+	} else {
+		DrawAutomapTiles(out, screen, map, cells, cells + 2);
 	}
 
 	for (const Player &player : Players) {
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <cstring>
 
+#include <SDL_endian.h>
+
 #include "appfat.h"
 #include "sha.h"
 #include "utils/endian_read.hpp"
@@ -254,7 +254,7 @@ bool TrySelectPixelBased(Point tile)
 		return false;
 	}
 
-	auto checkSprite = [](Point renderingTile, const ClxSprite sprite, Displacement renderingOffset) {
+	auto checkSprite = [](Point renderingTile, const ClxSprite sprite, Displacement renderingOffset, const uint8_t *trn = nullptr) {
 		const Point renderPosition = GetScreenPosition(renderingTile) + renderingOffset;
 		Point spriteTopLeft = renderPosition - Displacement { 0, sprite.height() };
 		Size spriteSize = { sprite.width(), sprite.height() };
@@ -268,7 +268,7 @@ bool TrySelectPixelBased(Point tile)
 		Point pointInSprite = Point { 0, 0 } + (MousePosition - spriteCoords.position);
 		if (*GetOptions().Graphics.zoom)
 			pointInSprite /= 2;
-		return IsPointWithinClx(pointInSprite, sprite);
+		return IsPointWithinClx(pointInSprite, sprite, trn);
 	};
 
 	auto convertFromRenderingToWorldTile = [](Point renderingPoint) {
@@ -308,7 +308,7 @@ bool TrySelectPixelBased(Point tile)
 				if (IsTileLit(adjacentTile) && IsValidMonsterForSelection(monster)) {
 					const ClxSprite sprite = monster.animInfo.currentSprite();
 					const Displacement renderingOffset = monster.getRenderingOffset(sprite);
-					if (checkSprite(adjacentTile, sprite, renderingOffset)) {
+					if (checkSprite(adjacentTile, sprite, renderingOffset, monster.type().getTRN(sprite))) {
 						cursPosition = adjacentTile;
 						pcursmonst = monsterId;
 						return true;
@@ -30,6 +30,7 @@ void InitDeadAnimationFromMonster(Corpse &corpse, const CMonster &mon)
 	}
 	corpse.frame = animData.frames - 1;
 	corpse.width = animData.width;
+	corpse.trn = mon.trn.get();
 }
 
 void MoveLightToCorpse(Monster &monster)
@@ -72,6 +73,7 @@ void InitCorpses()
 	Corpses[nd].frame = 11;
 	Corpses[nd].width = 128;
 	Corpses[nd].translationPaletteIndex = 0;
+	Corpses[nd].trn = nullptr;
 	nd++;
 
 	stonendx = nd;
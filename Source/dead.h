@@ -21,6 +21,8 @@ struct Corpse {
 	int frame;
 	uint16_t width;
 	uint8_t translationPaletteIndex;
+	/** @brief The TRN of the monster type, applied before any other TRN. */
+	const uint8_t *trn;
 
 	/**
 	 * @brief Returns the sprite list for a given direction.
@@ -31,6 +31,7 @@
 #include "discord/discord.h"
 #include "doom.h"
 #include "encrypt.h"
+#include "engine/asset_prefetch.hpp"
 #include "engine/backbuffer_state.hpp"
 #include "engine/clx_sprite.hpp"
 #include "engine/demomode.h"
@@ -40,6 +41,7 @@
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "engine/render/clx_render.hpp"
+#include "engine/render/render_workers.hpp"
 #include "engine/sound.h"
 #include "game_mode.hpp"
 #include "gamemenu.h"
@@ -161,6 +163,8 @@ bool was_archives_init = false;
 /** To know if surfaces have been initialized or not */
 bool was_window_init = false;
 bool was_ui_init = false;
+/** Asset path of `pDungeonCels`, used as the converted asset cache key. */
+std::string_view DungeonCelsPath;
 
 void StartGame(interface_mode uMsg)
 {
@@ -201,6 +205,7 @@ void FreeGame()
 	FreeDebugGFX();
 #endif
 	FreeGameMem();
+	CancelAssetPrefetch();
 	stream_stop();
 	music_stop();
 }
@@ -1287,6 +1292,7 @@ void DiabloDeinit()
 		UiDestroy();
 	if (was_archives_init)
 		init_cleanup();
+	ShutdownRenderWorkers();
 	if (was_window_init)
 		dx_cleanup(); // Cleanup SDL surfaces stuff, so we have to do it before SDL_Quit().
 	UnloadFonts();
@@ -1301,6 +1307,7 @@ tl::expected<void, std::string> LoadLvlGFX()
 
 	const auto loadAll = [](const char *cel, const char *til, const char *special) -> tl::expected<void, std::string> {
 		ASSIGN_OR_RETURN(pDungeonCels, LoadFileInMemWithStatus(cel));
+		DungeonCelsPath = cel;
 		ASSIGN_OR_RETURN(pMegaTiles, LoadFileInMemWithStatus<MegaTile>(til));
 		ASSIGN_OR_RETURN(pSpecialCels, LoadCelWithStatus(special, SpecialCelWidth));
 		return {};
@@ -1311,8 +1318,10 @@ tl::expected<void, std::string> LoadLvlGFX()
 		auto cel = LoadFileInMemWithStatus("nlevels\\towndata\\town.cel");
 		if (!cel.has_value()) {
 			ASSIGN_OR_RETURN(pDungeonCels, LoadFileInMemWithStatus("levels\\towndata\\town.cel"));
+			DungeonCelsPath = "levels\\towndata\\town.cel";
 		} else {
 			pDungeonCels = std::move(*cel);
+			DungeonCelsPath = "nlevels\\towndata\\town.cel";
 		}
 		auto til = LoadFileInMemWithStatus<MegaTile>("nlevels\\towndata\\town.til");
 		if (!til.has_value()) {
@@ -1498,6 +1507,7 @@ void GameLogic()
 
 	sound_update();
 	CheckTriggers();
+	PrefetchTriggerLevels();
 	CheckQuests();
 	RedrawViewport();
 	pfile_update(false);
@@ -3289,7 +3299,7 @@ tl::expected<void, std::string> LoadGameLevel(bool firstflag, lvl_entry lvldir)
 	IncProgress();
 
 	RETURN_IF_ERROR(LoadLvlGFX());
-	SetDungeonMicros(pDungeonCels, MicroTileLen);
+	SetDungeonMicros(pDungeonCels, MicroTileLen, DungeonCelsPath);
 	ClearClxDrawCache();
 
 	IncProgress();
@@ -29,6 +29,7 @@ public:
 	virtual bool SNetDropPlayer(int playerid, uint32_t flags) = 0;
 	virtual bool SNetGetOwnerTurnsWaiting(uint32_t *turns) = 0;
 	virtual bool SNetGetTurnsInTransit(uint32_t *turns) = 0;
+	virtual bool SNetFlush() = 0;
 	virtual void setup_gameinfo(buffer_t info) = 0;
 	virtual ~abstract_net() = default;
 
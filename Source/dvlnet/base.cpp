@@ -4,10 +4,14 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <span>
 
 #include <expected.hpp>
 
+#include "options.h"
 #include "player.h"
+#include "utils/language.h"
+#include "utils/log.hpp"
 
 namespace devilution {
 namespace net {
@@ -48,7 +52,7 @@ tl::expected<void, PacketError> base::SendEchoRequest(plr_t player)
 
 	const timestamp_t now = SDL_GetTicks();
 	tl::expected<std::unique_ptr<packet>, PacketError> pkt
-	    = pktfty->make_packet<PT_ECHO_REQUEST>(plr_self, player, now);
+	    = pktfty->make_packet<PT_ECHO_REQUEST>(plr_self, player, now, LocalFeatures());
 	if (!pkt.has_value()) {
 		return tl::make_unexpected(pkt.error());
 	}
@@ -89,8 +93,10 @@ tl::expected<void, PacketError> base::HandleAccept(packet &pkt)
 
 tl::expected<void, PacketError> base::HandleConnect(packet &pkt)
 {
-	return pkt.NewPlayer().transform([this](plr_t &&newPlayer) {
+	return pkt.NewPlayer().and_then([this](plr_t &&newPlayer) {
 		Connect(newPlayer);
+		// The echo exchange tells both players which protocol features the other one supports.
+		return SendEchoRequest(newPlayer);
 	});
 }
 
@@ -105,13 +111,38 @@ tl::expected<void, PacketError> base::HandleTurn(packet &pkt)
 	});
 }
 
+tl::expected<void, PacketError> base::HandleBatch(packet &pkt)
+{
+	const plr_t src = pkt.Source();
+	if (src >= MAX_PLRS)
+		return tl::make_unexpected("Invalid batch source");
+	PlayerState &playerState = playerStateTable_[src];
+	return pkt.Batch().and_then([&](const buffer_t *batch) {
+		return playerState.incomingBatch.Decode(
+		    *batch,
+		    [&](turn_t turn) {
+			    playerState.turnQueue.push_back(turn);
+			    MakeReady(turn.SequenceNumber);
+		    },
+		    [&](std::span<const unsigned char> message) {
+			    message_queue.emplace_back(src, buffer_t(message.begin(), message.end()));
+		    });
+	});
+}
+
 tl::expected<void, PacketError> base::HandleDisconnect(packet &pkt)
 {
 	tl::expected<plr_t, PacketError> newPlayer = pkt.NewPlayer();
 	if (!newPlayer.has_value())
 		return tl::make_unexpected(newPlayer.error());
-	if (*newPlayer == plr_self)
+	if (*newPlayer == plr_self) {
+		if (plr_self == PLR_BROADCAST) {
+			tl::expected<leaveinfo_t, PacketError> leaveinfo = pkt.LeaveInfo();
+			if (leaveinfo.has_value() && *leaveinfo == LEAVE_NO_GAME)
+				return tl::make_unexpected(_("No game has been created on this server yet."));
+		}
 		return tl::make_unexpected("We were dropped by the owner?");
+	}
 	if (IsConnected(*newPlayer)) {
 		tl::expected<leaveinfo_t, PacketError> leaveinfo = pkt.LeaveInfo();
 		if (!leaveinfo.has_value())
@@ -127,15 +158,23 @@ tl::expected<void, PacketError> base::HandleDisconnect(packet &pkt)
 		PlayerState &playerState = playerStateTable_[*newPlayer];
 		playerState.isConnected = false;
 		playerState.turnQueue.clear();
+		ResetPlayerState(*newPlayer);
 	}
 	return {};
 }
 
 tl::expected<void, PacketError> base::HandleEchoRequest(packet &pkt)
 {
+	const plr_t src = pkt.Source();
+	if (src < MAX_PLRS) {
+		tl::expected<features_t, PacketError> features = pkt.Features();
+		if (!features.has_value())
+			return tl::make_unexpected(features.error());
+		playerStateTable_[src].features = *features;
+	}
 	return pkt.Time()
 	    .and_then([&](cookie_t &&pktTime) {
-		    return pktfty->make_packet<PT_ECHO_REPLY>(plr_self, pkt.Source(), pktTime);
+		    return pktfty->make_packet<PT_ECHO_REPLY>(plr_self, src, pktTime, LocalFeatures());
 	    })
 	    .and_then([&](std::unique_ptr<packet> &&pkt) {
 		    return send(*pkt);
@@ -146,10 +185,58 @@ tl::expected<void, PacketError> base::HandleEchoReply(packet &pkt)
 {
 	const uint32_t now = SDL_GetTicks();
 	plr_t src = pkt.Source();
-	return pkt.Time().transform([&](cookie_t &&pktTime) {
-		PlayerState &playerState = playerStateTable_[src];
-		playerState.roundTripLatency = now - pktTime;
-	});
+	if (src >= MAX_PLRS)
+		return {};
+	PlayerState &playerState = playerStateTable_[src];
+	return pkt.Features()
+	    .and_then([&](features_t &&features) {
+		    playerState.features = features;
+		    return pkt.Time();
+	    })
+	    .transform([&](cookie_t &&pktTime) {
+		    playerState.roundTripLatency = now - pktTime;
+	    });
+}
+
+features_t base::LocalFeatures()
+{
+	return *GetOptions().Network.batchTurns ? FEATURE_BATCH : 0;
+}
+
+bool base::UseBatches() const
+{
+	if (plr_self >= MAX_PLRS || (LocalFeatures() & FEATURE_BATCH) == 0)
+		return false;
+	// Everyone has to support batches: a player that does not would still need the
+	// individual packets, and the others must not receive everything twice.
+	bool havePeers = false;
+	for (plr_t player = 0; player < playerStateTable_.size(); ++player) {
+		const PlayerState &playerState = playerStateTable_[player];
+		if (player == plr_self || !playerState.isConnected)
+			continue;
+		if ((playerState.features & FEATURE_BATCH) == 0)
+			return false;
+		havePeers = true;
+	}
+	return havePeers;
+}
+
+tl::expected<void, PacketError> base::FlushBatch()
+{
+	if (outgoingBatch_.empty())
+		return {};
+	tl::expected<std::unique_ptr<packet>, PacketError> pkt
+	    = pktfty->make_packet<PT_BATCH>(plr_self, PLR_BROADCAST, outgoingBatch_.Finish());
+	if (!pkt.has_value())
+		return tl::make_unexpected(pkt.error());
+	return send(**pkt);
+}
+
+void base::ResetPlayerState(plr_t player)
+{
+	PlayerState &playerState = playerStateTable_[player];
+	playerState.features = {};
+	playerState.incomingBatch.Reset();
 }
 
 void base::ClearMsg(plr_t plr)
@@ -168,8 +255,14 @@ tl::expected<void, PacketError> base::Connect(plr_t player)
 	const bool wasConnected = playerState.isConnected;
 	playerState.isConnected = true;
 
-	if (!wasConnected)
+	if (!wasConnected) {
+		ResetPlayerState(player);
+		// The new player has not received the turns that the next ones would be delta-encoded against.
+		if (tl::expected<void, PacketError> result = FlushBatch(); !result.has_value())
+			return result;
+		outgoingBatch_.Reset();
 		return SendFirstTurnIfReady(player);
+	}
 	return {};
 }
 
@@ -194,6 +287,8 @@ tl::expected<void, PacketError> base::RecvLocal(packet &pkt)
 		});
 	case PT_TURN:
 		return HandleTurn(pkt);
+	case PT_BATCH:
+		return HandleBatch(pkt);
 	case PT_JOIN_ACCEPT:
 		return HandleAccept(pkt);
 	case PT_CONNECT:
@@ -212,6 +307,8 @@ tl::expected<void, PacketError> base::RecvLocal(packet &pkt)
 
 bool base::SNetReceiveMessage(uint8_t *sender, void **data, size_t *size)
 {
+	// Messages sent outside of a game tick would otherwise wait for the end of the next one.
+	SNetFlush();
 	poll();
 	if (message_queue.empty())
 		return false;
@@ -236,7 +333,21 @@ bool base::SNetSendMessage(uint8_t playerId, void *data, size_t size)
 		dest = PLR_BROADCAST;
 	else
 		dest = playerId;
-	if (dest != plr_self) {
+	if (dest == PLR_BROADCAST && UseBatches()) {
+		if (outgoingBatch_.size() + message.size() > batch_encoder::max_size) {
+			tl::expected<void, PacketError> result = FlushBatch();
+			if (!result.has_value()) {
+				LogError("send: {}", result.error().what());
+				return false;
+			}
+		}
+		outgoingBatch_.AddMessage(message);
+	} else if (dest != plr_self) {
+		// Batched packets have to arrive first.
+		if (tl::expected<void, PacketError> result = FlushBatch(); !result.has_value()) {
+			LogError("send: {}", result.error().what());
+			return false;
+		}
 		tl::expected<std::unique_ptr<packet>, PacketError> pkt
 		    = pktfty->make_packet<PT_MESSAGE>(plr_self, dest, message);
 		if (!pkt.has_value()) {
@@ -357,7 +468,14 @@ tl::expected<void, PacketError> base::SendTurnIfReady(turn_t turn)
 	if (awaitingSequenceNumber_)
 		awaitingSequenceNumber_ = !IsGameHost();
 
+	if (!awaitingSequenceNumber_ && UseBatches()) {
+		outgoingBatch_.AddTurn(turn);
+		return {};
+	}
+
 	if (!awaitingSequenceNumber_) {
+		if (tl::expected<void, PacketError> result = FlushBatch(); !result.has_value())
+			return result;
 		tl::expected<std::unique_ptr<packet>, PacketError> pkt
 		    = pktfty->make_packet<PT_TURN>(plr_self, PLR_BROADCAST, turn);
 		if (!pkt.has_value()) {
@@ -450,6 +568,8 @@ bool base::SNetRegisterEventHandler(event_type evtype, SEVTHANDLER func)
 
 bool base::SNetLeaveGame(int type)
 {
+	if (tl::expected<void, PacketError> result = FlushBatch(); !result.has_value())
+		LogError("send: {}", result.error().what());
 	tl::expected<std::unique_ptr<packet>, PacketError> pkt
 	    = pktfty->make_packet<PT_DISCONNECT>(
 	        plr_self, PLR_BROADCAST, plr_self, static_cast<leaveinfo_t>(type));
@@ -479,6 +599,8 @@ bool base::SNetDropPlayer(int playerid, uint32_t flags)
 		LogError("make_packet: {}", pkt.error().what());
 		return false;
 	}
+	if (tl::expected<void, PacketError> result = FlushBatch(); !result.has_value())
+		LogError("send: {}", result.error().what());
 	// Disconnect at the network layer first so we
 	// don't send players their own disconnect packet
 	DisconnectNet(plr);
@@ -525,5 +647,15 @@ bool base::SNetGetTurnsInTransit(uint32_t *turns)
 	return true;
 }
 
+bool base::SNetFlush()
+{
+	tl::expected<void, PacketError> result = FlushBatch();
+	if (!result.has_value()) {
+		LogError("send: {}", result.error().what());
+		return false;
+	}
+	return true;
+}
+
 } // namespace net
 } // namespace devilution
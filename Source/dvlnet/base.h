@@ -10,6 +10,7 @@
 
 #include "dvlnet/abstract_net.h"
 #include "dvlnet/packet.h"
+#include "dvlnet/turn_batch.h"
 #include "multi.h"
 #include "storm/storm_net.hpp"
 
@@ -29,6 +30,7 @@ public:
 	bool SNetDropPlayer(int playerid, uint32_t flags) override;
 	bool SNetGetOwnerTurnsWaiting(uint32_t *turns) override;
 	bool SNetGetTurnsInTransit(uint32_t *turns) override;
+	bool SNetFlush() override;
 
 	virtual tl::expected<void, PacketError> poll() = 0;
 	virtual tl::expected<void, PacketError> send(packet &pkt) = 0;
@@ -65,6 +67,8 @@ protected:
 		std::deque<turn_t> turnQueue;
 		int32_t lastTurnValue = {};
 		uint32_t roundTripLatency = {};
+		features_t features = {};
+		batch_decoder incomingBatch;
 	};
 
 	seq_t current_turn = 0;
@@ -88,9 +92,15 @@ protected:
 private:
 	std::array<PlayerState, MAX_PLRS> playerStateTable_;
 	bool awaitingSequenceNumber_ = true;
+	/** This tick's turns and messages for all the other players, sent as a single broadcast. */
+	batch_encoder outgoingBatch_;
 
 	plr_t GetOwner();
 	bool AllTurnsArrived();
+	static features_t LocalFeatures();
+	bool UseBatches() const;
+	tl::expected<void, PacketError> FlushBatch();
+	void ResetPlayerState(plr_t player);
 	tl::expected<void, PacketError> MakeReady(seq_t sequenceNumber);
 	tl::expected<void, PacketError> SendTurnIfReady(turn_t turn);
 	tl::expected<void, PacketError> SendFirstTurnIfReady(plr_t player);
@@ -99,6 +109,7 @@ private:
 	tl::expected<void, PacketError> HandleAccept(packet &pkt);
 	tl::expected<void, PacketError> HandleConnect(packet &pkt);
 	tl::expected<void, PacketError> HandleTurn(packet &pkt);
+	tl::expected<void, PacketError> HandleBatch(packet &pkt);
 	tl::expected<void, PacketError> HandleDisconnect(packet &pkt);
 	tl::expected<void, PacketError> HandleEchoRequest(packet &pkt);
 	tl::expected<void, PacketError> HandleEchoReply(packet &pkt);
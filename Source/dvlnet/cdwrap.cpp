@@ -98,6 +98,11 @@ bool cdwrap::SNetGetTurnsInTransit(uint32_t *turns)
 	return dvlnet_wrap->SNetGetTurnsInTransit(turns);
 }
 
+bool cdwrap::SNetFlush()
+{
+	return dvlnet_wrap->SNetFlush();
+}
+
 std::string cdwrap::make_default_gamename()
 {
 	return dvlnet_wrap->make_default_gamename();
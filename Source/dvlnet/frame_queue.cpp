@@ -1,5 +1,6 @@
 #include "dvlnet/frame_queue.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "appfat.h"
@@ -20,40 +21,32 @@ PacketError FrameQueueError()
 
 } // namespace
 
-framesize_t frame_queue::Size() const
+std::span<unsigned char> frame_queue::WriteBuffer(size_t minSize)
 {
-	return current_size;
+	if (buffer_.size() - end_ < minSize) {
+		if (begin_ != 0) {
+			std::memmove(buffer_.data(), buffer_.data() + begin_, Size());
+			end_ -= begin_;
+			begin_ = 0;
+		}
+		if (buffer_.size() - end_ < minSize)
+			buffer_.resize(std::max(end_ + minSize, 2 * buffer_.size()));
+	}
+	return { buffer_.data() + end_, buffer_.size() - end_ };
 }
 
-tl::expected<buffer_t, PacketError> frame_queue::Read(framesize_t s)
+void frame_queue::CommitWrite(size_t size)
 {
-	if (current_size < s)
-		return tl::make_unexpected(FrameQueueError());
-	buffer_t ret;
-	while (s > 0 && s >= buffer_deque.front().size()) {
-		const framesize_t bufferSize = static_cast<framesize_t>(buffer_deque.front().size());
-		s -= bufferSize;
-		current_size -= bufferSize;
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().end());
-		buffer_deque.pop_front();
-	}
-	if (s > 0) {
-		ret.insert(ret.end(),
-		    buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		buffer_deque.front().erase(buffer_deque.front().begin(),
-		    buffer_deque.front().begin() + s);
-		current_size -= s;
-	}
-	return ret;
+	assert(size <= buffer_.size() - end_);
+	end_ += size;
 }
 
-void frame_queue::Write(buffer_t buf)
+void frame_queue::Write(std::span<const unsigned char> data)
 {
-	current_size += static_cast<framesize_t>(buf.size());
-	buffer_deque.push_back(std::move(buf));
+	if (data.empty())
+		return;
+	std::memcpy(WriteBuffer(data.size()).data(), data.data(), data.size());
+	CommitWrite(data.size());
 }
 
 tl::expected<bool, PacketError> frame_queue::PacketReady()
@@ -61,36 +54,36 @@ tl::expected<bool, PacketError> frame_queue::PacketReady()
 	if (nextsize == 0) {
 		if (Size() < sizeof(framesize_t))
 			return false;
-		tl::expected<buffer_t, PacketError> szbuf = Read(sizeof(framesize_t));
-		if (!szbuf.has_value())
-			return tl::make_unexpected(szbuf.error());
-		nextsize = LoadLE32(szbuf->data());
-		if (nextsize == 0)
+		nextsize = LoadLE32(buffer_.data() + begin_);
+		begin_ += sizeof(framesize_t);
+		if (nextsize == 0 || nextsize > max_frame_size)
 			return tl::make_unexpected(FrameQueueError());
 	}
 	return Size() >= nextsize;
 }
 
-tl::expected<buffer_t, PacketError> frame_queue::ReadPacket()
+tl::expected<std::span<const unsigned char>, PacketError> frame_queue::ReadPacket()
 {
 	if (nextsize == 0 || Size() < nextsize)
 		return tl::make_unexpected(FrameQueueError());
-	tl::expected<buffer_t, PacketError> ret = Read(nextsize);
+	const std::span<const unsigned char> ret { buffer_.data() + begin_, nextsize };
+	begin_ += nextsize;
 	nextsize = 0;
+	// The bytes stay in place until the next write, so the view remains valid.
+	if (begin_ == end_)
+		begin_ = end_ = 0;
 	return ret;
 }
 
-tl::expected<buffer_t, PacketError> frame_queue::MakeFrame(buffer_t packetbuf)
+tl::expected<buffer_t, PacketError> frame_queue::MakeFrame(std::span<const unsigned char> packetbuf)
 {
-	buffer_t ret;
-	const framesize_t size = static_cast<framesize_t>(packetbuf.size());
-	if (size > max_frame_size)
+	if (packetbuf.size() > max_frame_size)
 		return tl::make_unexpected("Buffer exceeds maximum frame size");
+	const framesize_t size = static_cast<framesize_t>(packetbuf.size());
 	static_assert(sizeof(size) == 4, "framesize_t is not 4 bytes");
-	unsigned char sizeBuf[4];
-	WriteLE32(sizeBuf, size);
-	ret.insert(ret.end(), sizeBuf, sizeBuf + 4);
-	ret.insert(ret.end(), packetbuf.begin(), packetbuf.end());
+	buffer_t ret(sizeof(size) + size);
+	WriteLE32(ret.data(), size);
+	std::memcpy(ret.data() + sizeof(size), packetbuf.data(), size);
 	return ret;
 }
 
@@ -1,8 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <deque>
-#include <exception>
+#include <span>
 #include <vector>
 
 #include <expected.hpp>
@@ -15,24 +15,46 @@ namespace net {
 typedef std::vector<unsigned char> buffer_t;
 typedef uint32_t framesize_t;
 
+/**
+ * @brief Splits a byte stream into frames.
+ *
+ * The received bytes are kept in a single contiguous buffer that is reused for the lifetime of the queue.
+ * When the free space at the end runs out, the unread bytes are moved back to the front,
+ * so every frame can be handed out as a view without copying it.
+ */
 class frame_queue {
 public:
 	constexpr static framesize_t max_frame_size = 0xFFFF;
 
-private:
-	framesize_t current_size = 0;
-	std::deque<buffer_t> buffer_deque;
-	framesize_t nextsize = 0;
+	/**
+	 * @brief Returns the free space at the end of the queue, at least `minSize` bytes.
+	 *
+	 * Receive into the returned buffer and then call `CommitWrite` with the number of bytes received.
+	 * Invalidates the views returned by `ReadPacket`.
+	 */
+	std::span<unsigned char> WriteBuffer(size_t minSize);
+	void CommitWrite(size_t size);
 
-	framesize_t Size() const;
-	tl::expected<buffer_t, PacketError> Read(framesize_t s);
+	/** @brief Appends a copy of `data`. Invalidates the views returned by `ReadPacket`. */
+	void Write(std::span<const unsigned char> data);
 
-public:
 	tl::expected<bool, PacketError> PacketReady();
-	tl::expected<buffer_t, PacketError> ReadPacket();
-	void Write(buffer_t buf);
 
-	static tl::expected<buffer_t, PacketError> MakeFrame(buffer_t packetbuf);
+	/** @brief Returns a view of the next frame, valid until the next write. */
+	tl::expected<std::span<const unsigned char>, PacketError> ReadPacket();
+
+	static tl::expected<buffer_t, PacketError> MakeFrame(std::span<const unsigned char> packetbuf);
+
+private:
+	size_t Size() const
+	{
+		return end_ - begin_;
+	}
+
+	buffer_t buffer_;
+	size_t begin_ = 0;
+	size_t end_ = 0;
+	framesize_t nextsize = 0;
 };
 
 } // namespace net
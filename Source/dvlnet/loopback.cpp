@@ -112,6 +112,11 @@ bool loopback::SNetGetTurnsInTransit(uint32_t *turns)
 	return true;
 }
 
+bool loopback::SNetFlush()
+{
+	return true;
+}
+
 std::string loopback::make_default_gamename()
 {
 	return std::string(_("loopback"));
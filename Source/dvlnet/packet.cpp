@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 
 #ifdef PACKET_ENCRYPTION
 #include <sodium.h>
@@ -63,6 +64,8 @@ const char *packet_type_to_string(uint8_t packetType)
 		return "PT_MESSAGE";
 	case PT_TURN:
 		return "PT_TURN";
+	case PT_BATCH:
+		return "PT_BATCH";
 	case PT_JOIN_REQUEST:
 		return "PT_JOIN_REQUEST";
 	case PT_JOIN_ACCEPT:
@@ -185,6 +188,13 @@ tl::expected<timestamp_t, PacketError> packet::Time()
 	    .transform([this]() { return m_time; });
 }
 
+tl::expected<features_t, PacketError> packet::Features()
+{
+	assert(have_decrypted);
+	return CheckPacketTypeOneOf({ PT_ECHO_REQUEST, PT_ECHO_REPLY }, m_type)
+	    .transform([this]() { return m_features; });
+}
+
 tl::expected<const buffer_t *, PacketError> packet::Info()
 {
 	assert(have_decrypted);
@@ -199,13 +209,20 @@ tl::expected<leaveinfo_t, PacketError> packet::LeaveInfo()
 	    .transform([this]() { return m_leaveinfo; });
 }
 
-tl::expected<void, PacketError> packet_in::Create(buffer_t buf)
+tl::expected<const buffer_t *, PacketError> packet::Batch()
+{
+	assert(have_decrypted);
+	return CheckPacketTypeOneOf({ PT_BATCH }, m_type)
+	    .transform([this]() { return &m_batch; });
+}
+
+tl::expected<void, PacketError> packet_in::Create(std::span<const unsigned char> buf)
 {
 	assert(!have_encrypted && !have_decrypted);
 	if (buf.size() < sizeof(packet_type) + 2 * sizeof(plr_t))
 		return tl::make_unexpected(PacketError());
 
-	decrypted_buffer = std::move(buf);
+	decrypted_buffer.assign(buf.begin(), buf.end());
 	have_decrypted = true;
 
 	// TCP server implementation forwards the original data to clients
@@ -217,28 +234,37 @@ tl::expected<void, PacketError> packet_in::Create(buffer_t buf)
 }
 
 #ifdef PACKET_ENCRYPTION
-tl::expected<void, PacketError> packet_in::Decrypt(buffer_t buf)
+tl::expected<void, PacketError> packet_in::Decrypt(std::span<const unsigned char> buf)
 {
 	assert(!have_encrypted && !have_decrypted);
-	encrypted_buffer = std::move(buf);
+	encrypted_buffer.assign(buf.begin(), buf.end());
 	have_encrypted = true;
 
-	if (encrypted_buffer.size() < crypto_secretbox_NONCEBYTES
+	if (encrypted_buffer.size() < EncryptedHeaderSize)
+		return tl::make_unexpected(PacketError());
+	if (encrypted_buffer[RoutingHeaderSize] != ProtocolVersion)
+		return tl::make_unexpected(IncompatibleVersionError());
+	if (encrypted_buffer.size() < EncryptedHeaderSize
+	        + crypto_secretbox_NONCEBYTES
 	        + crypto_secretbox_MACBYTES
-	        + sizeof(packet_type) + 2 * sizeof(plr_t))
+	        + RoutingHeaderSize)
 		return tl::make_unexpected(PacketError());
-	auto pktlen = (encrypted_buffer.size()
-	    - crypto_secretbox_NONCEBYTES
-	    - crypto_secretbox_MACBYTES);
-	decrypted_buffer.resize(pktlen);
+	const unsigned char *nonce = encrypted_buffer.data() + EncryptedHeaderSize;
+	auto boxlen = (encrypted_buffer.size()
+	    - EncryptedHeaderSize
+	    - crypto_secretbox_NONCEBYTES);
+	decrypted_buffer.resize(boxlen - crypto_secretbox_MACBYTES);
 	const int status = crypto_secretbox_open_easy(
 	    decrypted_buffer.data(),
-	    encrypted_buffer.data() + crypto_secretbox_NONCEBYTES,
-	    encrypted_buffer.size() - crypto_secretbox_NONCEBYTES,
-	    encrypted_buffer.data(),
+	    nonce + crypto_secretbox_NONCEBYTES,
+	    boxlen,
+	    nonce,
 	    key.data());
 	if (status != 0)
 		return tl::make_unexpected(PacketError());
+	// The routing header is not covered by the MAC, so check it against the authenticated copy.
+	if (std::memcmp(decrypted_buffer.data(), encrypted_buffer.data(), RoutingHeaderSize) != 0)
+		return tl::make_unexpected(PacketError("Packet routing header mismatch"));
 
 	have_decrypted = true;
 	return {};
@@ -254,16 +280,20 @@ void packet_out::Encrypt()
 		return;
 
 	auto lenCleartext = decrypted_buffer.size();
-	encrypted_buffer.insert(encrypted_buffer.begin(),
-	    crypto_secretbox_NONCEBYTES, 0);
-	encrypted_buffer.insert(encrypted_buffer.end(),
-	    crypto_secretbox_MACBYTES + lenCleartext, 0);
-	randombytes_buf(encrypted_buffer.data(), crypto_secretbox_NONCEBYTES);
+	assert(lenCleartext >= RoutingHeaderSize);
+	encrypted_buffer.resize(EncryptedHeaderSize
+	    + crypto_secretbox_NONCEBYTES
+	    + crypto_secretbox_MACBYTES
+	    + lenCleartext);
+	std::memcpy(encrypted_buffer.data(), decrypted_buffer.data(), RoutingHeaderSize);
+	encrypted_buffer[RoutingHeaderSize] = ProtocolVersion;
+	unsigned char *nonce = encrypted_buffer.data() + EncryptedHeaderSize;
+	randombytes_buf(nonce, crypto_secretbox_NONCEBYTES);
 	const int status = crypto_secretbox_easy(
-	    encrypted_buffer.data() + crypto_secretbox_NONCEBYTES,
+	    nonce + crypto_secretbox_NONCEBYTES,
 	    decrypted_buffer.data(),
 	    lenCleartext,
-	    encrypted_buffer.data(),
+	    nonce,
 	    key.data());
 	if (status != 0)
 		ABORT();
@@ -303,4 +333,16 @@ packet_factory::packet_factory(std::string pw)
 #endif
 }
 
+bool packet_factory::IsCompatible(std::span<const unsigned char> buf) const
+{
+	if (!secure)
+		return true;
+	return buf.size() >= EncryptedHeaderSize && buf[RoutingHeaderSize] == ProtocolVersion;
+}
+
+buffer_t packet_factory::MakeVersionPacket()
+{
+	return buffer_t { PT_JOIN_ACCEPT, PLR_MASTER, PLR_BROADCAST, ProtocolVersion };
+}
+
 } // namespace devilution::net
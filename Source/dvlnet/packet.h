@@ -1,11 +1,14 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <span>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include <expected.hpp>
 
@@ -14,20 +17,23 @@
 #endif
 
 #include "appfat.h"
-#include "dvlnet/abstract_net.h"
 #include "utils/attributes.h"
 #include "utils/endian_read.hpp"
 #include "utils/endian_write.hpp"
 #include "utils/str_cat.hpp"
+#include "utils/string_or_view.hpp"
 #include "utils/stubs.h"
 
 namespace devilution {
 namespace net {
 
+typedef std::vector<unsigned char> buffer_t;
+
 enum packet_type : uint8_t {
 	// clang-format off
 	PT_MESSAGE      = 0x01,
 	PT_TURN         = 0x02,
+	PT_BATCH        = 0x03,
 	PT_JOIN_REQUEST = 0x11,
 	PT_JOIN_ACCEPT  = 0x12,
 	PT_CONNECT      = 0x13,
@@ -47,6 +53,7 @@ typedef uint8_t seq_t;
 typedef uint32_t cookie_t;
 typedef uint32_t timestamp_t;
 typedef uint32_t leaveinfo_t;
+typedef uint8_t features_t;
 #ifdef PACKET_ENCRYPTION
 typedef std::array<unsigned char, crypto_secretbox_KEYBYTES> key_t;
 #else
@@ -62,6 +69,37 @@ struct turn_t {
 static constexpr plr_t PLR_MASTER = 0xFE;
 static constexpr plr_t PLR_BROADCAST = 0xFF;
 
+/**
+ * @brief Optional protocol features, advertised at the end of echo packets.
+ *
+ * Older versions ignore the trailing byte and are treated as supporting none of them.
+ */
+static constexpr features_t FEATURE_BATCH = 0x01;
+
+/**
+ * @brief The type, source and destination of a packet.
+ *
+ * Every packet starts with these fields in the clear, so that the server can route it without decrypting it.
+ * Encrypted packets repeat them inside the ciphertext and are rejected if the two copies differ.
+ */
+struct routing_header {
+	uint8_t type;
+	plr_t src;
+	plr_t dest;
+};
+
+static constexpr size_t RoutingHeaderSize = sizeof(packet_type) + 2 * sizeof(plr_t);
+
+/**
+ * @brief The version of the encrypted packet format.
+ *
+ * Encrypted packets carry it in the clear after the routing header, so that a player
+ * running a build with a different format gets an error instead of an undecryptable packet.
+ */
+static constexpr uint8_t ProtocolVersion = 1;
+
+static constexpr size_t EncryptedHeaderSize = RoutingHeaderSize + sizeof(ProtocolVersion);
+
 class PacketError {
 public:
 	PacketError()
@@ -108,6 +146,18 @@ inline PacketError IoHandlerError(std::string message)
 	return PacketError(std::move(message));
 }
 
+inline PacketError IncompatibleVersionError()
+{
+	return PacketError("Incompatible network protocol, all players need the same version of the game");
+}
+
+inline tl::expected<routing_header, PacketError> ReadRoutingHeader(std::span<const unsigned char> data)
+{
+	if (data.size() < RoutingHeaderSize)
+		return tl::make_unexpected(PacketError());
+	return routing_header { data[0], data[1], data[2] };
+}
+
 PacketError PacketTypeError(std::uint8_t unknownPacketType);
 PacketError PacketTypeError(std::initializer_list<packet_type> expectedTypes, std::uint8_t actual);
 
@@ -121,8 +171,10 @@ protected:
 	cookie_t m_cookie;
 	plr_t m_newplr;
 	timestamp_t m_time;
+	features_t m_features;
 	buffer_t m_info;
 	leaveinfo_t m_leaveinfo;
+	buffer_t m_batch;
 
 	const key_t &key;
 	bool have_encrypted = false;
@@ -144,8 +196,10 @@ public:
 	tl::expected<cookie_t, PacketError> Cookie();
 	tl::expected<plr_t, PacketError> NewPlayer();
 	tl::expected<timestamp_t, PacketError> Time();
+	tl::expected<features_t, PacketError> Features();
 	tl::expected<const buffer_t *, PacketError> Info();
 	tl::expected<leaveinfo_t, PacketError> LeaveInfo();
+	tl::expected<const buffer_t *, PacketError> Batch();
 };
 
 template <class P>
@@ -158,11 +212,13 @@ public:
 class packet_in : public packet_proc<packet_in> {
 public:
 	using packet_proc<packet_in>::packet_proc;
-	tl::expected<void, PacketError> Create(buffer_t buf);
+	tl::expected<void, PacketError> Create(std::span<const unsigned char> buf);
 	tl::expected<void, PacketError> process_element(buffer_t &x);
 	template <class T>
 	tl::expected<void, PacketError> process_element(T &x);
-	tl::expected<void, PacketError> Decrypt(buffer_t buf);
+	template <class T>
+	tl::expected<void, PacketError> process_optional_element(T &x);
+	tl::expected<void, PacketError> Decrypt(std::span<const unsigned char> buf);
 };
 
 class packet_out : public packet_proc<packet_out> {
@@ -175,6 +231,8 @@ public:
 	tl::expected<void, PacketError> process_element(buffer_t &x);
 	template <class T>
 	tl::expected<void, PacketError> process_element(const T &x);
+	template <class T>
+	tl::expected<void, PacketError> process_optional_element(const T &x);
 	static cookie_t GenerateCookie();
 	void Encrypt();
 };
@@ -201,6 +259,8 @@ tl::expected<void, PacketError> packet_proc<P>::process_data()
 	case PT_TURN:
 		return self.process_element(m_turn.SequenceNumber)
 		    .and_then([&]() { return self.process_element(m_turn.Value); });
+	case PT_BATCH:
+		return self.process_element(m_batch);
 	case PT_JOIN_REQUEST:
 		return self.process_element(m_cookie)
 		    .and_then([&]() { return self.process_element(m_info); });
@@ -220,7 +280,8 @@ tl::expected<void, PacketError> packet_proc<P>::process_data()
 		return {};
 	case PT_ECHO_REQUEST:
 	case PT_ECHO_REPLY:
-		return self.process_element(m_time);
+		return self.process_element(m_time)
+		    .and_then([&]() { return self.process_optional_element(m_features); });
 	}
 	return tl::make_unexpected(PacketTypeError(m_type));
 }
@@ -252,6 +313,17 @@ tl::expected<void, PacketError> packet_in::process_element(T &x)
 	return {};
 }
 
+template <class T>
+tl::expected<void, PacketError> packet_in::process_optional_element(T &x)
+{
+	// Fields appended in later versions are missing from older peers' packets.
+	if (decrypted_buffer.empty()) {
+		x = {};
+		return {};
+	}
+	return process_element(x);
+}
+
 template <>
 inline void packet_out::create<PT_INFO_REQUEST>(plr_t s, plr_t d)
 {
@@ -299,6 +371,18 @@ inline void packet_out::create<PT_TURN>(plr_t s, plr_t d, turn_t u)
 	m_turn = u;
 }
 
+template <>
+inline void packet_out::create<PT_BATCH>(plr_t s, plr_t d, buffer_t b)
+{
+	if (have_encrypted || have_decrypted)
+		ABORT();
+	have_decrypted = true;
+	m_type = PT_BATCH;
+	m_src = s;
+	m_dest = d;
+	m_batch = std::move(b);
+}
+
 template <>
 inline void packet_out::create<PT_JOIN_REQUEST>(plr_t s, plr_t d,
     cookie_t c, buffer_t i)
@@ -377,6 +461,20 @@ inline void packet_out::create<PT_ECHO_REQUEST>(plr_t s, plr_t d, timestamp_t t)
 	m_src = s;
 	m_dest = d;
 	m_time = t;
+	m_features = 0;
+}
+
+template <>
+inline void packet_out::create<PT_ECHO_REQUEST>(plr_t s, plr_t d, timestamp_t t, features_t f)
+{
+	if (have_encrypted || have_decrypted)
+		ABORT();
+	have_decrypted = true;
+	m_type = PT_ECHO_REQUEST;
+	m_src = s;
+	m_dest = d;
+	m_time = t;
+	m_features = f;
 }
 
 template <>
@@ -389,6 +487,20 @@ inline void packet_out::create<PT_ECHO_REPLY>(plr_t s, plr_t d, timestamp_t t)
 	m_src = s;
 	m_dest = d;
 	m_time = t;
+	m_features = 0;
+}
+
+template <>
+inline void packet_out::create<PT_ECHO_REPLY>(plr_t s, plr_t d, timestamp_t t, features_t f)
+{
+	if (have_encrypted || have_decrypted)
+		ABORT();
+	have_decrypted = true;
+	m_type = PT_ECHO_REPLY;
+	m_src = s;
+	m_dest = d;
+	m_time = t;
+	m_features = f;
 }
 
 inline tl::expected<void, PacketError> packet_out::process_element(buffer_t &x)
@@ -416,6 +528,12 @@ tl::expected<void, PacketError> packet_out::process_element(const T &x)
 	return {};
 }
 
+template <class T>
+tl::expected<void, PacketError> packet_out::process_optional_element(const T &x)
+{
+	return process_element(x);
+}
+
 class packet_factory {
 	key_t key = {};
 	bool secure;
@@ -425,23 +543,32 @@ public:
 
 	packet_factory();
 	packet_factory(std::string pw);
-	tl::expected<std::unique_ptr<packet>, PacketError> make_packet(buffer_t buf);
+
+	bool IsSecure() const
+	{
+		return secure;
+	}
+
+	/** @brief Whether `buf` uses the packet format of this build. Only encrypted packets carry a version. */
+	bool IsCompatible(std::span<const unsigned char> buf) const;
+
+	/** @brief A packet that only carries `ProtocolVersion`, for telling an incompatible player why it is rejected. */
+	static buffer_t MakeVersionPacket();
+	tl::expected<std::unique_ptr<packet>, PacketError> make_packet(std::span<const unsigned char> buf);
 	template <packet_type t, typename... Args>
 	tl::expected<std::unique_ptr<packet>, PacketError> make_packet(Args... args);
 };
 
-inline tl::expected<std::unique_ptr<packet>, PacketError> packet_factory::make_packet(buffer_t buf)
+inline tl::expected<std::unique_ptr<packet>, PacketError> packet_factory::make_packet(std::span<const unsigned char> buf)
 {
 	auto ret = std::make_unique<packet_in>(key);
 #ifndef PACKET_ENCRYPTION
-	ret->Create(std::move(buf));
+	const tl::expected<void, PacketError> result = ret->Create(buf)
 #else
-	if (!secure)
-		ret->Create(std::move(buf));
-	else
-		ret->Decrypt(std::move(buf));
+	const tl::expected<void, PacketError> result = (!secure ? ret->Create(buf) : ret->Decrypt(buf))
 #endif
-	if (const tl::expected<void, PacketError> result = ret->process_data(); !result.has_value()) {
+	                                                   .and_then([&]() { return ret->process_data(); });
+	if (!result.has_value()) {
 		return tl::make_unexpected(result.error());
 	}
 	return ret;
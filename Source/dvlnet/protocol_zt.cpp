@@ -1,6 +1,7 @@
 #include "dvlnet/protocol_zt.h"
 
 #include <random>
+#include <span>
 
 #include <SDL.h>
 
@@ -161,12 +162,12 @@ tl::expected<bool, PacketError> protocol_zt::send_queued_peer(const endpoint &pe
 
 bool protocol_zt::recv_peer(const endpoint &peer)
 {
-	unsigned char buf[PKTBUF_LEN];
 	peer_state &state = peer_list[peer];
 	while (true) {
-		auto len = lwip_recv(state.fd, buf, sizeof(buf), 0);
+		const std::span<unsigned char> buf = state.recv_queue.WriteBuffer(PKTBUF_LEN);
+		auto len = lwip_recv(state.fd, buf.data(), buf.size(), 0);
 		if (len >= 0) {
-			state.recv_queue.Write(buffer_t(buf, buf + len));
+			state.recv_queue.CommitWrite(static_cast<size_t>(len));
 		} else {
 			return errno == EAGAIN || errno == EWOULDBLOCK;
 		}
@@ -262,13 +263,13 @@ bool protocol_zt::recv(endpoint &peer, buffer_t &data)
 		}
 		if (!*ready)
 			continue;
-		tl::expected<buffer_t, PacketError> packet = p.second.recv_queue.ReadPacket();
+		tl::expected<std::span<const unsigned char>, PacketError> packet = p.second.recv_queue.ReadPacket();
 		if (!packet.has_value()) {
 			LogError("Failed reading packet data from peer: {}", packet.error().what());
 			continue;
 		}
 		peer = p.first;
-		data = *packet;
+		data.assign(packet->begin(), packet->end());
 		return true;
 	}
 	return false;
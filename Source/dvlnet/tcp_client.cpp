@@ -3,6 +3,7 @@
 #include <exception>
 #include <functional>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <system_error>
 
@@ -19,6 +20,11 @@ namespace devilution::net {
 
 int tcp_client::create(std::string_view addrstr)
 {
+	const std::string_view dedicatedServer = GetOptions().Network.szDedicatedServer;
+	if (!dedicatedServer.empty()) {
+		// The server has no game yet, so the game info we send with the join request creates it.
+		return join(dedicatedServer);
+	}
 	auto port = *GetOptions().Network.port;
 	local_server = std::make_unique<tcp_server>(ioc, std::string(addrstr), port, *pktfty);
 	return join(local_server->LocalhostSelf());
@@ -141,6 +147,12 @@ tl::expected<void, PacketError> tcp_client::poll()
 
 void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 {
+	if (plr_self == PLR_BROADCAST && pktfty->IsSecure() && (error == asio::error::eof || (!error && bytesRead == 0))) {
+		// Hosts drop players whose join request they cannot decrypt.
+		const PacketError packetError(_("The host closed the connection. Check the password and that you are running the same version of the game as the host."));
+		RaiseIoHandlerError(packetError);
+		return;
+	}
 	if (error) {
 		const PacketError packetError = IoHandlerError(error.message());
 		RaiseIoHandlerError(packetError);
@@ -151,9 +163,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 		RaiseIoHandlerError(packetError);
 		return;
 	}
-	recv_buffer.resize(bytesRead);
-	recv_queue.Write(std::move(recv_buffer));
-	recv_buffer.resize(frame_queue::max_frame_size);
+	recv_queue.CommitWrite(bytesRead);
 	while (true) {
 		tl::expected<bool, PacketError> ready = recv_queue.PacketReady();
 		if (!ready.has_value()) {
@@ -164,7 +174,7 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 			break;
 		tl::expected<void, PacketError> result
 		    = recv_queue.ReadPacket()
-		          .and_then([this](buffer_t &&pktData) { return pktfty->make_packet(pktData); })
+		          .and_then([this](std::span<const unsigned char> pktData) { return pktfty->make_packet(pktData); })
 		          .and_then([this](std::unique_ptr<packet> &&pkt) { return RecvLocal(*pkt); });
 		if (!result.has_value()) {
 			RaiseIoHandlerError(result.error());
@@ -176,8 +186,9 @@ void tcp_client::HandleReceive(const asio::error_code &error, size_t bytesRead)
 
 void tcp_client::StartReceive()
 {
+	const std::span<unsigned char> buf = recv_queue.WriteBuffer(frame_queue::max_frame_size);
 	sock.async_receive(
-	    asio::buffer(recv_buffer),
+	    asio::buffer(buf.data(), buf.size()),
 	    std::bind(&tcp_client::HandleReceive, this, std::placeholders::_1, std::placeholders::_2));
 }
 
@@ -218,6 +229,9 @@ bool tcp_client::SNetLeaveGame(int type)
 
 std::string tcp_client::make_default_gamename()
 {
+	const std::string_view dedicatedServer = GetOptions().Network.szDedicatedServer;
+	if (!dedicatedServer.empty())
+		return std::string(dedicatedServer);
 	return std::string(GetOptions().Network.szBindAddress);
 }
 
@@ -1,18 +1,39 @@
 #include "dvlnet/tcp_server.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
 #include <utility>
+#include <vector>
 
 #include <expected.hpp>
 
-#include "dvlnet/base.h"
-#include "player.h"
+#include "utils/endian_read.hpp"
 #include "utils/log.hpp"
+#include "utils/str_cat.hpp"
 
 namespace devilution::net {
 
+namespace {
+
+timestamp_t Now()
+{
+	return static_cast<timestamp_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+	    std::chrono::steady_clock::now().time_since_epoch())
+	                                    .count());
+}
+
+/** @brief Whether a join request carries the info of a game to create. Game info starts with its own size, joining players send none. */
+bool IsGameInfo(const buffer_t &info)
+{
+	return info.size() >= sizeof(uint32_t) && LoadLE32(info.data()) == info.size();
+}
+
+} // namespace
+
 tcp_server::tcp_server(asio::io_context &ioc, const std::string &bindaddr,
     unsigned short port, packet_factory &pktfty)
     : ioc(ioc)
@@ -39,6 +60,11 @@ std::string tcp_server::LocalhostSelf()
 	return addr.to_string();
 }
 
+unsigned short tcp_server::Port() const
+{
+	return acceptor->local_endpoint().port();
+}
+
 tcp_server::scc tcp_server::MakeConnection()
 {
 	return std::make_shared<client_connection>(ioc);
@@ -46,7 +72,7 @@ tcp_server::scc tcp_server::MakeConnection()
 
 plr_t tcp_server::NextFree()
 {
-	for (plr_t i = 0; i < Players.size(); ++i)
+	for (plr_t i = 0; i < connections.size(); ++i)
 		if (!connections[i])
 			return i;
 	return PLR_BROADCAST;
@@ -54,7 +80,7 @@ plr_t tcp_server::NextFree()
 
 bool tcp_server::Empty()
 {
-	for (plr_t i = 0; i < Players.size(); ++i)
+	for (plr_t i = 0; i < connections.size(); ++i)
 		if (connections[i])
 			return false;
 	return true;
@@ -62,8 +88,9 @@ bool tcp_server::Empty()
 
 void tcp_server::StartReceive(const scc &con)
 {
+	const std::span<unsigned char> buf = con->recv_queue.WriteBuffer(frame_queue::max_frame_size);
 	con->socket.async_receive(
-	    asio::buffer(con->recv_buffer),
+	    asio::buffer(buf.data(), buf.size()),
 	    std::bind(&tcp_server::HandleReceive, this, con, std::placeholders::_1, std::placeholders::_2));
 }
 
@@ -74,9 +101,8 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 		DropConnection(con);
 		return;
 	}
-	con->recv_buffer.resize(bytesRead);
-	con->recv_queue.Write(std::move(con->recv_buffer));
-	con->recv_buffer.resize(frame_queue::max_frame_size);
+	con->recv_queue.CommitWrite(bytesRead);
+	con->stats.bytesReceived += bytesRead;
 	while (true) {
 		tl::expected<bool, PacketError> ready = con->recv_queue.PacketReady();
 		if (!ready.has_value()) {
@@ -86,28 +112,32 @@ void tcp_server::HandleReceive(const scc &con, const asio::error_code &ec,
 		}
 		if (!*ready)
 			break;
-		tl::expected<buffer_t, PacketError> pktData = con->recv_queue.ReadPacket();
+		tl::expected<std::span<const unsigned char>, PacketError> pktData = con->recv_queue.ReadPacket();
 		if (!pktData.has_value()) {
 			Log("ReadPacket: {}", pktData.error().what());
 			DropConnection(con);
 			return;
 		}
-		tl::expected<std::unique_ptr<packet>, PacketError> pkt = pktfty.make_packet(*pktData);
-		if (!pkt.has_value()) {
-			Log("make_packet: {}", pkt.error().what());
-			DropConnection(con);
-			return;
-		}
+		++con->stats.packetsReceived;
 		if (con->plr == PLR_BROADCAST) {
-			tl::expected<void, PacketError> result = HandleReceiveNewPlayer(con, **pkt);
+			if (!pktfty.IsCompatible(*pktData)) {
+				Log("Rejecting {}: {}", con->stats.address, IncompatibleVersionError().what());
+				RejectIncompatibleConnection(con);
+				return;
+			}
+			tl::expected<void, PacketError> result
+			    = pktfty.make_packet(*pktData)
+			          .and_then([&](std::unique_ptr<packet> &&pkt) { return HandleReceiveNewPlayer(con, *pkt); });
 			if (!result.has_value()) {
 				Log("HandleReceiveNewPlayer: {}", result.error().what());
 				DropConnection(con);
 				return;
 			}
+			if (con->plr == PLR_BROADCAST)
+				return; // rejected
 		} else {
 			con->timeout = timeout_active;
-			tl::expected<void, PacketError> result = HandleReceivePacket(**pkt);
+			tl::expected<void, PacketError> result = HandleReceivePacket(con, *pktData);
 			if (!result.has_value()) {
 				Log("Network error: {}", result.error().what());
 				DropConnection(con);
@@ -128,10 +158,16 @@ tl::expected<void, PacketError> tcp_server::HandleReceiveNewPlayer(const scc &co
 		tl::expected<const buffer_t *, PacketError> pktInfo = inPkt.Info();
 		if (!pktInfo.has_value())
 			return tl::make_unexpected(pktInfo.error());
+		if (!IsGameInfo(**pktInfo)) {
+			// A dedicated server has no game until a player creates one.
+			Log("Rejecting {}: no game has been created yet", con->stats.address);
+			RejectJoinWithoutGame(con);
+			return {};
+		}
 		game_init_info = **pktInfo;
 	}
 
-	for (plr_t player = 0; player < Players.size(); player++) {
+	for (plr_t player = 0; player < connections.size(); player++) {
 		if (connections[player]) {
 			tl::expected<void, PacketError> result
 			    = pktfty.make_packet<PT_CONNECT>(PLR_MASTER, PLR_BROADCAST, newplr)
@@ -152,31 +188,99 @@ tl::expected<void, PacketError> tcp_server::HandleReceiveNewPlayer(const scc &co
 	con->plr = newplr;
 	connections[newplr] = con;
 	con->timeout = timeout_active;
+	// The reply tells us whether the player can receive batches. It is queued ahead of the
+	// other players' echo requests, so we know before any of them starts sending batches to it.
+	SendEchoRequest(con);
 	return {};
 }
 
-tl::expected<void, PacketError> tcp_server::HandleReceivePacket(packet &pkt)
+tl::expected<void, PacketError> tcp_server::HandleReceivePacket(const scc &con, std::span<const unsigned char> data)
 {
-	return SendPacket(pkt);
+	tl::expected<routing_header, PacketError> header = ReadRoutingHeader(data);
+	if (!header.has_value())
+		return tl::make_unexpected(header.error());
+	if (header->src != con->plr)
+		return tl::make_unexpected(ServerError());
+	if (header->dest != PLR_MASTER) {
+		// Relay the packet as received, without decrypting it.
+		return RoutePacket(*header, data);
+	}
+	return pktfty.make_packet(data)
+	    .and_then([&](std::unique_ptr<packet> &&pkt) -> tl::expected<void, PacketError> {
+		    if (pkt->Type() != PT_ECHO_REPLY)
+			    return tl::make_unexpected(ServerError());
+		    return HandleEchoReply(con, *pkt);
+	    });
+}
+
+tl::expected<void, PacketError> tcp_server::HandleEchoReply(const scc &con, packet &pkt)
+{
+	tl::expected<features_t, PacketError> features = pkt.Features();
+	if (!features.has_value())
+		return tl::make_unexpected(features.error());
+	con->features = *features;
+	return pkt.Time().transform([&](timestamp_t &&pktTime) {
+		const uint32_t roundTripMs = Now() - pktTime;
+		connection_stats &stats = con->stats;
+		stats.lastRoundTripMs = roundTripMs;
+		stats.minRoundTripMs = stats.echoReplies == 0 ? roundTripMs : std::min(stats.minRoundTripMs, roundTripMs);
+		stats.maxRoundTripMs = std::max(stats.maxRoundTripMs, roundTripMs);
+		stats.totalRoundTripMs += roundTripMs;
+		++stats.echoReplies;
+	});
+}
+
+void tcp_server::SendEchoRequest(const scc &con)
+{
+	tl::expected<void, PacketError> result
+	    = pktfty.make_packet<PT_ECHO_REQUEST>(PLR_MASTER, con->plr, Now())
+	          .and_then([&](std::unique_ptr<packet> &&pkt) { return StartSend(con, *pkt); });
+	if (!result.has_value())
+		LogError("Failed to send echo request to player {}: {}", con->plr, result.error().what());
 }
 
 tl::expected<void, PacketError> tcp_server::SendPacket(packet &pkt)
 {
-	if (pkt.Destination() == PLR_BROADCAST) {
-		for (size_t i = 0; i < Players.size(); ++i) {
-			if (i == pkt.Source() || !connections[i])
+	return RoutePacket({ pkt.Type(), pkt.Source(), pkt.Destination() }, pkt.Data());
+}
+
+bool tcp_server::CanReceive(const client_connection &con, uint8_t packetType)
+{
+	// Players that do not support batches drop them, and would silently lose the turns
+	// of a player who has not yet seen them join.
+	return packetType != PT_BATCH || (con.features & FEATURE_BATCH) != 0;
+}
+
+tl::expected<void, PacketError> tcp_server::RoutePacket(const routing_header &header, std::span<const unsigned char> data)
+{
+	const plr_t src = header.src;
+	const plr_t dest = header.dest;
+	if (dest == PLR_BROADCAST) {
+		frame_ptr frame;
+		for (size_t i = 0; i < connections.size(); ++i) {
+			if (i == src || !connections[i] || !CanReceive(*connections[i], header.type))
 				continue;
-			tl::expected<void, PacketError> result = StartSend(connections[i], pkt);
-			if (!result.has_value())
-				LogError("Failed to send packet {} to player {}: {}", static_cast<uint8_t>(pkt.Type()), i, result.error().what());
+			if (frame == nullptr) {
+				tl::expected<buffer_t, PacketError> frameData = frame_queue::MakeFrame(data);
+				if (!frameData.has_value()) {
+					LogError("Failed to send packet from player {}: {}", src, frameData.error().what());
+					return {};
+				}
+				frame = std::make_shared<const buffer_t>(std::move(*frameData));
+			}
+			StartSend(connections[i], frame);
 		}
 		return {};
 	}
-	if (pkt.Destination() >= MAX_PLRS)
+	if (dest >= MAX_PLRS)
 		return tl::make_unexpected(ServerError());
-	if (pkt.Destination() == pkt.Source() || !connections[pkt.Destination()])
+	if (dest == src || !connections[dest] || !CanReceive(*connections[dest], header.type))
 		return {};
-	return StartSend(connections[pkt.Destination()], pkt);
+	tl::expected<buffer_t, PacketError> frame = frame_queue::MakeFrame(data);
+	if (!frame.has_value())
+		return tl::make_unexpected(frame.error());
+	StartSend(connections[dest], std::make_shared<const buffer_t>(std::move(*frame)));
+	return {};
 }
 
 tl::expected<void, PacketError> tcp_server::StartSend(const scc &con, packet &pkt)
@@ -184,22 +288,43 @@ tl::expected<void, PacketError> tcp_server::StartSend(const scc &con, packet &pk
 	tl::expected<buffer_t, PacketError> frame = frame_queue::MakeFrame(pkt.Data());
 	if (!frame.has_value())
 		return tl::make_unexpected(frame.error());
-	std::unique_ptr<buffer_t> framePtr = std::make_unique<buffer_t>(*frame);
-	const asio::mutable_buffer buf = asio::buffer(*framePtr);
-	asio::async_write(con->socket, buf,
-	    [this, con, frame = std::move(framePtr)](const asio::error_code &ec, size_t bytesSent) {
-		    HandleSend(con, ec, bytesSent);
-	    });
+	StartSend(con, std::make_shared<const buffer_t>(std::move(*frame)));
 	return {};
 }
 
+void tcp_server::StartSend(const scc &con, frame_ptr frame)
+{
+	++con->stats.packetsSent;
+	con->send_queue.push_back(std::move(frame));
+	if (con->sending.empty())
+		Flush(con);
+}
+
+void tcp_server::Flush(const scc &con)
+{
+	// Everything queued while the previous write was in progress goes out in a single gather-write.
+	std::swap(con->sending, con->send_queue);
+	std::vector<asio::const_buffer> buffers;
+	buffers.reserve(con->sending.size());
+	for (const frame_ptr &frame : con->sending)
+		buffers.push_back(asio::buffer(*frame));
+	asio::async_write(con->socket, buffers,
+	    std::bind(&tcp_server::HandleSend, this, con, std::placeholders::_1, std::placeholders::_2));
+}
+
 void tcp_server::HandleSend(const scc &con, const asio::error_code &ec,
     size_t bytesSent)
 {
+	con->sending.clear();
+	con->stats.bytesSent += bytesSent;
 	if (ec) {
 		Log("Network error: {}", ec.message());
+		con->send_queue.clear();
 		DropConnection(con);
+		return;
 	}
+	if (!con->send_queue.empty())
+		Flush(con);
 }
 
 void tcp_server::StartAccept()
@@ -225,6 +350,9 @@ void tcp_server::HandleAccept(const scc &con, const asio::error_code &ec)
 		con->socket.set_option(option, errorCode);
 		if (errorCode)
 			LogError("Server error setting socket option: {}", errorCode.message());
+		const asio::ip::tcp::endpoint remote = con->socket.remote_endpoint(errorCode);
+		if (!errorCode)
+			con->stats.address = StrCat(remote.address().to_string(), ":", remote.port());
 		con->timeout = timeout_connect;
 		StartReceive(con);
 		StartTimeout(con);
@@ -252,6 +380,10 @@ void tcp_server::HandleTimeout(const scc &con, const asio::error_code &ec)
 		DropConnection(con);
 		return;
 	}
+	if (echo_interval > 0 && con->plr != PLR_BROADCAST && --con->echo_countdown <= 0) {
+		con->echo_countdown = echo_interval;
+		SendEchoRequest(con);
+	}
 	StartTimeout(con);
 }
 
@@ -275,6 +407,32 @@ void tcp_server::DropConnection(const scc &con)
 	}
 }
 
+void tcp_server::RejectIncompatibleConnection(const scc &con)
+{
+	tl::expected<buffer_t, PacketError> frame = frame_queue::MakeFrame(packet_factory::MakeVersionPacket());
+	if (!frame.has_value()) {
+		DropConnection(con);
+		return;
+	}
+	StartSend(con, std::make_shared<const buffer_t>(std::move(*frame)));
+	// Stop reading and let the timeout close the connection once the reply is sent.
+	con->timeout = 1;
+}
+
+void tcp_server::RejectJoinWithoutGame(const scc &con)
+{
+	tl::expected<void, PacketError> result
+	    = pktfty.make_packet<PT_DISCONNECT>(PLR_MASTER, PLR_BROADCAST,
+	          PLR_BROADCAST, static_cast<leaveinfo_t>(LEAVE_NO_GAME))
+	          .and_then([&](std::unique_ptr<packet> &&pkt) { return StartSend(con, *pkt); });
+	if (!result.has_value()) {
+		DropConnection(con);
+		return;
+	}
+	// Stop reading and let the timeout close the connection once the reply is sent.
+	con->timeout = 1;
+}
+
 void tcp_server::RaiseIoHandlerError(const PacketError &error)
 {
 	ioHandlerResult.emplace(error);
@@ -304,6 +462,23 @@ void tcp_server::Close()
 	acceptor->close();
 }
 
+void tcp_server::EnableEchoRequests(std::chrono::seconds interval)
+{
+	echo_interval = static_cast<int>(interval.count());
+}
+
+std::vector<connection_stats> tcp_server::GetConnectionStats() const
+{
+	std::vector<connection_stats> result;
+	for (const scc &con : connections) {
+		if (con == nullptr)
+			continue;
+		result.push_back(con->stats);
+		result.back().plr = con->plr;
+	}
+	return result;
+}
+
 tcp_server::~tcp_server()
     = default;
 
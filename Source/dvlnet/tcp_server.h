@@ -1,8 +1,13 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 // This header must be included before any 3DS code
 // because 3DS SDK defines a macro with the same name
@@ -21,10 +26,9 @@
 #include <asio/ts/net.hpp>
 #include <asio_handle_exception.hpp>
 
-#include "dvlnet/abstract_net.h"
 #include "dvlnet/frame_queue.h"
 #include "dvlnet/packet.h"
-#include "multi.h"
+#include "multi_defs.hpp"
 
 namespace devilution::net {
 
@@ -33,23 +37,60 @@ inline PacketError ServerError()
 	return PacketError("Invalid player ID");
 }
 
+struct connection_stats {
+	plr_t plr;
+	std::string address;
+	uint32_t packetsReceived;
+	uint32_t packetsSent;
+	uint64_t bytesReceived;
+	uint64_t bytesSent;
+	/** Number of echo replies received, 0 if the round-trip time has not been measured yet. */
+	uint32_t echoReplies;
+	uint32_t lastRoundTripMs;
+	uint32_t minRoundTripMs;
+	uint32_t maxRoundTripMs;
+	uint64_t totalRoundTripMs;
+};
+
 class tcp_server {
 public:
 	tcp_server(asio::io_context &ioc, const std::string &bindaddr,
 	    unsigned short port, packet_factory &pktfty);
 	std::string LocalhostSelf();
+	/** @brief The port that the server listens on, useful when it was started on port 0. */
+	unsigned short Port() const;
 	tl::expected<void, PacketError> CheckIoHandlerError();
 	void DisconnectNet(plr_t plr);
 	void Close();
 	virtual ~tcp_server();
 
+	/**
+	 * @brief Sends an echo request to every player once per `interval` to measure the round-trip time.
+	 *
+	 * The replies are consumed by the server and show up in `GetConnectionStats`.
+	 */
+	void EnableEchoRequests(std::chrono::seconds interval);
+
+	/** @brief Returns the traffic and latency stats of the connected players. */
+	std::vector<connection_stats> GetConnectionStats() const;
+
 private:
 	static constexpr int timeout_connect = 30;
 	static constexpr int timeout_active = 60;
 
+	/** A framed packet, shared by all the connections it is sent to. */
+	typedef std::shared_ptr<const buffer_t> frame_ptr;
+
 	struct client_connection {
 		frame_queue recv_queue;
-		buffer_t recv_buffer = buffer_t(frame_queue::max_frame_size);
+		/** Frames waiting for the write in progress to finish. */
+		std::vector<frame_ptr> send_queue;
+		/** Frames of the write in progress, kept alive until it completes. */
+		std::vector<frame_ptr> sending;
+		connection_stats stats {};
+		int echo_countdown = 0;
+		/** Protocol features from the player's echo replies. */
+		features_t features = 0;
 		plr_t plr = PLR_BROADCAST;
 		asio::ip::tcp::socket socket;
 		asio::steady_timer timer;
@@ -68,6 +109,7 @@ private:
 	std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
 	std::array<scc, MAX_PLRS> connections;
 	buffer_t game_init_info;
+	int echo_interval = 0;
 
 	std::optional<PacketError> ioHandlerResult;
 
@@ -79,13 +121,21 @@ private:
 	void StartReceive(const scc &con);
 	void HandleReceive(const scc &con, const asio::error_code &ec, size_t bytesRead);
 	tl::expected<void, PacketError> HandleReceiveNewPlayer(const scc &con, packet &pkt);
-	tl::expected<void, PacketError> HandleReceivePacket(packet &pkt);
+	tl::expected<void, PacketError> HandleReceivePacket(const scc &con, std::span<const unsigned char> data);
+	tl::expected<void, PacketError> HandleEchoReply(const scc &con, packet &pkt);
+	void SendEchoRequest(const scc &con);
 	tl::expected<void, PacketError> SendPacket(packet &pkt);
+	tl::expected<void, PacketError> RoutePacket(const routing_header &header, std::span<const unsigned char> data);
+	static bool CanReceive(const client_connection &con, uint8_t packetType);
 	tl::expected<void, PacketError> StartSend(const scc &con, packet &pkt);
+	void StartSend(const scc &con, frame_ptr frame);
+	void Flush(const scc &con);
 	void HandleSend(const scc &con, const asio::error_code &ec, size_t bytesSent);
 	void StartTimeout(const scc &con);
 	void HandleTimeout(const scc &con, const asio::error_code &ec);
 	void DropConnection(const scc &con);
+	void RejectIncompatibleConnection(const scc &con);
+	void RejectJoinWithoutGame(const scc &con);
 	void RaiseIoHandlerError(const PacketError &error);
 };
 
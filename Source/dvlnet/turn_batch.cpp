@@ -0,0 +1,247 @@
+#include "dvlnet/turn_batch.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+#include <expected.hpp>
+
+#ifndef NONET
+#include "encrypt.h"
+#endif
+
+namespace devilution {
+namespace net {
+
+namespace {
+
+// Payload layout: a flags byte, followed by the entries.
+// Compressed payloads store the size of the entries before the compressed data.
+constexpr uint8_t BatchCompressed = 0x01;
+
+// Smaller payloads rarely get any smaller.
+constexpr size_t CompressionThreshold = 128;
+
+enum batch_entry_type : uint8_t {
+	// clang-format off
+	BE_TURN      = 0x01, // u8 sequence number, varint value
+	BE_NEXT_TURN = 0x02, // zigzag varint difference to the previous value, the sequence number is the previous one + 1
+	BE_MESSAGE   = 0x03, // varint size, data
+	// clang-format on
+};
+
+void WriteVarint(buffer_t &out, uint32_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<unsigned char>(value));
+}
+
+uint32_t ZigZagEncode(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t ZigZagDecode(uint32_t value)
+{
+	return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+PacketError BatchError()
+{
+	return PacketError("Invalid batch packet");
+}
+
+class batch_reader {
+public:
+	explicit batch_reader(std::span<const unsigned char> data)
+	    : data_(data)
+	{
+	}
+
+	bool empty() const
+	{
+		return data_.empty();
+	}
+
+	tl::expected<uint8_t, PacketError> ReadByte()
+	{
+		if (data_.empty())
+			return tl::make_unexpected(BatchError());
+		const uint8_t value = data_[0];
+		data_ = data_.subspan(1);
+		return value;
+	}
+
+	tl::expected<uint32_t, PacketError> ReadVarint()
+	{
+		uint32_t value = 0;
+		for (unsigned shift = 0; shift < 35; shift += 7) {
+			if (data_.empty())
+				return tl::make_unexpected(BatchError());
+			const uint8_t byte = data_[0];
+			data_ = data_.subspan(1);
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+		return tl::make_unexpected(BatchError());
+	}
+
+	tl::expected<std::span<const unsigned char>, PacketError> ReadBytes(size_t size)
+	{
+		if (data_.size() < size)
+			return tl::make_unexpected(BatchError());
+		const std::span<const unsigned char> bytes = data_.first(size);
+		data_ = data_.subspan(size);
+		return bytes;
+	}
+
+	std::span<const unsigned char> Rest() const
+	{
+		return data_;
+	}
+
+private:
+	std::span<const unsigned char> data_;
+};
+
+} // namespace
+
+void batch_encoder::AddTurn(turn_t turn)
+{
+	if (haveLastTurn_ && turn.SequenceNumber == static_cast<seq_t>(lastTurn_.SequenceNumber + 1)) {
+		entries_.push_back(BE_NEXT_TURN);
+		WriteVarint(entries_, ZigZagEncode(static_cast<int32_t>(static_cast<uint32_t>(turn.Value) - static_cast<uint32_t>(lastTurn_.Value))));
+	} else {
+		entries_.push_back(BE_TURN);
+		entries_.push_back(turn.SequenceNumber);
+		WriteVarint(entries_, static_cast<uint32_t>(turn.Value));
+	}
+	lastTurn_ = turn;
+	haveLastTurn_ = true;
+}
+
+void batch_encoder::AddMessage(std::span<const unsigned char> message)
+{
+	entries_.push_back(BE_MESSAGE);
+	WriteVarint(entries_, static_cast<uint32_t>(message.size()));
+	entries_.insert(entries_.end(), message.begin(), message.end());
+}
+
+buffer_t batch_encoder::Finish()
+{
+	buffer_t payload;
+#ifndef NONET
+	if (entries_.size() >= CompressionThreshold) {
+		payload.push_back(BatchCompressed);
+		WriteVarint(payload, static_cast<uint32_t>(entries_.size()));
+		const size_t headerSize = payload.size();
+		payload.insert(payload.end(), entries_.begin(), entries_.end());
+		const uint32_t compressedSize = PkwareCompress(reinterpret_cast<std::byte *>(payload.data() + headerSize), static_cast<uint32_t>(entries_.size()));
+		if (compressedSize < entries_.size()) {
+			payload.resize(headerSize + compressedSize);
+			entries_.clear();
+			return payload;
+		}
+		payload.clear();
+	}
+#endif
+	payload.reserve(1 + entries_.size());
+	payload.push_back(0);
+	payload.insert(payload.end(), entries_.begin(), entries_.end());
+	entries_.clear();
+	return payload;
+}
+
+void batch_encoder::Reset()
+{
+	entries_.clear();
+	haveLastTurn_ = false;
+}
+
+tl::expected<void, PacketError> batch_decoder::Decode(std::span<const unsigned char> payload,
+    tl::function_ref<void(turn_t)> onTurn,
+    tl::function_ref<void(std::span<const unsigned char>)> onMessage)
+{
+	batch_reader reader(payload);
+	tl::expected<uint8_t, PacketError> flags = reader.ReadByte();
+	if (!flags.has_value())
+		return tl::make_unexpected(flags.error());
+	if ((*flags & ~BatchCompressed) != 0)
+		return tl::make_unexpected(BatchError());
+
+	if ((*flags & BatchCompressed) != 0) {
+#ifndef NONET
+		tl::expected<uint32_t, PacketError> size = reader.ReadVarint();
+		if (!size.has_value())
+			return tl::make_unexpected(size.error());
+		if (*size > packet_factory::max_packet_size)
+			return tl::make_unexpected(BatchError());
+		if (workBuffer_ == nullptr)
+			workBuffer_ = std::make_unique<char[]>(PkwareDecompressWorkBufferSize());
+		decompressed_.resize(*size);
+		const std::span<const unsigned char> compressed = reader.Rest();
+		const uint32_t decompressedSize = PkwareDecompress(reinterpret_cast<const std::byte *>(compressed.data()), static_cast<uint32_t>(compressed.size()),
+		    reinterpret_cast<std::byte *>(decompressed_.data()), decompressed_.size(), workBuffer_.get());
+		if (decompressedSize != *size)
+			return tl::make_unexpected(BatchError());
+		reader = batch_reader(decompressed_);
+#else
+		return tl::make_unexpected(BatchError());
+#endif
+	}
+
+	while (!reader.empty()) {
+		tl::expected<uint8_t, PacketError> type = reader.ReadByte();
+		if (!type.has_value())
+			return tl::make_unexpected(type.error());
+		switch (*type) {
+		case BE_TURN: {
+			tl::expected<uint8_t, PacketError> sequenceNumber = reader.ReadByte();
+			if (!sequenceNumber.has_value())
+				return tl::make_unexpected(sequenceNumber.error());
+			tl::expected<uint32_t, PacketError> value = reader.ReadVarint();
+			if (!value.has_value())
+				return tl::make_unexpected(value.error());
+			lastTurn_ = turn_t { *sequenceNumber, static_cast<int32_t>(*value) };
+			haveLastTurn_ = true;
+			onTurn(lastTurn_);
+			break;
+		}
+		case BE_NEXT_TURN: {
+			tl::expected<uint32_t, PacketError> delta = reader.ReadVarint();
+			if (!delta.has_value())
+				return tl::make_unexpected(delta.error());
+			if (!haveLastTurn_)
+				break;
+			lastTurn_.SequenceNumber++;
+			lastTurn_.Value = static_cast<int32_t>(static_cast<uint32_t>(lastTurn_.Value) + static_cast<uint32_t>(ZigZagDecode(*delta)));
+			onTurn(lastTurn_);
+			break;
+		}
+		case BE_MESSAGE: {
+			tl::expected<std::span<const unsigned char>, PacketError> message
+			    = reader.ReadVarint().and_then([&](uint32_t size) { return reader.ReadBytes(size); });
+			if (!message.has_value())
+				return tl::make_unexpected(message.error());
+			onMessage(*message);
+			break;
+		}
+		default:
+			return tl::make_unexpected(BatchError());
+		}
+	}
+	return {};
+}
+
+void batch_decoder::Reset()
+{
+	haveLastTurn_ = false;
+}
+
+} // namespace net
+} // namespace devilution
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include <expected.hpp>
+#include <function_ref.hpp>
+
+#include "dvlnet/packet.h"
+
+namespace devilution {
+namespace net {
+
+/**
+ * @brief Collects the turns and messages of a game tick into the payload of a single `PT_BATCH` packet.
+ *
+ * Turns are delta-encoded against the previous turn in an earlier payload.
+ * Call `Reset` when a peer joins, so that the next payload starts with a complete turn.
+ */
+class batch_encoder {
+public:
+	/** Payloads with more bytes than this are split, see `size`. */
+	constexpr static size_t max_size = 4096;
+
+	void AddTurn(turn_t turn);
+	void AddMessage(std::span<const unsigned char> message);
+
+	/** @brief The number of bytes added since the last `Finish`, before compression. */
+	size_t size() const
+	{
+		return entries_.size();
+	}
+
+	bool empty() const
+	{
+		return entries_.empty();
+	}
+
+	/** @brief Returns the payload for everything added since the last call, compressed if that makes it smaller. */
+	buffer_t Finish();
+
+	/** @brief Discards unsent entries and the previous turn, e.g. when the peer leaves. */
+	void Reset();
+
+private:
+	buffer_t entries_;
+	turn_t lastTurn_ = {};
+	bool haveLastTurn_ = false;
+};
+
+/**
+ * @brief Decodes the `PT_BATCH` payloads produced by one peer's `batch_encoder`.
+ *
+ * A player that just joined can receive payloads that were sent before the sender knew about it.
+ * Turns in them that are delta-encoded against a turn this decoder has not seen are skipped.
+ */
+class batch_decoder {
+public:
+	/** @brief Calls `onTurn` and `onMessage` for the entries of `payload`, in the order they were added. */
+	tl::expected<void, PacketError> Decode(std::span<const unsigned char> payload,
+	    tl::function_ref<void(turn_t)> onTurn,
+	    tl::function_ref<void(std::span<const unsigned char>)> onMessage);
+
+	void Reset();
+
+private:
+	turn_t lastTurn_ = {};
+	bool haveLastTurn_ = false;
+	buffer_t decompressed_;
+	std::unique_ptr<char[]> workBuffer_;
+};
+
+} // namespace net
+} // namespace devilution
@@ -19,7 +19,7 @@ namespace devilution {
 namespace {
 
 struct TDataInfo {
-	std::byte *srcData;
+	const std::byte *srcData;
 	uint32_t srcOffset;
 	uint32_t srcSize;
 	std::byte *destData;
@@ -93,24 +93,34 @@ uint32_t PkwareCompress(std::byte *srcData, uint32_t size)
 
 uint32_t PkwareDecompress(std::byte *inBuff, uint32_t recvSize, size_t maxBytes)
 {
-	const std::unique_ptr<char[]> ptr = std::make_unique<char[]>(CMP_BUFFER_SIZE);
+	const std::unique_ptr<char[]> ptr = std::make_unique<char[]>(PkwareDecompressWorkBufferSize());
 	const std::unique_ptr<std::byte[]> outBuff { new std::byte[maxBytes] };
 
+	const uint32_t size = PkwareDecompress(inBuff, recvSize, outBuff.get(), maxBytes, ptr.get());
+	memcpy(inBuff, outBuff.get(), size);
+	return size;
+}
+
+size_t PkwareDecompressWorkBufferSize()
+{
+	return CMP_BUFFER_SIZE;
+}
+
+uint32_t PkwareDecompress(const std::byte *inBuff, uint32_t inSize, std::byte *outBuff, size_t outSize, char *workBuff)
+{
 	TDataInfo info;
 	info.srcData = inBuff;
 	info.srcOffset = 0;
-	info.srcSize = recvSize;
-	info.destData = outBuff.get();
+	info.srcSize = inSize;
+	info.destData = outBuff;
 	info.destOffset = 0;
-	info.destSize = maxBytes;
+	info.destSize = outSize;
 	info.error = false;
 
-	explode(PkwareBufferRead, PkwareBufferWrite, ptr.get(), &info);
+	explode(PkwareBufferRead, PkwareBufferWrite, workBuff, &info);
 	if (info.error) {
 		return 0;
 	}
-
-	memcpy(inBuff, outBuff.get(), info.destOffset);
 	return info.destOffset;
 }
 
@@ -13,4 +13,15 @@ namespace devilution {
 uint32_t PkwareCompress(std::byte *srcData, uint32_t size);
 uint32_t PkwareDecompress(std::byte *inBuff, uint32_t recvSize, size_t maxBytes);
 
+/** Size of the work buffer required by the `PkwareDecompress` overload below. */
+size_t PkwareDecompressWorkBufferSize();
+
+/**
+ * @brief Decompresses `inBuff` into `outBuff` without allocating.
+ *
+ * Can be called from several threads at the same time as long as each uses its own `workBuff`.
+ * @return The decompressed size, or 0 on error.
+ */
+uint32_t PkwareDecompress(const std::byte *inBuff, uint32_t inSize, std::byte *outBuff, size_t outSize, char *workBuff);
+
 } // namespace devilution
@@ -0,0 +1,360 @@
+#include "engine/asset_prefetch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <SDL.h>
+
+#include "appfat.h"
+#include "engine/assets.hpp"
+#include "utils/algorithm/container.hpp"
+#include "utils/log.hpp"
+#include "utils/sdl_mutex.h"
+
+#ifndef DEVILUTIONX_ASSET_PREFETCH_BUDGET
+#define DEVILUTIONX_ASSET_PREFETCH_BUDGET (32 * 1024 * 1024)
+#endif
+
+namespace devilution {
+
+#ifdef UNPACKED_MPQS
+void PrefetchAssets(std::vector<std::string> /*paths*/)
+{
+}
+
+void CancelAssetPrefetch()
+{
+}
+
+void ShutdownAssetPrefetch()
+{
+}
+
+void SetAssetPrefetchBudget(size_t /*budget*/)
+{
+}
+
+size_t GetAssetPrefetchBudget()
+{
+	return 0;
+}
+#else
+namespace {
+
+struct PrefetchedAsset {
+	std::string path;
+	const MpqArchive *archive;
+	uint32_t fileNumber;
+	AssetData data;
+};
+
+#ifndef USE_SDL1
+using OffsetType = Sint64;
+using SizeType = size_t;
+#else
+using OffsetType = int;
+using SizeType = int;
+#endif
+
+struct MemoryRwData {
+	AssetData data;
+	size_t position;
+};
+
+MemoryRwData *GetData(struct SDL_RWops *context)
+{
+	return reinterpret_cast<MemoryRwData *>(context->hidden.unknown.data1);
+}
+
+extern "C" {
+
+#ifndef USE_SDL1
+static Sint64 MemoryRwSize(struct SDL_RWops *context)
+{
+	return static_cast<Sint64>(GetData(context)->data.size);
+}
+#endif
+
+static OffsetType MemoryRwSeek(struct SDL_RWops *context, OffsetType offset, int whence)
+{
+	MemoryRwData &data = *GetData(context);
+	OffsetType newPosition;
+	switch (whence) {
+	case RW_SEEK_SET:
+		newPosition = offset;
+		break;
+	case RW_SEEK_CUR:
+		newPosition = static_cast<OffsetType>(data.position + offset);
+		break;
+	case RW_SEEK_END:
+		newPosition = static_cast<OffsetType>(data.data.size + offset);
+		break;
+	default:
+		return -1;
+	}
+	if (newPosition < 0 || newPosition > static_cast<OffsetType>(data.data.size)) {
+		SDL_SetError("MemoryRwSeek out of bounds (%d)", static_cast<int>(newPosition));
+		return -1;
+	}
+	data.position = static_cast<size_t>(newPosition);
+	return newPosition;
+}
+
+static SizeType MemoryRwRead(struct SDL_RWops *context, void *ptr, SizeType size, SizeType maxnum)
+{
+	MemoryRwData &data = *GetData(context);
+	if (size == 0)
+		return 0;
+	const SizeType num = std::min<SizeType>(maxnum, static_cast<SizeType>((data.data.size - data.position) / size));
+	const size_t numBytes = static_cast<size_t>(num) * size;
+	std::memcpy(ptr, &data.data.data[data.position], numBytes);
+	data.position += numBytes;
+	return num;
+}
+
+static int MemoryRwClose(struct SDL_RWops *context)
+{
+	delete GetData(context);
+	delete context;
+	return 0;
+}
+
+} // extern "C"
+
+SDL_RWops *SDL_RWops_FromAssetData(AssetData &&assetData)
+{
+	auto result = std::make_unique<SDL_RWops>();
+	std::memset(result.get(), 0, sizeof(*result));
+
+#ifndef USE_SDL1
+	result->size = &MemoryRwSize;
+	result->type = SDL_RWOPS_UNKNOWN;
+#else
+	result->type = 0;
+#endif
+
+	result->seek = &MemoryRwSeek;
+	result->read = &MemoryRwRead;
+	result->write = nullptr;
+	result->close = &MemoryRwClose;
+	result->hidden.unknown.data1 = new MemoryRwData { std::move(assetData), 0 };
+	return result.release();
+}
+
+struct SdlCondDeleter {
+	void operator()(SDL_cond *cond) const { SDL_DestroyCond(cond); }
+};
+
+struct SdlThreadDeleter {
+	void operator()(SDL_Thread *thread) const { SDL_WaitThread(thread, nullptr); }
+};
+
+std::atomic<size_t> Budget = DEVILUTIONX_ASSET_PREFETCH_BUDGET;
+
+class AssetPrefetcher {
+public:
+	AssetPrefetcher()
+	    : cond_(SDL_CreateCond())
+	{
+		if (cond_ == nullptr)
+			ErrSdl();
+	}
+
+	void start()
+	{
+#ifdef USE_SDL1
+		thread_.reset(SDL_CreateThread(WorkerMain, this));
+#else
+		thread_.reset(SDL_CreateThread(WorkerMain, "asset_prefetch", this));
+#endif
+		if (thread_ == nullptr)
+			ErrSdl();
+	}
+
+	void stop()
+	{
+		{
+			const std::lock_guard<SdlMutex> lock(mutex_);
+			stopping_ = true;
+			SDL_CondBroadcast(cond_.get());
+		}
+		thread_ = nullptr;
+	}
+
+	void request(std::vector<std::string> paths)
+	{
+		const std::lock_guard<SdlMutex> lock(mutex_);
+		for (auto it = prefetched_.begin(); it != prefetched_.end();) {
+			if (c_find(paths, it->path) == paths.end()) {
+				prefetchedSize_ -= it->data.size;
+				it = prefetched_.erase(it);
+			} else {
+				++it;
+			}
+		}
+		if (busy_ && c_find(paths, inFlightPath_) == paths.end())
+			++generation_;
+
+		queue_.clear();
+		for (std::string &path : paths) {
+			if (busy_ && generation_ == inFlightGeneration_ && path == inFlightPath_)
+				continue;
+			if (c_find_if(prefetched_, [&path](const PrefetchedAsset &asset) { return asset.path == path; }) != prefetched_.end())
+				continue;
+			queue_.push_back(std::move(path));
+		}
+		SDL_CondBroadcast(cond_.get());
+	}
+
+	void cancel()
+	{
+		const std::lock_guard<SdlMutex> lock(mutex_);
+		++generation_;
+		queue_.clear();
+		while (busy_) {
+			SDL_CondWait(cond_.get(), mutex_.get());
+		}
+		prefetched_.clear();
+		prefetchedSize_ = 0;
+	}
+
+	SDL_RWops *take(const MpqArchive &archive, uint32_t fileNumber)
+	{
+		const std::lock_guard<SdlMutex> lock(mutex_);
+		const auto it = c_find_if(prefetched_, [&](const PrefetchedAsset &asset) {
+			return asset.archive == &archive && asset.fileNumber == fileNumber;
+		});
+		if (it == prefetched_.end())
+			return nullptr;
+		AssetData data = std::move(it->data);
+		prefetchedSize_ -= data.size;
+		prefetched_.erase(it);
+		return SDL_RWops_FromAssetData(std::move(data));
+	}
+
+private:
+	static int SDLCALL WorkerMain(void *data)
+	{
+#ifndef USE_SDL1
+		SDL_SetThreadPriority(SDL_THREAD_PRIORITY_LOW);
+#endif
+		auto &prefetcher = *static_cast<AssetPrefetcher *>(data);
+		const std::lock_guard<SdlMutex> lock(prefetcher.mutex_);
+		while (true) {
+			while (!prefetcher.stopping_ && prefetcher.queue_.empty()) {
+				SDL_CondWait(prefetcher.cond_.get(), prefetcher.mutex_.get());
+			}
+			if (prefetcher.stopping_)
+				return 0;
+			prefetcher.prefetchNext();
+		}
+	}
+
+	/** Must be called with `mutex_` held. Releases it while the file is being read. */
+	void prefetchNext()
+	{
+		inFlightPath_ = std::move(queue_.front());
+		queue_.pop_front();
+		inFlightGeneration_ = generation_;
+		busy_ = true;
+
+		mutex_.unlock();
+		AssetRef ref = FindAsset(inFlightPath_);
+		const size_t size = ref.archive != nullptr ? ref.size() : 0;
+		mutex_.lock();
+
+		if (ref.archive != nullptr && inFlightGeneration_ == generation_ && prefetchedSize_ + size <= Budget) {
+			// Reserve the budget while reading.
+			prefetchedSize_ += size;
+			PrefetchedAsset asset { inFlightPath_, ref.archive, ref.fileNumber, AssetData { std::unique_ptr<char[]> { new char[size] }, size } };
+			mutex_.unlock();
+			AssetHandle handle = OpenAsset(std::move(ref));
+			const bool ok = handle.ok() && (size == 0 || handle.read(asset.data.data.get(), size));
+			if (!ok)
+				LogVerbose("Failed to prefetch {}: {}", asset.path, handle.error());
+			mutex_.lock();
+			if (ok && inFlightGeneration_ == generation_) {
+				prefetched_.push_back(std::move(asset));
+			} else {
+				prefetchedSize_ -= size;
+			}
+		}
+
+		busy_ = false;
+		SDL_CondBroadcast(cond_.get());
+	}
+
+	SdlMutex mutex_;
+	std::unique_ptr<SDL_cond, SdlCondDeleter> cond_;
+	std::unique_ptr<SDL_Thread, SdlThreadDeleter> thread_;
+
+	std::deque<std::string> queue_;
+	std::vector<PrefetchedAsset> prefetched_;
+	size_t prefetchedSize_ = 0;
+
+	std::string inFlightPath_;
+	uint32_t inFlightGeneration_ = 0;
+	uint32_t generation_ = 0;
+	bool busy_ = false;
+	bool stopping_ = false;
+};
+
+std::unique_ptr<AssetPrefetcher> Prefetcher;
+
+} // namespace
+
+void PrefetchAssets(std::vector<std::string> paths)
+{
+	if (Prefetcher == nullptr) {
+		if (paths.empty() || Budget == 0)
+			return;
+		Prefetcher = std::make_unique<AssetPrefetcher>();
+		Prefetcher->start();
+	}
+	Prefetcher->request(std::move(paths));
+}
+
+void CancelAssetPrefetch()
+{
+	if (Prefetcher != nullptr)
+		Prefetcher->cancel();
+}
+
+void ShutdownAssetPrefetch()
+{
+	if (Prefetcher == nullptr)
+		return;
+	Prefetcher->cancel();
+	Prefetcher->stop();
+	Prefetcher = nullptr;
+}
+
+void SetAssetPrefetchBudget(size_t budget)
+{
+	CancelAssetPrefetch();
+	Budget = budget;
+}
+
+size_t GetAssetPrefetchBudget()
+{
+	return Budget;
+}
+
+SDL_RWops *TakePrefetchedAsset(const MpqArchive &archive, uint32_t fileNumber)
+{
+	if (Prefetcher == nullptr)
+		return nullptr;
+	return Prefetcher->take(archive, fileNumber);
+}
+#endif
+
+} // namespace devilution
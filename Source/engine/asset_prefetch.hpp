@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <SDL.h>
+
+#ifndef UNPACKED_MPQS
+#include "mpq/mpq_reader.hpp"
+#endif
+
+namespace devilution {
+
+/**
+ * @brief Reads the given MPQ files into memory on a low-priority background thread.
+ *
+ * Replaces the previous request: prefetched files that are not in `paths` are freed.
+ * Files that do not fit into the remaining memory budget are skipped.
+ * Files found outside of the MPQ archives (e.g. mod overrides) are never prefetched.
+ *
+ * Does nothing in unpacked MPQ builds, where there is nothing to decompress.
+ */
+void PrefetchAssets(std::vector<std::string> paths);
+
+/**
+ * @brief Stops prefetching and frees all the prefetched files.
+ *
+ * Waits for the file currently being read. Must be called before modifying `MpqArchives`.
+ */
+void CancelAssetPrefetch();
+
+/** @brief Cancels prefetching and stops the background thread. */
+void ShutdownAssetPrefetch();
+
+/**
+ * @brief Sets the maximum total size of the prefetched files in bytes. 0 disables prefetching.
+ *
+ * The default is set by the `DEVILUTIONX_ASSET_PREFETCH_BUDGET` build option.
+ */
+void SetAssetPrefetchBudget(size_t budget);
+
+size_t GetAssetPrefetchBudget();
+
+#ifndef UNPACKED_MPQS
+/**
+ * @brief Returns a handle to the prefetched contents of the given MPQ file, or nullptr if it has not been prefetched.
+ *
+ * The handle takes ownership of the contents, so a file can only be taken once.
+ */
+SDL_RWops *TakePrefetchedAsset(const MpqArchive &archive, uint32_t fileNumber);
+#endif
+
+} // namespace devilution
@@ -1,12 +1,19 @@
 #include "engine/assets.hpp"
 
 #include <algorithm>
+#include <cctype>
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
+#include <function_ref.hpp>
+
 #include "appfat.h"
+#include "engine/asset_prefetch.hpp"
 #include "game_mode.hpp"
 #include "utils/file_util.h"
 #include "utils/log.hpp"
@@ -30,17 +37,50 @@ bool HasHellfireMpq;
 
 namespace {
 
+/** Calls `fn` with the path of every file under `root`, relative to it. */
+void ForEachFileRecursively(const std::string &root, const std::string &relativeDir, tl::function_ref<void(std::string_view)> fn)
+{
+	const std::string dir = root + relativeDir;
+	for (const std::string &name : ListFiles(dir.c_str())) {
+		fn(StrCat(relativeDir, name));
+	}
+	for (const std::string &name : ListDirectories(dir.c_str())) {
+		ForEachFileRecursively(root, StrCat(relativeDir, name, DIRECTORY_SEPARATOR_STR), fn);
+	}
+}
+
 #ifdef UNPACKED_MPQS
-char *FindUnpackedMpqFile(char *relativePath)
+/**
+ * @brief Maps lowercase asset paths with backslash separators to the path of the file in the highest priority unpacked MPQ directory.
+ *
+ * Rebuilt whenever the unpacked MPQ directories change, so that a lookup does not probe each of them.
+ */
+std::unordered_map<std::string, std::string> AssetIndex;
+
+std::string NormalizeAssetPath(std::string_view path)
+{
+	std::string result { path };
+	for (char &c : result) {
+		c = c == '/' ? '\\' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+	return result;
+}
+
+void RebuildAssetIndex()
 {
-	char *path = nullptr;
-	for (const auto &[_, unpackedDir] : MpqArchives) {
-		path = relativePath - unpackedDir.size();
-		std::memcpy(path, unpackedDir.data(), unpackedDir.size());
-		if (FileExists(path)) break;
-		path = nullptr;
+	AssetIndex.clear();
+	for (const auto &entry : MpqArchives) {
+		const std::string &unpackedDir = entry.second;
+		ForEachFileRecursively(unpackedDir, {}, [&](std::string_view relativePath) {
+			AssetIndex.try_emplace(NormalizeAssetPath(relativePath), StrCat(unpackedDir, relativePath));
+		});
 	}
-	return path;
+	LogVerbose("Indexed {} assets", AssetIndex.size());
+}
+
+void ClearAssetIndex()
+{
+	AssetIndex.clear();
 }
 #else
 bool IsDebugLogging()
@@ -57,6 +97,96 @@ SDL_RWops *OpenOptionalRWops(const std::string &path)
 	return SDL_RWFromFile(path.c_str(), "rb");
 };
 
+/**
+ * @brief The highest priority loose file and MPQ archive file with the same name.
+ *
+ * The archive file is kept as a fallback in case the loose file can no longer be opened.
+ */
+struct IndexedAsset {
+	// The index into `IndexedLooseFiles`, or -1 if there is no loose file.
+	int32_t looseFile = -1;
+	MpqArchive *archive = nullptr;
+	uint32_t fileNumber = 0;
+};
+
+/**
+ * @brief Maps the name hashes of asset paths to the highest priority file across the override directories and MPQ archives.
+ *
+ * Rebuilt whenever the archives or the override directories change, so that a lookup is a single hash probe.
+ */
+std::unordered_map<uint64_t, IndexedAsset> AssetIndex;
+std::vector<std::string> IndexedLooseFiles;
+
+/** Whether `AssetIndex` is usable. If an archive's hash table cannot be read, lookups fall back to probing each archive. */
+bool HaveAssetIndex;
+
+/**
+ * @brief Whether the loose files under `overridePath` are indexed.
+ *
+ * The `PrefPath()` directory also holds the saves, the mods and the converted asset cache,
+ * so it is probed on each lookup instead of being walked.
+ */
+bool IsIndexedOverridePath(const std::string &overridePath)
+{
+	return overridePath != paths::PrefPath();
+}
+
+uint64_t AssetIndexKey(uint32_t hashA, uint32_t hashB)
+{
+	return (static_cast<uint64_t>(hashA) << 32) | hashB;
+}
+
+uint64_t AssetIndexKey(std::string_view path)
+{
+	std::string normalized { path };
+	std::replace(normalized.begin(), normalized.end(), '/', '\\');
+	const MpqFileHash fileHash = CalculateMpqFileHash(normalized);
+	return AssetIndexKey(fileHash[1], fileHash[2]);
+}
+
+void ClearAssetIndex()
+{
+	AssetIndex.clear();
+	IndexedLooseFiles.clear();
+	HaveAssetIndex = false;
+}
+
+void RebuildAssetIndex()
+{
+	CancelAssetPrefetch();
+	ClearAssetIndex();
+	HaveAssetIndex = true;
+
+	for (const std::string &overridePath : OverridePaths) {
+		if (!IsIndexedOverridePath(overridePath))
+			continue;
+		ForEachFileRecursively(overridePath, {}, [&](std::string_view relativePath) {
+			IndexedAsset asset;
+			asset.looseFile = static_cast<int32_t>(IndexedLooseFiles.size());
+			const auto [_, inserted] = AssetIndex.try_emplace(AssetIndexKey(relativePath), asset);
+			if (inserted)
+				IndexedLooseFiles.push_back(StrCat(overridePath, relativePath));
+		});
+	}
+
+	for (auto &entry : MpqArchives) {
+		MpqArchive &mpqArchive = entry.second;
+		const bool ok = mpqArchive.ForEachFile([&](uint32_t hashA, uint32_t hashB, uint32_t fileNumber) {
+			IndexedAsset &asset = AssetIndex[AssetIndexKey(hashA, hashB)];
+			if (asset.archive == nullptr) {
+				asset.archive = &mpqArchive;
+				asset.fileNumber = fileNumber;
+			}
+		});
+		if (!ok) {
+			LogVerbose("Cannot index {}, asset lookups will probe each archive", mpqArchive.GetPath());
+			ClearAssetIndex();
+			return;
+		}
+	}
+	LogVerbose("Indexed {} assets", AssetIndex.size());
+}
+
 bool FindMpqFile(std::string_view filename, MpqArchive **archive, uint32_t *fileNumber)
 {
 	const MpqFileHash fileHash = CalculateMpqFileHash(filename);
@@ -100,9 +230,9 @@ AssetRef FindAsset(std::string_view filename)
 	}
 
 	// Unpacked MPQ file:
-	char *const unpackedMpqPath = FindUnpackedMpqFile(relativePath);
-	if (unpackedMpqPath != nullptr) {
-		*BufCopy(result.path, std::string_view(unpackedMpqPath, pathEnd - unpackedMpqPath)) = '\0';
+	const auto it = AssetIndex.find(NormalizeAssetPath(filename));
+	if (it != AssetIndex.end()) {
+		*BufCopy(result.path, it->second) = '\0';
 		return result;
 	}
 
@@ -134,9 +264,21 @@ AssetRef FindAsset(std::string_view filename)
 		}
 	}
 
-	// Files in the `PrefPath()` directory can override MPQ contents.
-	{
+	if (HaveAssetIndex) {
+		const auto it = AssetIndex.find(AssetIndexKey(filename));
+		const IndexedAsset *asset = it != AssetIndex.end() ? &it->second : nullptr;
+		if (asset != nullptr && asset->looseFile >= 0) {
+			const std::string &path = IndexedLooseFiles[asset->looseFile];
+			result.directHandle = SDL_RWFromFile(path.c_str(), "rb");
+			if (result.directHandle != nullptr) {
+				LogVerbose("Loaded MPQ file override: {}", path);
+				return result;
+			}
+		}
+
 		for (const auto &overridePath : OverridePaths) {
+			if (IsIndexedOverridePath(overridePath))
+				continue;
 			const std::string path = overridePath + relativePath;
 			result.directHandle = OpenOptionalRWops(path);
 			if (result.directHandle != nullptr) {
@@ -144,12 +286,29 @@ AssetRef FindAsset(std::string_view filename)
 				return result;
 			}
 		}
-	}
 
-	// Look for the file in all the MPQ archives:
-	if (FindMpqFile(filename, &result.archive, &result.fileNumber)) {
-		result.filename = filename;
-		return result;
+		if (asset != nullptr && asset->archive != nullptr) {
+			result.archive = asset->archive;
+			result.fileNumber = asset->fileNumber;
+			result.filename = filename;
+			return result;
+		}
+	} else {
+		// Files in the `PrefPath()` directory can override MPQ contents.
+		for (const auto &overridePath : OverridePaths) {
+			const std::string path = overridePath + relativePath;
+			result.directHandle = OpenOptionalRWops(path);
+			if (result.directHandle != nullptr) {
+				LogVerbose("Loaded MPQ file override: {}", path);
+				return result;
+			}
+		}
+
+		// Look for the file in all the MPQ archives:
+		if (FindMpqFile(filename, &result.archive, &result.fileNumber)) {
+			result.filename = filename;
+			return result;
+		}
 	}
 
 	// Load from the `/assets` directory next to the devilutionx binary.
@@ -171,13 +330,17 @@ AssetRef FindAsset(std::string_view filename)
 }
 #endif
 
-AssetHandle OpenAsset(AssetRef &&ref, bool threadsafe)
+AssetHandle OpenAsset(AssetRef &&ref)
 {
 #if UNPACKED_MPQS
 	return AssetHandle { OpenFile(ref.path, "rb") };
 #else
-	if (ref.archive != nullptr)
-		return AssetHandle { SDL_RWops_FromMpqFile(*ref.archive, ref.fileNumber, ref.filename, threadsafe) };
+	if (ref.archive != nullptr) {
+		SDL_RWops *prefetched = TakePrefetchedAsset(*ref.archive, ref.fileNumber);
+		if (prefetched != nullptr)
+			return AssetHandle { prefetched };
+		return AssetHandle { SDL_RWops_FromMpqFile(*ref.archive, ref.fileNumber, ref.filename) };
+	}
 	if (ref.directHandle != nullptr) {
 		// Transfer handle ownership:
 		SDL_RWops *handle = ref.directHandle;
@@ -188,24 +351,24 @@ AssetHandle OpenAsset(AssetRef &&ref, bool threadsafe)
 #endif
 }
 
-AssetHandle OpenAsset(std::string_view filename, bool threadsafe)
+AssetHandle OpenAsset(std::string_view filename)
 {
 	AssetRef ref = FindAsset(filename);
 	if (!ref.ok())
 		return AssetHandle {};
-	return OpenAsset(std::move(ref), threadsafe);
+	return OpenAsset(std::move(ref));
 }
 
-AssetHandle OpenAsset(std::string_view filename, size_t &fileSize, bool threadsafe)
+AssetHandle OpenAsset(std::string_view filename, size_t &fileSize)
 {
 	AssetRef ref = FindAsset(filename);
 	if (!ref.ok())
 		return AssetHandle {};
 	fileSize = ref.size();
-	return OpenAsset(std::move(ref), threadsafe);
+	return OpenAsset(std::move(ref));
 }
 
-SDL_RWops *OpenAssetAsSdlRwOps(std::string_view filename, bool threadsafe)
+SDL_RWops *OpenAssetAsSdlRwOps(std::string_view filename)
 {
 #ifdef UNPACKED_MPQS
 	AssetRef ref = FindAsset(filename);
@@ -213,7 +376,7 @@ SDL_RWops *OpenAssetAsSdlRwOps(std::string_view filename, bool threadsafe)
 		return nullptr;
 	return SDL_RWFromFile(ref.path, "rb");
 #else
-	return OpenAsset(filename, threadsafe).release();
+	return OpenAsset(filename).release();
 #endif
 }
 
@@ -301,6 +464,7 @@ bool LoadMPQ(std::span<const std::string> paths, std::string_view mpqName, int p
 		archive = MpqArchive::Open(mpqAbsPath.c_str(), error);
 		if (archive.has_value()) {
 			LogVerbose("  Found: {} in {}", mpqName, path);
+			CancelAssetPrefetch();
 			auto [it, inserted] = MpqArchives.emplace(priority, *std::move(archive));
 			if (!inserted) {
 				LogError("MPQ with priority {} is already registered, skipping {}", priority, mpqName);
@@ -387,15 +551,18 @@ void LoadCoreArchives()
 #endif
 	LoadMPQ(paths, "fonts", FontMpqPriority); // Extra fonts
 	HasHellfireMpq = FindMPQ(paths, "hellfire");
+	RebuildAssetIndex();
 }
 
 void LoadLanguageArchive()
 {
+	CancelAssetPrefetch();
 	MpqArchives.erase(LangMpqPriority);
 	const std::string_view code = GetLanguageCode();
 	if (code != "en") {
 		LoadMPQ(GetMPQSearchPaths(), code, LangMpqPriority);
 	}
+	RebuildAssetIndex();
 }
 
 void LoadGameArchives()
@@ -436,6 +603,7 @@ void LoadGameArchives()
 	LoadMPQ(paths, "hfbard", 8110);
 	LoadMPQ(paths, "hfbarb", 8120);
 #endif
+	RebuildAssetIndex();
 }
 
 void LoadHellfireArchives()
@@ -455,6 +623,7 @@ void LoadHellfireArchives()
 	const bool hasMusic = LoadMPQ(paths, "hfmusic", 8200);
 	const bool hasVoice = LoadMPQ(paths, "hfvoice", 8500);
 #endif
+	RebuildAssetIndex();
 
 	if (!hasMonk || !hasMusic || !hasVoice)
 		DisplayFatalErrorAndExit(_("Some Hellfire MPQs are missing"), _("Not all Hellfire MPQs were found.\nPlease copy all the hf*.mpq files."));
@@ -462,6 +631,7 @@ void LoadHellfireArchives()
 
 void UnloadModArchives()
 {
+	CancelAssetPrefetch();
 	OverridePaths.clear();
 
 #ifndef UNPACKED_MPQS
@@ -473,10 +643,12 @@ void UnloadModArchives()
 		}
 	}
 #endif
+	RebuildAssetIndex();
 }
 
 void LoadModArchives(std::span<const std::string_view> modnames)
 {
+	CancelAssetPrefetch();
 	std::string targetPath;
 	for (const std::string_view modname : modnames) {
 		targetPath = StrCat(paths::PrefPath(), "mods" DIRECTORY_SEPARATOR_STR, modname, DIRECTORY_SEPARATOR_STR);
@@ -496,6 +668,15 @@ void LoadModArchives(std::span<const std::string_view> modnames)
 		LoadMPQ(paths, StrCat("mods" DIRECTORY_SEPARATOR_STR, modname), priority);
 		priority++;
 	}
+	RebuildAssetIndex();
+}
+
+void UnloadArchives()
+{
+	CancelAssetPrefetch();
+	ClearAssetIndex();
+	MpqArchives.clear();
+	HasHellfireMpq = false;
 }
 
 } // namespace devilution
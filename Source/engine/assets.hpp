@@ -261,11 +261,11 @@ inline bool ValidateHandle(std::string_view path, const AssetHandle &handle)
 
 AssetRef FindAsset(std::string_view filename);
 
-AssetHandle OpenAsset(AssetRef &&ref, bool threadsafe = false);
-AssetHandle OpenAsset(std::string_view filename, bool threadsafe = false);
-AssetHandle OpenAsset(std::string_view filename, size_t &fileSize, bool threadsafe = false);
+AssetHandle OpenAsset(AssetRef &&ref);
+AssetHandle OpenAsset(std::string_view filename);
+AssetHandle OpenAsset(std::string_view filename, size_t &fileSize);
 
-SDL_RWops *OpenAssetAsSdlRwOps(std::string_view filename, bool threadsafe = false);
+SDL_RWops *OpenAssetAsSdlRwOps(std::string_view filename);
 
 struct AssetData {
 	std::unique_ptr<char[]> data;
@@ -298,6 +298,7 @@ void LoadGameArchives();
 void LoadHellfireArchives();
 void UnloadModArchives();
 void LoadModArchives(std::span<const std::string_view> modnames);
+void UnloadArchives();
 
 #ifdef BUILD_TESTING
 [[nodiscard]] inline bool HaveMainData() { return MpqArchives.find(MainMpqPriority) != MpqArchives.end(); }
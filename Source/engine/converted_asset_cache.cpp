@@ -0,0 +1,323 @@
+#include "engine/converted_asset_cache.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "headless_mode.hpp"
+#ifndef UNPACKED_MPQS
+#include "mpq/mpq_common.hpp"
+#endif
+#include "utils/endian_read.hpp"
+#include "utils/endian_write.hpp"
+#include "utils/file_util.h"
+#include "utils/log.hpp"
+#include "utils/paths.h"
+#include "utils/str_cat.hpp"
+
+namespace devilution {
+
+namespace {
+
+constexpr char CacheMagic[4] = { 'D', 'X', 'C', 'C' };
+
+/** @brief Bump this whenever the entry layout or the key format changes. */
+constexpr uint32_t CacheFormatVersion = 2;
+
+/**
+ * Entry header:
+ *
+ *  Bytes |   Type   | Value
+ * :-----:|:--------:|-------------
+ *  0..4  | char[4]  | magic
+ *  4..8  | uint32_t | format version
+ *  8..12 | uint32_t | key size
+ * 12..16 | uint32_t | data size
+ * 16..18 | uint16_t | number of CLX lists (0 for a list or for raw data)
+ * 18..20 | uint16_t | reserved
+ *
+ * The header is followed by the key and then the data.
+ */
+constexpr size_t HeaderSize = 20;
+
+const std::string &CacheDir()
+{
+	static const std::string Dir = StrCat(paths::PrefPath(), "cache" DIRECTORY_SEPARATOR_STR);
+	return Dir;
+}
+
+struct FileCloser {
+	void operator()(FILE *file) const
+	{
+		std::fclose(file);
+	}
+};
+
+using FilePtr = std::unique_ptr<FILE, FileCloser>;
+
+#ifndef UNPACKED_MPQS
+/**
+ * @brief Hashes the MPQ header and the raw hash and block tables.
+ *
+ * The block table stores the offset and the size of every file in the archive,
+ * so this changes whenever the archive is rebuilt, even if its total size stays the same.
+ */
+std::optional<uint64_t> ComputeArchiveChecksum(const std::string &archivePath, std::uintmax_t archiveSize)
+{
+	const FilePtr file { OpenFile(archivePath.c_str(), "rb") };
+	if (file == nullptr)
+		return std::nullopt;
+
+	uint8_t header[MpqFileHeader::DiabloSize];
+	if (std::fread(header, sizeof(header), 1, file.get()) != 1
+	    || LoadLE32(&header[0]) != MpqFileHeader::DiabloSignature)
+		return std::nullopt;
+	uint64_t checksum = StableHash64(header, sizeof(header));
+
+	constexpr size_t TableEntrySize = 16;
+	const std::pair<uint32_t, uint32_t> tables[] = {
+		{ LoadLE32(&header[16]), LoadLE32(&header[24]) }, // hash table offset and count
+		{ LoadLE32(&header[20]), LoadLE32(&header[28]) }, // block table offset and count
+	};
+	std::unique_ptr<uint8_t[]> buf;
+	for (const auto &[offset, count] : tables) {
+		// Malformed counts would otherwise make us allocate up to 64 GiB.
+		if (count > MaxHashEntriesCount || offset > archiveSize || count * TableEntrySize > archiveSize - offset)
+			return std::nullopt;
+		const size_t tableSize = static_cast<size_t>(count) * TableEntrySize;
+		buf.reset(new uint8_t[tableSize]);
+		if (std::fseek(file.get(), static_cast<long>(offset), SEEK_SET) != 0
+		    || (tableSize != 0 && std::fread(buf.get(), tableSize, 1, file.get()) != 1))
+			return std::nullopt;
+		checksum = StableHash64(buf.get(), tableSize, checksum);
+	}
+	return checksum;
+}
+
+/**
+ * @brief Returns the archive line of the cache key: `<path>:<size>:<checksum>`.
+ *
+ * Memoized, as the archives do not change while the game is running.
+ */
+const std::optional<std::string> &ArchiveKey(const std::string &archivePath)
+{
+	static std::unordered_map<std::string, std::optional<std::string>> Keys;
+	auto it = Keys.find(archivePath);
+	if (it != Keys.end())
+		return it->second;
+
+	std::optional<std::string> archiveKey;
+	std::uintmax_t archiveSize;
+	if (GetFileSize(archivePath.c_str(), &archiveSize)) {
+		const std::optional<uint64_t> checksum = ComputeArchiveChecksum(archivePath, archiveSize);
+		if (checksum)
+			archiveKey = fmt::format("{}:{}:{:016x}", archivePath, archiveSize, *checksum);
+	}
+	return Keys.emplace(archivePath, std::move(archiveKey)).first->second;
+}
+
+/** @brief Whether the archive line of a stored key still matches the archive on disk. */
+bool IsArchiveKeyCurrent(std::string_view storedArchiveKey)
+{
+	// The path may itself contain colons, so split from the right.
+	const size_t checksumSep = storedArchiveKey.rfind(':');
+	if (checksumSep == std::string_view::npos || checksumSep == 0)
+		return false;
+	const size_t sizeSep = storedArchiveKey.rfind(':', checksumSep - 1);
+	if (sizeSep == std::string_view::npos)
+		return false;
+	const std::optional<std::string> &current = ArchiveKey(std::string(storedArchiveKey.substr(0, sizeSep)));
+	return current && *current == storedArchiveKey;
+}
+#endif
+
+/**
+ * @brief Reads and validates the header of a cache entry.
+ *
+ * The key and data sizes are checked against the file size, so that a corrupt entry
+ * is treated as stale instead of making us allocate whatever size it claims.
+ */
+bool ReadEntryHeader(FILE *file, const std::string &path, uint8_t (&header)[HeaderSize])
+{
+	std::uintmax_t fileSize;
+	return GetFileSize(path.c_str(), &fileSize)
+	    && std::fread(header, sizeof(header), 1, file) == 1
+	    && std::memcmp(header, CacheMagic, sizeof(CacheMagic)) == 0
+	    && LoadLE32(&header[4]) == CacheFormatVersion
+	    && HeaderSize + static_cast<std::uintmax_t>(LoadLE32(&header[8])) + LoadLE32(&header[12]) == fileSize;
+}
+
+/**
+ * @brief Removes entries from an older cache format, entries whose archive has changed or is gone,
+ * and temporary files left behind by a crash.
+ *
+ * Without this, the cache would grow with every game or mod update.
+ */
+void PruneCache()
+{
+	const std::string &dir = CacheDir();
+	for (const std::string &name : ListFiles(dir.c_str())) {
+		const std::string path = StrCat(dir, name);
+		bool keep = false;
+		if (std::string_view(name).ends_with(".bin")) {
+			const FilePtr file { OpenFile(path.c_str(), "rb") };
+			uint8_t header[HeaderSize];
+			if (file != nullptr && ReadEntryHeader(file.get(), path, header)) {
+				std::string storedKey(LoadLE32(&header[8]), '\0');
+				if (std::fread(storedKey.data(), storedKey.size(), 1, file.get()) == 1) {
+#ifndef UNPACKED_MPQS
+					// The archive is on the third line of the key, see `ConvertedAssetCacheKey::ForAsset`.
+					const size_t begin = storedKey.find('\n', storedKey.find('\n') + 1);
+					const size_t end = begin != std::string::npos ? storedKey.find('\n', begin + 1) : std::string::npos;
+					keep = end != std::string::npos
+					    && IsArchiveKeyCurrent(std::string_view(storedKey).substr(begin + 1, end - begin - 1));
+#endif
+				}
+			}
+		}
+		if (!keep) {
+			LogVerbose("Pruning converted asset cache entry: {}", path);
+			RemoveFile(path.c_str());
+		}
+	}
+}
+
+template <typename T>
+std::unique_ptr<T[]> LoadEntry(const ConvertedAssetCacheKey &key, size_t &size, uint16_t &numLists)
+{
+	const std::string path = key.path();
+	if (!FileExists(path))
+		return nullptr;
+	const FilePtr file { OpenFile(path.c_str(), "rb") };
+	if (file == nullptr)
+		return nullptr;
+
+	uint8_t header[HeaderSize];
+	if (!ReadEntryHeader(file.get(), path, header) || LoadLE32(&header[8]) != key.str().size()) {
+		LogVerbose("Stale converted asset cache entry: {}", path);
+		return nullptr;
+	}
+
+	// Guard against hash collisions by comparing the full key.
+	std::string storedKey(key.str().size(), '\0');
+	if (std::fread(storedKey.data(), storedKey.size(), 1, file.get()) != 1 || storedKey != key.str()) {
+		LogVerbose("Converted asset cache key mismatch: {}", path);
+		return nullptr;
+	}
+
+	size = LoadLE32(&header[12]);
+	numLists = LoadLE16(&header[16]);
+	std::unique_ptr<T[]> data { new T[size] };
+	if (std::fread(data.get(), size, 1, file.get()) != 1) {
+		LogVerbose("Truncated converted asset cache entry: {}", path);
+		return nullptr;
+	}
+	return data;
+}
+
+void StoreEntry(const ConvertedAssetCacheKey &key, const void *data, size_t size, uint16_t numLists)
+{
+	static bool Pruned = false;
+	const std::string &dir = CacheDir();
+	if (!DirectoryExists(dir.c_str())) {
+		RecursivelyCreateDir(dir.c_str());
+	} else if (!Pruned) {
+		PruneCache();
+	}
+	Pruned = true;
+
+	// Write to a temporary file first, so that a crash never leaves a partially written entry behind.
+	const std::string path = key.path();
+	const std::string tmpPath = StrCat(path, ".tmp");
+	{
+		const FilePtr file { OpenFile(tmpPath.c_str(), "wb") };
+		if (file == nullptr) {
+			LogVerbose("Failed to create converted asset cache entry: {}", tmpPath);
+			return;
+		}
+		uint8_t header[HeaderSize];
+		std::memcpy(header, CacheMagic, sizeof(CacheMagic));
+		WriteLE32(&header[4], CacheFormatVersion);
+		WriteLE32(&header[8], static_cast<uint32_t>(key.str().size()));
+		WriteLE32(&header[12], static_cast<uint32_t>(size));
+		WriteLE16(&header[16], numLists);
+		WriteLE16(&header[18], 0);
+		if (std::fwrite(header, sizeof(header), 1, file.get()) != 1
+		    || std::fwrite(key.str().data(), key.str().size(), 1, file.get()) != 1
+		    || std::fwrite(data, size, 1, file.get()) != 1) {
+			LogError("Failed to write converted asset cache entry: {}", tmpPath);
+			return;
+		}
+	}
+	if (FileExists(path))
+		RemoveFile(path.c_str());
+	RenameFile(tmpPath.c_str(), path.c_str());
+}
+
+} // namespace
+
+std::optional<ConvertedAssetCacheKey> ConvertedAssetCacheKey::ForAsset(const AssetRef &ref, std::string_view converter, uint32_t converterVersion, uint64_t paramsHash)
+{
+#ifdef UNPACKED_MPQS
+	return std::nullopt;
+#else
+	if (HeadlessMode || ref.archive == nullptr)
+		return std::nullopt;
+
+	const std::optional<std::string> &archiveKey = ArchiveKey(ref.archive->GetPath());
+	if (!archiveKey)
+		return std::nullopt;
+
+	return ConvertedAssetCacheKey {
+		fmt::format("{}\n{}:{}\n{}\n{}:{}\n{:016x}",
+		    CacheFormatVersion,
+		    converter, converterVersion,
+		    *archiveKey,
+		    ref.filename, ref.size(),
+		    paramsHash)
+	};
+#endif
+}
+
+std::string ConvertedAssetCacheKey::path() const
+{
+	return fmt::format("{}{:016x}.bin", CacheDir(), StableHash64(key_.data(), key_.size()));
+}
+
+std::optional<OwnedClxSpriteListOrSheet> LoadCachedClx(const ConvertedAssetCacheKey &key)
+{
+	size_t size;
+	uint16_t numLists;
+	std::unique_ptr<uint8_t[]> data = LoadEntry<uint8_t>(key, size, numLists);
+	if (data == nullptr)
+		return std::nullopt;
+	return OwnedClxSpriteListOrSheet { std::move(data), numLists };
+}
+
+void StoreCachedClx(const ConvertedAssetCacheKey &key, ClxSpriteListOrSheet clx)
+{
+	const void *data = clx.isSheet() ? clx.sheet().data() : clx.list().data();
+	StoreEntry(key, data, clx.dataSize(), clx.isSheet() ? clx.sheet().numLists() : 0);
+}
+
+std::unique_ptr<std::byte[]> LoadCachedAssetData(const ConvertedAssetCacheKey &key, size_t &size)
+{
+	uint16_t numLists;
+	return LoadEntry<std::byte>(key, size, numLists);
+}
+
+void StoreCachedAssetData(const ConvertedAssetCacheKey &key, const std::byte *data, size_t size)
+{
+	StoreEntry(key, data, size, 0);
+}
+
+} // namespace devilution
@@ -0,0 +1,114 @@
+#pragma once
+/**
+ * @file converted_asset_cache.hpp
+ *
+ * @brief An on-disk cache of assets converted at load time (CEL/CL2/PCX to CLX, re-encoded dungeon CELs).
+ *
+ * Cache entries are stored in the `cache` directory under `paths::PrefPath()`.
+ * The file name of an entry is a hash of its key, and the full key is also stored
+ * in the entry and compared on lookup.
+ *
+ * The key contains:
+ *
+ * 1. The cache format version and the converter name and version.
+ * 2. The path and the size of the MPQ archive that the asset was found in,
+ *    and a checksum of the archive's header, hash table and block table.
+ * 3. The asset file name and its unpacked size.
+ * 4. A hash of the converter parameters (e.g. the frame width).
+ *
+ * Only assets read from an MPQ archive are cached. Loose files (mods, overrides)
+ * may change at any time, so they are always converted.
+ * The cache is disabled in headless mode.
+ *
+ * Before the first entry is stored, entries whose archive has changed since they
+ * were written are removed, so that the cache does not grow across game or mod updates.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "engine/assets.hpp"
+#include "engine/clx_sprite.hpp"
+
+namespace devilution {
+
+/**
+ * @brief Converter versions.
+ *
+ * Bump the corresponding version whenever the output of a converter changes.
+ */
+constexpr uint32_t CelToClxVersion = 1;
+constexpr uint32_t Cl2ToClxVersion = 1;
+constexpr uint32_t PcxToClxVersion = 1;
+constexpr uint32_t ReencodeDungeonCelsVersion = 1;
+
+class ConvertedAssetCacheKey {
+public:
+	/**
+	 * @brief Builds a key for the given asset.
+	 *
+	 * @param ref The source asset.
+	 * @param converter The name of the converter, e.g. "cel2clx".
+	 * @param converterVersion One of the `*Version` constants above.
+	 * @param paramsHash A hash of the conversion parameters.
+	 * @return std::nullopt if the asset cannot be cached.
+	 */
+	static std::optional<ConvertedAssetCacheKey> ForAsset(const AssetRef &ref, std::string_view converter, uint32_t converterVersion, uint64_t paramsHash);
+
+	[[nodiscard]] const std::string &str() const
+	{
+		return key_;
+	}
+
+	/** @brief The path to the cache entry file. */
+	[[nodiscard]] std::string path() const;
+
+private:
+	explicit ConvertedAssetCacheKey(std::string key)
+	    : key_(std::move(key))
+	{
+	}
+
+	std::string key_;
+};
+
+constexpr uint64_t StableHash64Seed = 0xcbf29ce484222325ULL;
+
+/** @brief 64-bit FNV-1a, stable across platforms and builds. */
+inline uint64_t StableHash64(const void *data, size_t size, uint64_t seed = StableHash64Seed)
+{
+	const auto *bytes = static_cast<const uint8_t *>(data);
+	uint64_t hash = seed;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/**
+ * @brief Returns a previously converted CLX list or sheet, or std::nullopt on a cache miss.
+ */
+std::optional<OwnedClxSpriteListOrSheet> LoadCachedClx(const ConvertedAssetCacheKey &key);
+
+/**
+ * @brief Stores a converted CLX list or sheet. Errors are logged and otherwise ignored.
+ */
+void StoreCachedClx(const ConvertedAssetCacheKey &key, ClxSpriteListOrSheet clx);
+
+/**
+ * @brief Returns previously converted raw data, or nullptr on a cache miss.
+ */
+std::unique_ptr<std::byte[]> LoadCachedAssetData(const ConvertedAssetCacheKey &key, size_t &size);
+
+/**
+ * @brief Stores converted raw data. Errors are logged and otherwise ignored.
+ */
+void StoreCachedAssetData(const ConvertedAssetCacheKey &key, const std::byte *data, size_t size);
+
+} // namespace devilution
@@ -6,7 +6,12 @@
 #include "engine/dx.h"
 
 #include <SDL.h>
+
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
+#include <vector>
 
 #include "controls/control_mode.hpp"
 #include "controls/plrctrls.h"
@@ -16,6 +21,7 @@
 #include "options.h"
 #include "utils/display.h"
 #include "utils/log.hpp"
+#include "utils/sdl_geometry.h"
 #include "utils/sdl_wrap.h"
 
 #ifndef USE_SDL1
@@ -84,6 +90,110 @@ void LimitFrameRate()
 	frameDeadline = tc + v + refreshDelay;
 }
 
+/** The back buffer is compared in tiles of this size to find the parts of the screen that changed. */
+constexpr int DamageTileWidth = 64;
+constexpr int DamageTileHeight = 16;
+
+/** Above this many damaged areas, the texture upload is merged into their bounding box. */
+constexpr size_t MaxOutputDamageRects = 32;
+
+/** @brief Copy of the back buffer as it was last copied to the output surface by `BltFastChanged`. */
+struct BlitShadow {
+	std::vector<uint8_t> pixels;
+	std::array<SDL_Color, 256> palette;
+	const SDL_Surface *source = nullptr;
+	const SDL_Surface *output = nullptr;
+	int width = 0;
+	int height = 0;
+	bool valid = false;
+};
+
+BlitShadow Shadow;
+
+/** Areas of the output surface that were written since the last present. */
+std::vector<SDL_Rect> OutputDamage;
+
+/** Whether the texture may not match the output surface outside of `OutputDamage`. */
+bool OutputTextureStale = true;
+
+SDL_Rect IntersectRects(const SDL_Rect &a, const SDL_Rect &b)
+{
+	const int x = std::max(a.x, b.x);
+	const int y = std::max(a.y, b.y);
+	const int w = std::min(a.x + a.w, b.x + b.w) - x;
+	const int h = std::min(a.y + a.h, b.y + b.h) - y;
+	return MakeSdlRect(x, y, std::max(w, 0), std::max(h, 0));
+}
+
+void AddOutputDamage(const SDL_Rect *dstRect, const SDL_Surface *output)
+{
+	const SDL_Rect bounds = MakeSdlRect(0, 0, output->w, output->h);
+	const SDL_Rect rect = dstRect == nullptr ? bounds : IntersectRects(*dstRect, bounds);
+	if (rect.w <= 0 || rect.h <= 0)
+		return;
+	if (OutputDamage.size() < MaxOutputDamageRects) {
+		OutputDamage.push_back(rect);
+		return;
+	}
+	SDL_Rect &merged = OutputDamage.back();
+	const int x = std::min(merged.x, rect.x);
+	const int y = std::min(merged.y, rect.y);
+	merged.w = std::max(merged.x + merged.w, rect.x + rect.w) - x;
+	merged.h = std::max(merged.y + merged.h, rect.y + rect.h) - y;
+	merged.x = x;
+	merged.y = y;
+}
+
+void BlitToOutput(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect);
+
+const std::array<SDL_Color, 256> &GetPalSurfaceColors()
+{
+	return *reinterpret_cast<const std::array<SDL_Color, 256> *>(PalSurface->format->palette->colors);
+}
+
+bool IsShadowValid(const SDL_Surface *output)
+{
+	return Shadow.valid
+	    && Shadow.source == PalSurface && Shadow.output == output
+	    && Shadow.width == gnScreenWidth && Shadow.height == gnScreenHeight
+	    && std::memcmp(Shadow.palette.data(), GetPalSurfaceColors().data(), sizeof(Shadow.palette)) == 0;
+}
+
+/** @brief Blits the whole back buffer and makes the shadow match it. */
+void ResetShadow(SDL_Surface *output)
+{
+	Shadow.width = gnScreenWidth;
+	Shadow.height = gnScreenHeight;
+	Shadow.source = PalSurface;
+	Shadow.output = output;
+	Shadow.palette = GetPalSurfaceColors();
+	Shadow.pixels.resize(static_cast<size_t>(Shadow.width) * Shadow.height);
+	const auto *src = static_cast<const uint8_t *>(PalSurface->pixels);
+	for (int y = 0; y < Shadow.height; ++y) {
+		std::memcpy(&Shadow.pixels[static_cast<size_t>(y) * Shadow.width], src + static_cast<ptrdiff_t>(y) * PalSurface->pitch, Shadow.width);
+	}
+	Shadow.valid = true;
+	BlitToOutput(PalSurface, nullptr, nullptr);
+}
+
+/** @brief Compares one tile with the shadow and updates the shadow if it changed. */
+bool UpdateShadowTile(const SDL_Rect &tile)
+{
+	const auto *src = static_cast<const uint8_t *>(PalSurface->pixels) + static_cast<ptrdiff_t>(tile.y) * PalSurface->pitch + tile.x;
+	uint8_t *shadow = &Shadow.pixels[static_cast<size_t>(tile.y) * Shadow.width + tile.x];
+	int y = 0;
+	for (; y < tile.h; ++y, src += PalSurface->pitch, shadow += Shadow.width) {
+		if (std::memcmp(src, shadow, tile.w) != 0)
+			break;
+	}
+	if (y == tile.h)
+		return false;
+	for (; y < tile.h; ++y, src += PalSurface->pitch, shadow += Shadow.width) {
+		std::memcpy(shadow, src, tile.w);
+	}
+	return true;
+}
+
 } // namespace
 
 void dx_init()
@@ -157,12 +267,85 @@ void BltFast(SDL_Rect *srcRect, SDL_Rect *dstRect)
 	Blit(PalSurface, srcRect, dstRect);
 }
 
+void BltFastChanged(SDL_Rect area)
+{
+	if (RenderDirectlyToOutputSurface || HeadlessMode)
+		return;
+
+	SDL_Surface *output = GetOutputSurface();
+	if (!IsShadowValid(output)) {
+		ResetShadow(output);
+		return;
+	}
+
+	area = IntersectRects(area, MakeSdlRect(0, 0, gnScreenWidth, gnScreenHeight));
+	if (area.w <= 0 || area.h <= 0)
+		return;
+
+	// Changed tiles are merged into horizontal runs, and runs with the same
+	// horizontal extent in consecutive tile rows are merged into one rectangle.
+	std::vector<SDL_Rect> open;
+	std::vector<SDL_Rect> next;
+	const auto flush = [](SDL_Rect &rect) {
+		BlitToOutput(PalSurface, &rect, &rect);
+	};
+	const int firstRow = area.y - area.y % DamageTileHeight;
+	const int firstColumn = area.x - area.x % DamageTileWidth;
+	for (int rowY = firstRow; rowY < area.y + area.h; rowY += DamageTileHeight) {
+		const int y = std::max(rowY, area.y);
+		const int h = std::min(rowY + DamageTileHeight, area.y + area.h) - y;
+		next.clear();
+		for (int columnX = firstColumn; columnX < area.x + area.w; columnX += DamageTileWidth) {
+			const int x = std::max(columnX, area.x);
+			const int w = std::min(columnX + DamageTileWidth, area.x + area.w) - x;
+			if (!UpdateShadowTile(MakeSdlRect(x, y, w, h)))
+				continue;
+			if (!next.empty() && next.back().x + next.back().w == x) {
+				next.back().w += w;
+			} else {
+				next.push_back(MakeSdlRect(x, y, w, h));
+			}
+		}
+		for (SDL_Rect &run : next) {
+			const auto it = std::find_if(open.begin(), open.end(), [&run](const SDL_Rect &rect) {
+				return rect.x == run.x && rect.w == run.w && rect.y + rect.h == run.y;
+			});
+			if (it != open.end()) {
+				run.y = it->y;
+				run.h += it->h;
+				open.erase(it);
+			}
+		}
+		for (SDL_Rect &rect : open)
+			flush(rect);
+		std::swap(open, next);
+	}
+	for (SDL_Rect &rect : open)
+		flush(rect);
+}
+
+void InvalidateOutputTexture()
+{
+	OutputTextureStale = true;
+	Shadow.valid = false;
+}
+
 void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect)
+{
+	// The output surface no longer matches the shadow of the back buffer.
+	Shadow.valid = false;
+	BlitToOutput(src, srcRect, dstRect);
+}
+
+namespace {
+
+void BlitToOutput(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect)
 {
 	if (HeadlessMode)
 		return;
 
 	SDL_Surface *dst = GetOutputSurface();
+	AddOutputDamage(dstRect, dst);
 #ifndef USE_SDL1
 	if (SDL_BlitSurface(src, srcRect, dst, dstRect) < 0)
 		ErrSdl();
@@ -210,7 +393,7 @@ void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect)
 #endif
 }
 
-void RenderPresent()
+void Present(bool onlyChanged)
 {
 	if (HeadlessMode)
 		return;
@@ -224,9 +407,18 @@ void RenderPresent()
 
 #ifndef USE_SDL1
 	if (renderer != nullptr) {
-		if (SDL_UpdateTexture(texture.get(), nullptr, surface->pixels, surface->pitch) <= -1) { // pitch is 2560
+		if (onlyChanged && !OutputTextureStale) {
+			for (const SDL_Rect &rect : OutputDamage) {
+				const auto *pixels = static_cast<const uint8_t *>(surface->pixels) + static_cast<ptrdiff_t>(rect.y) * surface->pitch + rect.x * surface->format->BytesPerPixel;
+				if (SDL_UpdateTexture(texture.get(), &rect, pixels, surface->pitch) <= -1) {
+					ErrSdl();
+				}
+			}
+		} else if (SDL_UpdateTexture(texture.get(), nullptr, surface->pixels, surface->pitch) <= -1) { // pitch is 2560
 			ErrSdl();
 		}
+		OutputTextureStale = false;
+		OutputDamage.clear();
 
 		// Clear buffer to avoid artifacts in case the window was resized
 		if (SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255) <= -1) { // TODO only do this if window was resized
@@ -250,10 +442,20 @@ void RenderPresent()
 	} else {
 		if (ControlMode == ControlTypes::VirtualGamepad) {
 			RenderVirtualGamepad(surface);
+			// The gamepad is drawn over the output surface, so it no longer matches the back buffer.
+			Shadow.valid = false;
+			onlyChanged = false;
 		}
-		if (SDL_UpdateWindowSurface(ghMainWnd) <= -1) {
-			ErrSdl();
+		if (!onlyChanged) {
+			if (SDL_UpdateWindowSurface(ghMainWnd) <= -1) {
+				ErrSdl();
+			}
+		} else if (!OutputDamage.empty()) {
+			if (SDL_UpdateWindowSurfaceRects(ghMainWnd, OutputDamage.data(), static_cast<int>(OutputDamage.size())) <= -1) {
+				ErrSdl();
+			}
 		}
+		OutputDamage.clear();
 		LimitFrameRate();
 	}
 #else
@@ -262,8 +464,21 @@ void RenderPresent()
 	}
 	if (RenderDirectlyToOutputSurface)
 		PalSurface = GetOutputSurface();
+	OutputDamage.clear();
 	LimitFrameRate();
 #endif
 }
 
+} // namespace
+
+void RenderPresent()
+{
+	Present(/*onlyChanged=*/false);
+}
+
+void RenderPresentChanged()
+{
+	Present(/*onlyChanged=*/true);
+}
+
 } // namespace devilution
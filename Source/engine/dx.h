@@ -22,7 +22,23 @@ void dx_init();
 void dx_cleanup();
 void CreateBackBuffer();
 void BltFast(SDL_Rect *srcRect, SDL_Rect *dstRect);
+
+/**
+ * @brief Copies the parts of the back buffer inside `area` that changed since they were last copied this way.
+ *
+ * Falls back to copying the whole back buffer if anything else has written to the output surface
+ * or the palette has changed since.
+ */
+void BltFastChanged(SDL_Rect area);
+
 void Blit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Rect *dstRect);
+
+/** @brief Must be called when the output texture was recreated or the output surface was written without `Blit`. */
+void InvalidateOutputTexture();
+
 void RenderPresent();
 
+/** @brief Same as `RenderPresent`, but only uploads the areas of the output surface that were blitted since the last present. */
+void RenderPresentChanged();
+
 } // namespace devilution
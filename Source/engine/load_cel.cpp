@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 
 #ifdef DEBUG_CEL_TO_CL2_SIZE
@@ -19,6 +20,7 @@
 #ifdef UNPACKED_MPQS
 #include "engine/load_clx.hpp"
 #else
+#include "engine/converted_asset_cache.hpp"
 #include "engine/load_file.hpp"
 #include "utils/cel_to_clx.hpp"
 #endif
@@ -32,12 +34,24 @@ tl::expected<OwnedClxSpriteListOrSheet, std::string> LoadCelListOrSheetWithStatu
 #ifdef UNPACKED_MPQS
 	return LoadClxListOrSheetWithStatus(path);
 #else
+	// Per-frame widths are not part of the cache key, so such sprites are always converted.
+	std::optional<ConvertedAssetCacheKey> cacheKey;
+	if (!widthOrWidths.HoldsPointer()) {
+		cacheKey = ConvertedAssetCacheKey::ForAsset(FindAsset(path), "cel2clx", CelToClxVersion, widthOrWidths.AsValue());
+		if (cacheKey) {
+			std::optional<OwnedClxSpriteListOrSheet> cached = LoadCachedClx(*cacheKey);
+			if (cached) return *std::move(cached);
+		}
+	}
+
 	size_t size;
 	ASSIGN_OR_RETURN(std::unique_ptr<uint8_t[]> data, LoadFileInMemWithStatus<uint8_t>(path, &size));
 #ifdef DEBUG_CEL_TO_CL2_SIZE
 	std::cout << path;
 #endif
-	return CelToClx(data.get(), size, widthOrWidths);
+	OwnedClxSpriteListOrSheet result = CelToClx(data.get(), size, widthOrWidths);
+	if (cacheKey) StoreCachedClx(*cacheKey, result);
+	return result;
 #endif
 }
 
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include <expected.hpp>
@@ -13,6 +14,7 @@
 #ifdef UNPACKED_MPQS
 #include "engine/load_clx.hpp"
 #else
+#include "engine/converted_asset_cache.hpp"
 #include "engine/load_file.hpp"
 #include "utils/cl2_to_clx.hpp"
 #endif
@@ -26,9 +28,21 @@ tl::expected<OwnedClxSpriteListOrSheet, std::string> LoadCl2ListOrSheetWithStatu
 #ifdef UNPACKED_MPQS
 	return LoadClxListOrSheetWithStatus(path);
 #else
+	// Per-frame widths are not part of the cache key, so such sprites are always converted.
+	std::optional<ConvertedAssetCacheKey> cacheKey;
+	if (!widthOrWidths.HoldsPointer()) {
+		cacheKey = ConvertedAssetCacheKey::ForAsset(FindAsset(path), "cl2clx", Cl2ToClxVersion, widthOrWidths.AsValue());
+		if (cacheKey) {
+			std::optional<OwnedClxSpriteListOrSheet> cached = LoadCachedClx(*cacheKey);
+			if (cached) return *std::move(cached);
+		}
+	}
+
 	size_t size;
 	ASSIGN_OR_RETURN(std::unique_ptr<uint8_t[]> data, LoadFileInMemWithStatus<uint8_t>(path, &size));
-	return Cl2ToClx(std::move(data), size, widthOrWidths);
+	OwnedClxSpriteListOrSheet result = Cl2ToClx(std::move(data), size, widthOrWidths);
+	if (cacheKey) StoreCachedClx(*cacheKey, result);
+	return result;
 #endif
 }
 
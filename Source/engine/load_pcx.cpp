@@ -21,6 +21,7 @@
 #include "engine/load_file.hpp"
 #else
 #include "engine/assets.hpp"
+#include "engine/converted_asset_cache.hpp"
 #include "utils/pcx.hpp"
 #include "utils/pcx_to_clx.hpp"
 #endif
@@ -58,8 +59,27 @@ OptionalOwnedClxSpriteList LoadPcxSpriteList(const char *filename, int numFrames
 	}
 	return result;
 #else
-	size_t fileSize;
-	AssetHandle handle = OpenAsset(path, fileSize);
+	AssetRef ref = FindAsset(path);
+	if (!ref.ok()) {
+		if (logError)
+			LogError("Missing file: {}", path);
+		return std::nullopt;
+	}
+
+	// The palette is not stored in the cache, so only sprites loaded without it are cached.
+	std::optional<ConvertedAssetCacheKey> cacheKey;
+	if (outPalette == nullptr) {
+		const uint64_t paramsHash = static_cast<uint32_t>(numFramesOrFrameHeight)
+		    | (transparentColor ? (static_cast<uint64_t>(0x100 | *transparentColor) << 32) : 0);
+		cacheKey = ConvertedAssetCacheKey::ForAsset(ref, "pcx2clx", PcxToClxVersion, paramsHash);
+		if (cacheKey) {
+			std::optional<OwnedClxSpriteListOrSheet> cached = LoadCachedClx(*cacheKey);
+			if (cached && !cached->isSheet()) return (*std::move(cached)).list();
+		}
+	}
+
+	const size_t fileSize = ref.size();
+	AssetHandle handle = OpenAsset(std::move(ref));
 	if (!handle.ok()) {
 		if (logError)
 			LogError("Missing file: {}", path);
@@ -71,6 +91,7 @@ OptionalOwnedClxSpriteList LoadPcxSpriteList(const char *filename, int numFrames
 	OptionalOwnedClxSpriteList result = PcxToClx(handle, fileSize, numFramesOrFrameHeight, transparentColor, outPalette);
 	if (!result)
 		return std::nullopt;
+	if (cacheKey) StoreCachedClx(*cacheKey, ClxSpriteListOrSheet { ClxSpriteList { *result }.data(), 0 });
 	return result;
 #endif
 }
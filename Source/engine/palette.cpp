@@ -51,16 +51,7 @@ void CycleColors(int from, int to)
 {
 	std::rotate(logical_palette.begin() + from, logical_palette.begin() + from + 1, logical_palette.begin() + to + 1);
 	std::rotate(system_palette.begin() + from, system_palette.begin() + from + 1, system_palette.begin() + to + 1);
-
-	for (auto &palette : paletteTransparencyLookup) {
-		std::rotate(std::begin(palette) + from, std::begin(palette) + from + 1, std::begin(palette) + to + 1);
-	}
-
-	std::rotate(&paletteTransparencyLookup[from][0], &paletteTransparencyLookup[from + 1][0], &paletteTransparencyLookup[to + 1][0]);
-
-#if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
-	UpdateTransparencyLookupBlack16(from, to);
-#endif
+	RotateBlendedLookupTable(from, from + 1, to);
 }
 
 /**
@@ -72,16 +63,7 @@ void CycleColorsReverse(int from, int to)
 {
 	std::rotate(logical_palette.begin() + from, logical_palette.begin() + to, logical_palette.begin() + to + 1);
 	std::rotate(system_palette.begin() + from, system_palette.begin() + to, system_palette.begin() + to + 1);
-
-	for (auto &palette : paletteTransparencyLookup) {
-		std::rotate(std::begin(palette) + from, std::begin(palette) + to, std::begin(palette) + to + 1);
-	}
-
-	std::rotate(&paletteTransparencyLookup[from][0], &paletteTransparencyLookup[to][0], &paletteTransparencyLookup[to + 1][0]);
-
-#if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
-	UpdateTransparencyLookupBlack16(from, to);
-#endif
+	RotateBlendedLookupTable(from, to, to);
 }
 
 // When brightness==0, then a==0 (identity mapping)
@@ -10,8 +10,12 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <queue>
 #include <utility>
+#include <vector>
 
 #include <function_ref.hpp>
 
@@ -19,7 +23,6 @@
 #include "crawl.hpp"
 #include "engine/displacement.hpp"
 #include "engine/point.hpp"
-#include "utils/algorithm/container.hpp"
 #include "utils/static_vector.hpp"
 
 namespace devilution {
@@ -57,64 +60,102 @@ struct ExploredNode {
 	CostType g;
 };
 
-// A simple map with a fixed number of buckets and static storage.
+/**
+ * @brief The explored nodes of a search, stored in a flat array indexed by position.
+ *
+ * Each entry is stamped with the generation of the search that wrote it, so starting
+ * a new search does not require clearing the array.
+ *
+ * The number of nodes per 8x8 "bucket" (positions with the same low 3 bits of x and y)
+ * is limited to the same capacity as the bucketed hash map that this replaced,
+ * so that searches explore exactly the same nodes and return the same paths.
+ */
 class ExploredNodes {
 	static const size_t NumBuckets = 64;
 	static const size_t BucketCapacity = 3 * MaxPathNodes / NumBuckets;
-	using Entry = std::pair<uint16_t, ExploredNode>;
-	using Bucket = StaticVector<Entry, BucketCapacity>;
+	static const size_t NumNodes = 1 << (2 * 8 * sizeof(CoordType));
 
-public:
-	using value_type = Entry;
-	using iterator = value_type *;
-	using const_iterator = const value_type *;
+	struct Entry {
+		ExploredNode node;
+		uint16_t generation;
+	};
 
-	[[nodiscard]] const_iterator find(const PointT &point) const
+public:
+	ExploredNodes()
+	    : entries_(std::make_unique<Entry[]>(NumNodes))
 	{
-		const Bucket &b = bucket(point);
-		const auto *const it = c_find_if(b, [r = repr(point)](const Entry &e) { return e.first == r; });
-		if (it == b.end()) return nullptr;
-		return it;
 	}
-	[[nodiscard]] iterator find(const PointT &point)
+
+	/**
+	 * @brief Forgets all the nodes of the previous search.
+	 */
+	void reset()
 	{
-		Bucket &b = bucket(point);
-		auto *it = c_find_if(b, [r = repr(point)](const Entry &e) { return e.first == r; });
-		if (it == b.end()) return nullptr;
-		return it;
+		if (++generation_ == 0) {
+			std::fill_n(entries_.get(), NumNodes, Entry {});
+			generation_ = 1;
+		}
+		bucketSizes_.fill(0);
 	}
 
-	// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
-	[[nodiscard]] const_iterator end() const { return nullptr; }
-	// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
-	[[nodiscard]] iterator end() { return nullptr; }
+	[[nodiscard]] const ExploredNode *find(const PointT &point) const
+	{
+		const Entry &entry = entries_[index(point)];
+		return entry.generation == generation_ ? &entry.node : nullptr;
+	}
+	[[nodiscard]] ExploredNode *find(const PointT &point)
+	{
+		Entry &entry = entries_[index(point)];
+		return entry.generation == generation_ ? &entry.node : nullptr;
+	}
 
 	void emplace(const PointT &point, const ExploredNode &exploredNode)
 	{
-		bucket(point).emplace_back(repr(point), exploredNode);
+		entries_[index(point)] = Entry { exploredNode, generation_ };
+		++bucketSizes_[bucketIndex(point)];
 	}
 
 	[[nodiscard]] bool canInsert(const PointT &point) const
 	{
-		return bucket(point).size() < BucketCapacity;
+		return bucketSizes_[bucketIndex(point)] < BucketCapacity;
 	}
 
 private:
-	[[nodiscard]] const Bucket &bucket(const PointT &point) const { return buckets_[bucketIndex(point)]; }
-	[[nodiscard]] Bucket &bucket(const PointT &point) { return buckets_[bucketIndex(point)]; }
 	[[nodiscard]] static size_t bucketIndex(const PointT &point)
 	{
 		return ((point.x & 0b111) << 3) | (point.y & 0b111);
 	}
 
-	[[nodiscard]] static uint16_t repr(const PointT &point)
+	[[nodiscard]] static size_t index(const PointT &point)
 	{
 		return (point.x << 8) | point.y;
 	}
 
-	std::array<Bucket, NumBuckets> buckets_;
+	std::unique_ptr<Entry[]> entries_;
+	std::array<uint8_t, NumBuckets> bucketSizes_ = {};
+	uint16_t generation_ = 0;
 };
 
+/**
+ * @brief State that is reused between searches to avoid setting it up on every call.
+ */
+struct PathSearchContext {
+	ExploredNodes explored;
+	StaticVector<FrontierNode, MaxPathNodes> frontier;
+
+	void reset()
+	{
+		explored.reset();
+		frontier.clear();
+	}
+};
+
+PathSearchContext &GetPathSearchContext()
+{
+	static PathSearchContext context;
+	return context;
+}
+
 bool IsDiagonalStep(const Point &a, const Point &b)
 {
 	return a.x != b.x && a.y != b.y;
@@ -157,16 +198,16 @@ int ReconstructPath(const ExploredNodes &explored, PointT dest, int8_t *path, si
 	size_t len = 0;
 	PointT cur = dest;
 	while (true) {
-		const auto *const it = explored.find(cur);
-		if (it == explored.end()) app_fatal("Failed to reconstruct path");
-		if (it->second.g == 0) break; // reached start
+		const ExploredNode *const node = explored.find(cur);
+		if (node == nullptr) app_fatal("Failed to reconstruct path");
+		if (node->g == 0) break; // reached start
 		if (len == maxPathLength) {
 			// Path too long.
 			len = 0;
 			break;
 		}
-		path[len++] = GetPathDirection(it->second.prev, cur);
-		cur = it->second.prev;
+		path[len++] = GetPathDirection(node->prev, cur);
+		cur = node->prev;
 	}
 	std::reverse(path, path + len);
 	std::fill(path + len, path + maxPathLength, -1);
@@ -192,8 +233,10 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 		return 0;
 	}
 
-	StaticVector<FrontierNode, MaxPathNodes> frontier;
-	ExploredNodes explored;
+	PathSearchContext &context = GetPathSearchContext();
+	context.reset();
+	ExploredNodes &explored = context.explored;
+	StaticVector<FrontierNode, MaxPathNodes> &frontier = context.frontier;
 	{
 		frontier.emplace_back(FrontierNode { .position = start, .f = initialHeuristicCost });
 		explored.emplace(start, ExploredNode { .prev = {}, .g = 0 });
@@ -211,8 +254,8 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 		if (hA != hB) return hA > hB;
 
 		// Prefer diagonal steps first.
-		const ExploredNode &aInfo = explored.find(a.position)->second;
-		const ExploredNode &bInfo = explored.find(b.position)->second;
+		const ExploredNode &aInfo = *explored.find(a.position);
+		const ExploredNode &bInfo = *explored.find(b.position);
 		const bool isDiagonalA = IsDiagonalStep(aInfo.prev, a.position);
 		const bool isDiagonalB = IsDiagonalStep(bInfo.prev, b.position);
 		if (isDiagonalA != isDiagonalB) return isDiagonalB;
@@ -231,7 +274,7 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 
 		std::pop_heap(frontier.begin(), frontier.end(), frontierComparator);
 		frontier.pop_back();
-		const CostType curG = explored.find(cur.position)->second.g;
+		const CostType curG = explored.find(cur.position)->g;
 
 		// Discard invalid nodes.
 
@@ -257,14 +300,14 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 			const CostType g = curG + GetDistance(cur.position, neighborPos);
 			if (curG >= PathDiagonalStepCost * maxPathLength) continue;
 			bool improved = false;
-			if (auto *it = explored.find(neighborPos); it == explored.end()) {
+			if (ExploredNode *node = explored.find(neighborPos); node == nullptr) {
 				if (explored.canInsert(neighborPos)) {
 					explored.emplace(neighborPos, ExploredNode { .prev = cur.position, .g = g });
 					improved = true;
 				}
-			} else if (it->second.g > g) {
-				it->second.prev = cur.position;
-				it->second.g = g;
+			} else if (node->g > g) {
+				node->prev = cur.position;
+				node->g = g;
 				improved = true;
 			}
 			if (improved) {
@@ -282,6 +325,65 @@ int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool
 	return 0; // no path
 }
 
+void PathDistanceField::build(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point destinationPosition, size_t maxPathLength)
+{
+	destination_ = destinationPosition;
+	radius_ = static_cast<int>(maxPathLength);
+	const size_t width = 2 * maxPathLength + 1;
+	distances_.assign(width * width, std::numeric_limits<uint16_t>::max());
+
+	const int maxCost = PathDiagonalStepCost * radius_;
+	using QueueEntry = std::pair<uint16_t, Point>;
+	const auto compare = [](const QueueEntry &a, const QueueEntry &b) { return a.first > b.first; };
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, decltype(compare)> queue(compare);
+
+	distances_[*index(destinationPosition)] = 0;
+	queue.emplace(0, destinationPosition);
+	while (!queue.empty()) {
+		const auto [cost, position] = queue.top();
+		queue.pop();
+		if (cost > distances_[*index(position)] || cost >= maxCost) continue;
+
+		// Walk backwards: find the neighbors that can step onto `position`.
+		for (const Displacement d : PathDirs) {
+			const Point neighbor = position + d;
+			const std::optional<size_t> neighborIndex = index(neighbor);
+			if (!neighborIndex || neighbor.x < 0 || neighbor.y < 0) continue;
+			const auto neighborCost = static_cast<uint16_t>(cost + (IsDiagonalStep(neighbor, position) ? PathDiagonalStepCost : PathAxisAlignedStepCost));
+			if (neighborCost >= distances_[*neighborIndex]) continue;
+			if (!posOk(neighbor) || !canStep(neighbor, position)) continue;
+			distances_[*neighborIndex] = neighborCost;
+			queue.emplace(neighborCost, neighbor);
+		}
+	}
+}
+
+int8_t PathDistanceField::getFirstStep(tl::function_ref<bool(Point, Point)> canStep, Point startPosition) const
+{
+	if (startPosition == destination_) return -1;
+
+	int bestCost = std::numeric_limits<int>::max();
+	int8_t bestStep = -1;
+	for (const Displacement d : PathDirs) {
+		const Point neighbor = startPosition + d;
+		const std::optional<size_t> neighborIndex = index(neighbor);
+		if (!neighborIndex || distances_[*neighborIndex] == std::numeric_limits<uint16_t>::max()) continue;
+		const int cost = distances_[*neighborIndex] + (IsDiagonalStep(startPosition, neighbor) ? PathDiagonalStepCost : PathAxisAlignedStepCost);
+		if (cost >= bestCost || !canStep(startPosition, neighbor)) continue;
+		bestCost = cost;
+		bestStep = GetPathDirection(startPosition, neighbor);
+	}
+	return bestStep;
+}
+
+std::optional<size_t> PathDistanceField::index(Point position) const
+{
+	const Displacement offset = position - destination_;
+	if (std::abs(offset.deltaX) > radius_ || std::abs(offset.deltaY) > radius_) return std::nullopt;
+	const int width = 2 * radius_ + 1;
+	return static_cast<size_t>((offset.deltaY + radius_) * width + offset.deltaX + radius_);
+}
+
 std::optional<Point> FindClosestValidPosition(tl::function_ref<bool(Point)> posOk, Point startingPosition, unsigned int minimumRadius, unsigned int maximumRadius)
 {
 	return Crawl(minimumRadius, maximumRadius, [&](Displacement displacement) -> std::optional<Point> {
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 #include <function_ref.hpp>
 
@@ -38,6 +39,48 @@ extern const int PathDiagonalStepCost;
  */
 int FindPath(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point startPosition, Point destinationPosition, int8_t *path, size_t maxPathLength);
 
+/**
+ * @brief Walking distances from all positions within a maximum path length to a single destination.
+ *
+ * The distances are computed with one reverse search from the destination, so that any number of walkers
+ * heading to the same destination can look up their next step instead of each running `FindPath`.
+ *
+ * Equally short paths are not broken the same way as in `FindPath`, so the chosen steps can differ from it.
+ */
+class PathDistanceField {
+public:
+	/**
+	 * @brief Computes the distances to `destinationPosition`.
+	 *
+	 * @param canStep specifies whether a step between two adjacent points is allowed.
+	 * @param posOk specifies whether a position can be stepped on. The destination itself is always allowed.
+	 * @param destinationPosition
+	 * @param maxPathLength Positions that are more than this many steps away are considered unreachable.
+	 */
+	void build(tl::function_ref<bool(Point, Point)> canStep, tl::function_ref<bool(Point)> posOk, Point destinationPosition, size_t maxPathLength);
+
+	[[nodiscard]] Point destination() const
+	{
+		return destination_;
+	}
+
+	/**
+	 * @brief Returns the first step of a shortest path from `startPosition` to the destination.
+	 *
+	 * @param canStep Must be the same as the one the field was built with.
+	 * @param startPosition
+	 * @return The step direction (see `GetPathDirection`), or -1 if the destination can't be reached.
+	 */
+	[[nodiscard]] int8_t getFirstStep(tl::function_ref<bool(Point, Point)> canStep, Point startPosition) const;
+
+private:
+	[[nodiscard]] std::optional<size_t> index(Point position) const;
+
+	Point destination_;
+	int radius_ = 0;
+	std::vector<uint16_t> distances_;
+};
+
 /** For iterating over the 8 possible movement directions */
 const Displacement PathDirs[8] = {
 	// clang-format off
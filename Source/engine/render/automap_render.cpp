@@ -55,6 +55,9 @@ void DrawMapLineSteep(const Surface &out, Point from, int width, std::uint8_t co
 	SetMapPixel(out, from, colorIndex);
 }
 
+/** @brief Set while drawing into the cached automap layer, see `SetAutomapLayerMask`. */
+uint8_t *AutomapLayerMask = nullptr;
+
 } // namespace
 
 void DrawMapLineNS(const Surface &out, Point from, int height, std::uint8_t colorIndex)
@@ -165,6 +168,14 @@ void DrawMapFreeLine(const Surface &out, Point from, Point to, uint8_t colorInde
 
 void SetMapPixel(const Surface &out, Point position, uint8_t color)
 {
+	if (AutomapLayerMask != nullptr) {
+		if (!out.InBounds(position))
+			return;
+		out[position] = color;
+		AutomapLayerMask[(position.y * out.pitch()) + position.x] = 1;
+		return;
+	}
+
 	if (GetAutomapType() == AutomapType::Minimap && !MinimapRect.contains(position))
 		return;
 
@@ -175,4 +186,9 @@ void SetMapPixel(const Surface &out, Point position, uint8_t color)
 	}
 }
 
+void SetAutomapLayerMask(uint8_t *mask)
+{
+	AutomapLayerMask = mask;
+}
+
 } // namespace devilution
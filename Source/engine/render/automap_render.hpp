@@ -99,4 +99,12 @@ void DrawMapFreeLine(const Surface &out, Point from, Point to, uint8_t colorInde
  */
 void SetMapPixel(const Surface &out, Point position, uint8_t color);
 
+/**
+ * @brief Makes `SetMapPixel` draw into an offscreen automap layer, or back to the screen if `mask` is `nullptr`.
+ *
+ * While set, pixels are always opaque and not clipped to the minimap, and every drawn pixel is set to 1 in `mask`,
+ * which must have the same size and pitch as the layer.
+ */
+void SetAutomapLayerMask(uint8_t *mask);
+
 } // namespace devilution
@@ -78,6 +78,10 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitPixelsWithLightmap(uint8_t *DVL_RES
 {
 	DVL_ASSUME(length != 0);
 	const uint8_t *light = lightmap.getLightingAt(dst);
+	if (ActiveLightingKernel != LightingKernel::Scalar && length >= MinLightingKernelLength) {
+		LookupPixels2D(dst, light, src, length, lightmap.lightTablesData(), NumLightingLevels);
+		return;
+	}
 	std::transform(DEVILUTIONX_BLIT_EXECUTION_POLICY src, src + length, light, dst, [&lightmap](uint8_t srcColor, uint8_t lightLevel) {
 		return lightmap.adjustColor(srcColor, lightLevel);
 	});
@@ -161,6 +165,11 @@ DVL_ALWAYS_INLINE DVL_ATTRIBUTE_HOT void BlitPixelsBlendedWithLightmap(uint8_t *
 
 	if (length < 1024) {
 		uint8_t litSrc[1024];
+		if (ActiveLightingKernel != LightingKernel::Scalar && length >= MinLightingKernelLength) {
+			LookupPixels2D(litSrc, light, src, length, lightmap.lightTablesData(), NumLightingLevels);
+			LookupPixels2D(dst, dst, litSrc, length, &paletteTransparencyLookup[0][0], 256);
+			return;
+		}
 		std::transform(DEVILUTIONX_BLIT_EXECUTION_POLICY src, src + length, light, litSrc, [&lightmap](uint8_t srcColor, uint8_t lightLevel) {
 			return lightmap.adjustColor(srcColor, lightLevel);
 		});
@@ -241,6 +241,7 @@ using OutlineRowSolidRuns = StaticVector<std::pair<uint8_t, uint8_t>, MaxOutline
 struct OutlinePixelsCacheEntry {
 	OutlinePixels outlinePixels;
 	const void *spriteData = nullptr;
+	const uint8_t *trn = nullptr;
 	bool skipColorIndexZero;
 };
 OutlinePixelsCacheEntry OutlinePixelsCache;
@@ -284,8 +285,13 @@ void AppendOutlineRowSolidRuns(uint8_t x, uint8_t w, OutlineRowSolidRuns &solidR
 	}
 }
 
+bool IsColorZero(uint8_t color, const uint8_t *trn)
+{
+	return (trn != nullptr ? trn[color] : color) == 0;
+}
+
 template <bool SkipColorIndexZero>
-void GetOutline(ClxSprite sprite, OutlinePixels &result) // NOLINT(readability-function-cognitive-complexity)
+void GetOutline(ClxSprite sprite, const uint8_t *trn, OutlinePixels &result) // NOLINT(readability-function-cognitive-complexity)
 {
 	const unsigned width = sprite.width();
 	assert(width < MaxOutlineSpriteWidth);
@@ -313,7 +319,7 @@ void GetOutline(ClxSprite sprite, OutlinePixels &result) // NOLINT(readability-f
 					if (IsClxOpaqueFill(v)) {
 						w = GetClxOpaqueFillWidth(v);
 						const auto color = static_cast<uint8_t>(*src++);
-						if (color != 0) {
+						if (!IsColorZero(color, trn)) {
 							AppendOutlineRowSolidRuns(x, w, *solidRunAbove);
 						}
 					} else {
@@ -321,7 +327,7 @@ void GetOutline(ClxSprite sprite, OutlinePixels &result) // NOLINT(readability-f
 						bool prevZero = solidRunAbove->empty() || solidRunAbove->back().second != x;
 						for (unsigned i = 0; i < w; ++i) {
 							const auto color = static_cast<uint8_t>(src[i]);
-							if (color == 0) {
+							if (IsColorZero(color, trn)) {
 								if (!prevZero) ++solidRunAbove->back().second;
 								prevZero = true;
 							} else {
@@ -389,22 +395,24 @@ void GetOutline(ClxSprite sprite, OutlinePixels &result) // NOLINT(readability-f
 }
 
 template <bool SkipColorIndexZero>
-void UpdateOutlinePixelsCache(ClxSprite sprite)
+void UpdateOutlinePixelsCache(ClxSprite sprite, const uint8_t *trn)
 {
 	if (OutlinePixelsCache.spriteData == sprite.pixelData()
+	    && OutlinePixelsCache.trn == trn
 	    && OutlinePixelsCache.skipColorIndexZero == SkipColorIndexZero) {
 		return;
 	}
 	OutlinePixelsCache.skipColorIndexZero = SkipColorIndexZero;
 	OutlinePixelsCache.spriteData = sprite.pixelData();
+	OutlinePixelsCache.trn = trn;
 	OutlinePixelsCache.outlinePixels.clear();
-	GetOutline<SkipColorIndexZero>(sprite, OutlinePixelsCache.outlinePixels);
+	GetOutline<SkipColorIndexZero>(sprite, trn, OutlinePixelsCache.outlinePixels);
 }
 
 template <bool SkipColorIndexZero>
-void RenderClxOutline(const Surface &out, Point position, ClxSprite sprite, uint8_t color)
+void RenderClxOutline(const Surface &out, Point position, ClxSprite sprite, uint8_t color, const uint8_t *trn = nullptr)
 {
-	UpdateOutlinePixelsCache<SkipColorIndexZero>(sprite);
+	UpdateOutlinePixelsCache<SkipColorIndexZero>(sprite, trn);
 	--position.x;
 	position.y -= sprite.height();
 	if (position.x >= 0 && position.x + sprite.width() + 2 < out.w()
@@ -460,7 +468,7 @@ void ClxApplyTrans(ClxSpriteSheet sheet, const uint8_t *trn)
 	}
 }
 
-bool IsPointWithinClx(Point position, ClxSprite clx)
+bool IsPointWithinClx(Point position, ClxSprite clx, const uint8_t *trn)
 {
 	const uint8_t *src = clx.pixelData();
 	const uint8_t *end = src + clx.pixelDataSize();
@@ -494,14 +502,14 @@ bool IsPointWithinClx(Point position, ClxSprite clx)
 				val = GetClxOpaqueFillWidth(val);
 				const uint8_t color = *src++;
 				if (xCur <= position.x && position.x < xCur + val)
-					return color != 0; // ignore shadows
+					return (trn != nullptr ? trn[color] : color) != 0; // ignore shadows
 				xCur += val;
 			} else {
 				val = GetClxOpaquePixelsWidth(val);
 				for (uint8_t pixel = 0; pixel < val; pixel++) {
 					const uint8_t color = *src++;
 					if (xCur == position.x)
-						return color != 0; // ignore shadows
+						return (trn != nullptr ? trn[color] : color) != 0; // ignore shadows
 					xCur++;
 				}
 			}
@@ -613,9 +621,9 @@ void ClxDrawOutline(const Surface &out, uint8_t col, Point position, ClxSprite c
 	RenderClxOutline</*SkipColorIndexZero=*/false>(out, position, clx, col);
 }
 
-void ClxDrawOutlineSkipColorZero(const Surface &out, uint8_t col, Point position, ClxSprite clx)
+void ClxDrawOutlineSkipColorZero(const Surface &out, uint8_t col, Point position, ClxSprite clx, const uint8_t *trn)
 {
-	RenderClxOutline</*SkipColorIndexZero=*/true>(out, position, clx, col);
+	RenderClxOutline</*SkipColorIndexZero=*/true>(out, position, clx, col, trn);
 }
 
 void ClearClxDrawCache()
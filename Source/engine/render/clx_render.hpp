@@ -58,8 +58,9 @@ void ClxDrawOutline(const Surface &out, uint8_t col, Point position, ClxSprite c
  * @param out Output buffer
  * @param position Target buffer coordinate
  * @param clx CLX frame
+ * @param trn TRN that the sprite is drawn with, if any. Colors that it maps to 0 are also transparent.
  */
-void ClxDrawOutlineSkipColorZero(const Surface &out, uint8_t col, Point position, ClxSprite clx);
+void ClxDrawOutlineSkipColorZero(const Surface &out, uint8_t col, Point position, ClxSprite clx, const uint8_t *trn = nullptr);
 
 /**
  * @brief Blit CL2 sprite, and apply given TRN to the given buffer at the given coordinates
@@ -108,8 +109,10 @@ void ClxDrawBlendedWithLightmap(const Surface &out, Point position, ClxSprite cl
 
 /**
  * Returns if cursor is within the CLX sprite (ignores shadow)
+ *
+ * @param trn TRN that the sprite is drawn with, if any. Colors that it maps to 0 are also ignored.
  */
-bool IsPointWithinClx(Point position, ClxSprite clx);
+bool IsPointWithinClx(Point position, ClxSprite clx, const uint8_t *trn = nullptr);
 
 /**
  * Returns a pair of X coordinates containing the start (inclusive) and end (exclusive)
@@ -8,6 +8,11 @@
 #include <span>
 #include <vector>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DEVILUTIONX_LIGHTING_KERNEL_AVX2
+#include <immintrin.h>
+#endif
+
 #include "engine/displacement.hpp"
 #include "engine/lighting_defs.hpp"
 #include "engine/point.hpp"
@@ -487,8 +492,83 @@ void BuildLightmap(Point tilePosition, Point targetBufferPosition, uint16_t view
 	}
 }
 
+void LookupPixels2DScalar(uint8_t *dst, const uint8_t *rows, const uint8_t *columns, unsigned length, const uint8_t *table)
+{
+	for (unsigned i = 0; i < length; i++) {
+		dst[i] = table[rows[i] * 256 + columns[i]];
+	}
+}
+
+#ifdef DEVILUTIONX_LIGHTING_KERNEL_AVX2
+__attribute__((target("avx2"))) void LookupPixels2DAvx2(uint8_t *dst, const uint8_t *rows, const uint8_t *columns, unsigned length, const uint8_t *table, unsigned numRows)
+{
+	// The gather loads 4 bytes per lane, so indices near the end of the table are
+	// moved back to stay in bounds and the wanted byte is shifted down instead.
+	const __m256i maxIndex = _mm256_set1_epi32(static_cast<int>(numRows * 256 - 4));
+	const __m256i byteMask = _mm256_set1_epi32(0xFF);
+	const auto *base = reinterpret_cast<const int *>(table);
+	unsigned i = 0;
+	for (; i + 8 <= length; i += 8) {
+		const __m256i row = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows + i)));
+		const __m256i column = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(columns + i)));
+		const __m256i index = _mm256_or_si256(_mm256_slli_epi32(row, 8), column);
+		const __m256i clamped = _mm256_min_epi32(index, maxIndex);
+		const __m256i shift = _mm256_slli_epi32(_mm256_sub_epi32(index, clamped), 3);
+		__m256i values = _mm256_i32gather_epi32(base, clamped, 1);
+		values = _mm256_and_si256(_mm256_srlv_epi32(values, shift), byteMask);
+		__m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+		packed = _mm_packus_epi16(packed, packed);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), packed);
+	}
+	LookupPixels2DScalar(dst + i, rows + i, columns + i, length - i, table);
+}
+#endif
+
+LightingKernel DetectLightingKernel()
+{
+#ifdef DEVILUTIONX_LIGHTING_KERNEL_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return LightingKernel::Avx2;
+#endif
+	return LightingKernel::Scalar;
+}
+
 } // namespace
 
+LightingKernel ActiveLightingKernel = DetectLightingKernel();
+
+bool IsLightingKernelSupported(LightingKernel kernel)
+{
+	switch (kernel) {
+	case LightingKernel::Scalar:
+		return true;
+	case LightingKernel::Avx2:
+		return DetectLightingKernel() == LightingKernel::Avx2;
+	}
+	return false;
+}
+
+void SetLightingKernel(LightingKernel kernel)
+{
+	if (IsLightingKernelSupported(kernel))
+		ActiveLightingKernel = kernel;
+}
+
+void LookupPixels2D(uint8_t *dst, const uint8_t *rows, const uint8_t *columns, unsigned length, const uint8_t *table, [[maybe_unused]] unsigned numRows)
+{
+	switch (ActiveLightingKernel) {
+#ifdef DEVILUTIONX_LIGHTING_KERNEL_AVX2
+	case LightingKernel::Avx2:
+		LookupPixels2DAvx2(dst, rows, columns, length, table, numRows);
+		return;
+#endif
+	default:
+		LookupPixels2DScalar(dst, rows, columns, length, table);
+		return;
+	}
+}
+
 Lightmap::Lightmap(const uint8_t *outBuffer, uint16_t outPitch,
     std::span<const uint8_t> lightmapBuffer, uint16_t lightmapPitch,
     std::span<const std::array<uint8_t, LightTableSize>, NumLightingLevels> lightTables,
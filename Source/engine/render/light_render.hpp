@@ -8,9 +8,40 @@
 #include "engine/lighting_defs.hpp"
 #include "engine/point.hpp"
 #include "levels/gendung_defs.hpp"
+#include "utils/attributes.h"
 
 namespace devilution {
 
+/**
+ * @brief Implementations of the per-pixel table lookups used for lighting and blending.
+ *
+ * Every kernel produces exactly the same output as `Scalar`.
+ */
+enum class LightingKernel : uint8_t {
+	Scalar,
+	Avx2,
+};
+
+/** @brief Lines shorter than this are always handled by the inline scalar loop. */
+constexpr unsigned MinLightingKernelLength = 16;
+
+/** @brief The kernel used by `LookupPixels2D`, the fastest one supported by the CPU by default. */
+extern DVL_API_FOR_TEST LightingKernel ActiveLightingKernel;
+
+[[nodiscard]] bool IsLightingKernelSupported(LightingKernel kernel);
+
+/** @brief Selects the lookup kernel. Does nothing if the CPU does not support it. */
+void SetLightingKernel(LightingKernel kernel);
+
+/**
+ * @brief Computes `dst[i] = table[rows[i] * 256 + columns[i]]` with the active kernel.
+ *
+ * `dst` may be the same buffer as `rows` or `columns`.
+ *
+ * @param numRows Number of 256-byte rows in `table`.
+ */
+void LookupPixels2D(uint8_t *dst, const uint8_t *rows, const uint8_t *columns, unsigned length, const uint8_t *table, unsigned numRows);
+
 class Lightmap {
 public:
 	explicit Lightmap(const uint8_t *outBuffer, std::span<const uint8_t> lightmapBuffer, uint16_t pitch,
@@ -30,6 +61,12 @@ public:
 		return lightTables[lightLevel][color];
 	}
 
+	/** @brief The light tables as one contiguous `NumLightingLevels` x `LightTableSize` block. */
+	[[nodiscard]] const uint8_t *lightTablesData() const
+	{
+		return lightTables[0].data();
+	}
+
 	const uint8_t *getLightingAt(const uint8_t *outLoc) const
 	{
 		const ptrdiff_t outDist = outLoc - outBuffer;
@@ -34,6 +34,7 @@ void DrawHalfTransparentAligned32BlendedRectTo(const Surface &out, unsigned sx,
 	auto *pix = reinterpret_cast<uint32_t *>(out.at(static_cast<int>(sx), static_cast<int>(sy)));
 	assert(reinterpret_cast<intptr_t>(pix) % 4 == 0);
 
+	RefreshTransparencyLookupBlack16();
 	const uint16_t *lookupTable = paletteTransparencyLookupBlack16;
 
 	const unsigned skipX = (out.pitch() - width) / 4;
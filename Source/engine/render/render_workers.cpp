@@ -0,0 +1,166 @@
+#include "engine/render/render_workers.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <SDL.h>
+
+#include "utils/sdl_mutex.h"
+#include "utils/sdl_thread.h"
+
+namespace devilution {
+
+namespace {
+
+/** Bands shorter than this are not worth the synchronization cost. */
+constexpr int MinBandHeight = 256;
+
+constexpr size_t MaxRenderWorkers = 3;
+
+struct SdlCondDeleter {
+	void operator()(SDL_cond *cond) const { SDL_DestroyCond(cond); }
+};
+
+using SdlCondUniquePtr = std::unique_ptr<SDL_cond, SdlCondDeleter>;
+
+class RenderWorkers {
+public:
+	void start(size_t numWorkers)
+	{
+		workAvailable_.reset(SDL_CreateCond());
+		workDone_.reset(SDL_CreateCond());
+		if (workAvailable_ == nullptr || workDone_ == nullptr)
+			ErrSdl();
+		threads_.reserve(numWorkers);
+		for (size_t i = 0; i < numWorkers; ++i)
+			threads_.emplace_back(WorkerMain, this);
+	}
+
+	void stop()
+	{
+		{
+			const std::lock_guard<SdlMutex> lock(mutex_);
+			stopping_ = true;
+			SDL_CondBroadcast(workAvailable_.get());
+		}
+		for (SdlThread &thread : threads_)
+			thread.join();
+		threads_.clear();
+		stopping_ = false;
+	}
+
+	[[nodiscard]] size_t numWorkers() const { return threads_.size(); }
+
+	void run(size_t count, tl::function_ref<void(size_t)> fn)
+	{
+		const std::lock_guard<SdlMutex> lock(mutex_);
+		job_ = &fn;
+		jobCount_ = count;
+		nextBand_ = 0;
+		pendingBands_ = count;
+		SDL_CondBroadcast(workAvailable_.get());
+
+		while (nextBand_ < jobCount_) {
+			runNextBand();
+		}
+		while (pendingBands_ != 0) {
+			SDL_CondWait(workDone_.get(), mutex_.get());
+		}
+		job_ = nullptr;
+		jobCount_ = 0;
+		nextBand_ = 0;
+	}
+
+private:
+	static int SDLCALL WorkerMain(void *data)
+	{
+		auto &workers = *static_cast<RenderWorkers *>(data);
+		const std::lock_guard<SdlMutex> lock(workers.mutex_);
+		while (true) {
+			while (!workers.stopping_ && workers.nextBand_ >= workers.jobCount_) {
+				SDL_CondWait(workers.workAvailable_.get(), workers.mutex_.get());
+			}
+			if (workers.stopping_)
+				return 0;
+			workers.runNextBand();
+		}
+	}
+
+	/** Must be called with `mutex_` held. Releases it while the band is being rendered. */
+	void runNextBand()
+	{
+		const size_t band = nextBand_++;
+		const tl::function_ref<void(size_t)> &job = *job_;
+		mutex_.unlock();
+		job(band);
+		mutex_.lock();
+		if (--pendingBands_ == 0)
+			SDL_CondBroadcast(workDone_.get());
+	}
+
+	SdlMutex mutex_;
+	SdlCondUniquePtr workAvailable_;
+	SdlCondUniquePtr workDone_;
+	std::vector<SdlThread> threads_;
+
+	const tl::function_ref<void(size_t)> *job_ = nullptr;
+	size_t jobCount_ = 0;
+	size_t nextBand_ = 0;
+	size_t pendingBands_ = 0;
+	bool stopping_ = false;
+};
+
+std::unique_ptr<RenderWorkers> Workers;
+
+RenderWorkers *GetRenderWorkers()
+{
+#if defined(USE_SDL1) || defined(DUN_RENDER_STATS)
+	// SDL 1 cannot report the number of CPUs and the render stats are not thread-safe.
+	return nullptr;
+#else
+	static const size_t NumWorkers = std::min<size_t>(std::max(SDL_GetCPUCount() - 1, 0), MaxRenderWorkers);
+	if (NumWorkers == 0)
+		return nullptr;
+	if (Workers == nullptr) {
+		Workers = std::make_unique<RenderWorkers>();
+		Workers->start(NumWorkers);
+	}
+	return Workers.get();
+#endif
+}
+
+} // namespace
+
+size_t GetRenderBandCount(int viewportHeight)
+{
+	if (viewportHeight < 2 * MinBandHeight)
+		return 1;
+	const RenderWorkers *workers = GetRenderWorkers();
+	if (workers == nullptr)
+		return 1;
+	return std::min<size_t>(workers->numWorkers() + 1, static_cast<size_t>(viewportHeight / MinBandHeight));
+}
+
+void RunRenderBands(size_t count, tl::function_ref<void(size_t)> fn)
+{
+	RenderWorkers *workers = count > 1 ? GetRenderWorkers() : nullptr;
+	if (workers == nullptr) {
+		for (size_t band = 0; band < count; ++band)
+			fn(band);
+		return;
+	}
+	workers->run(count, fn);
+}
+
+void ShutdownRenderWorkers()
+{
+	if (Workers == nullptr)
+		return;
+	Workers->stop();
+	Workers = nullptr;
+}
+
+} // namespace devilution
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+#include <function_ref.hpp>
+
+namespace devilution {
+
+/**
+ * @brief Number of horizontal bands a viewport of the given height should be split into.
+ *
+ * Returns 1 when the renderer has no worker threads or the viewport is too small to benefit.
+ */
+size_t GetRenderBandCount(int viewportHeight);
+
+/**
+ * @brief Calls `fn(band)` for every band in `[0, count)` and returns once all of them are done.
+ *
+ * Bands are picked up by the render worker threads and the calling thread alike.
+ * `fn` must only write to pixels owned by its band.
+ */
+void RunRenderBands(size_t count, tl::function_ref<void(size_t)> fn);
+
+/** @brief Stops and joins the render worker threads, if any were started. */
+void ShutdownRenderWorkers();
+
+} // namespace devilution
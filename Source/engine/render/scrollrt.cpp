@@ -5,6 +5,7 @@
  */
 #include "engine/render/scrollrt.h"
 
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -26,7 +27,9 @@
 #include "engine/render/clx_render.hpp"
 #include "engine/render/dun_render.hpp"
 #include "engine/render/light_render.hpp"
+#include "engine/render/render_workers.hpp"
 #include "engine/render/text_render.hpp"
+#include "engine/render/upscale.hpp"
 #include "engine/trn.hpp"
 #include "engine/world_tile.hpp"
 #include "game_mode.hpp"
@@ -236,6 +239,41 @@ inline void ClxDrawLight(const Surface &out, Point position, ClxSprite clx, int
 	}
 }
 
+/**
+ * @brief Returns a TRN that is equivalent to applying @p first and then @p second.
+ * @param first The first TRN, or nullptr
+ * @param second The second TRN, or nullptr
+ * @param buffer Storage for the composed TRN
+ */
+const uint8_t *ComposeTRN(const uint8_t *first, const uint8_t *second, std::array<uint8_t, 256> &buffer)
+{
+	if (first == nullptr)
+		return second;
+	if (second == nullptr)
+		return first;
+	for (size_t i = 0; i < buffer.size(); ++i)
+		buffer[i] = second[first[i]];
+	return buffer.data();
+}
+
+/**
+ * @brief Blit CL2 sprite, and apply the given TRN followed by lighting, to the given buffer at the given coordinates
+ * @param out Output buffer
+ * @param position Target buffer coordinate
+ * @param clx CLX frame
+ * @param trn TRN to apply before lighting, or nullptr
+ */
+void ClxDrawLight(const Surface &out, Point position, ClxSprite clx, int lightTableIndex, const uint8_t *trn)
+{
+	std::array<uint8_t, 256> trnBuffer;
+	trn = ComposeTRN(trn, lightTableIndex != 0 ? LightTables[lightTableIndex].data() : nullptr, trnBuffer);
+	if (trn != nullptr) {
+		ClxDrawTRN(out, position, clx, trn);
+	} else {
+		ClxDraw(out, position, clx);
+	}
+}
+
 /**
  * @brief Blit CL2 sprite, and apply lighting and transparency blending, to the given buffer at the given coordinates
  * @param out Output buffer
@@ -321,10 +359,13 @@ void DrawMissilePrivate(const Surface &out, const Missile &missile, Point target
 
 	const Point missileRenderPosition { targetBufferPosition + missile.position.offsetForRendering - Displacement { missile._miAnimWidth2, 0 } };
 	const ClxSprite sprite = (*missile._miAnimData)[missile._miAnimFrame - 1];
+	// The Rhino charge is drawn with the sprite of the monster that charges.
+	const uint8_t *monsterTypeTrn = missile._mitype == MissileID::Rhino ? Monsters[missile._misource].type().getTRN(sprite) : nullptr;
 	if (missile._miUniqTrans != 0) {
-		ClxDrawTRN(out, missileRenderPosition, sprite, Monsters[missile._misource].uniqueMonsterTRN.get());
+		std::array<uint8_t, 256> trnBuffer;
+		ClxDrawTRN(out, missileRenderPosition, sprite, ComposeTRN(monsterTypeTrn, Monsters[missile._misource].uniqueMonsterTRN.get(), trnBuffer));
 	} else if (missile._miLightFlag) {
-		ClxDrawLight(out, missileRenderPosition, sprite, lightTableIndex);
+		ClxDrawLight(out, missileRenderPosition, sprite, lightTableIndex, monsterTypeTrn);
 	} else {
 		ClxDraw(out, missileRenderPosition, sprite);
 	}
@@ -361,9 +402,11 @@ void DrawMonster(const Surface &out, Point tilePosition, Point targetBufferPosit
 	}
 
 	const ClxSprite sprite = monster.animInfo.currentSprite();
+	const uint8_t *monsterTypeTrn = monster.type().getTRN(sprite);
+	std::array<uint8_t, 256> trnBuffer;
 
 	if (!IsTileLit(tilePosition)) {
-		ClxDrawTRN(out, targetBufferPosition, sprite, GetInfravisionTRN());
+		ClxDrawTRN(out, targetBufferPosition, sprite, ComposeTRN(monsterTypeTrn, GetInfravisionTRN(), trnBuffer));
 		return;
 	}
 	uint8_t *trn = nullptr;
@@ -374,9 +417,9 @@ void DrawMonster(const Surface &out, Point tilePosition, Point targetBufferPosit
 	if (MyPlayer->_pInfraFlag && lightTableIndex > 8)
 		trn = GetInfravisionTRN();
 	if (trn != nullptr)
-		ClxDrawTRN(out, targetBufferPosition, sprite, trn);
+		ClxDrawTRN(out, targetBufferPosition, sprite, ComposeTRN(monsterTypeTrn, trn, trnBuffer));
 	else
-		ClxDrawLight(out, targetBufferPosition, sprite, lightTableIndex);
+		ClxDrawLight(out, targetBufferPosition, sprite, lightTableIndex, monsterTypeTrn);
 }
 
 /**
@@ -728,7 +771,7 @@ void DrawMonsterHelper(const Surface &out, Point tilePosition, Point targetBuffe
 
 	const Point monsterRenderPosition = targetBufferPosition + offset;
 	if (mi == pcursmonst) {
-		ClxDrawOutlineSkipColorZero(out, 233, monsterRenderPosition, sprite);
+		ClxDrawOutlineSkipColorZero(out, 233, monsterRenderPosition, sprite, monster.type().getTRN(sprite));
 	}
 	DrawMonster(out, tilePosition, monsterRenderPosition, monster, lightTableIndex);
 }
@@ -765,10 +808,11 @@ void DrawDungeon(const Surface &out, const Lightmap &lightmap, Point tilePositio
 		const Point position { targetBufferPosition.x - CalculateSpriteTileCenterX(corpse.width), targetBufferPosition.y };
 		const ClxSprite sprite = corpse.spritesForDirection(static_cast<Direction>((bDead >> 5) & 7))[corpse.frame];
 		if (corpse.translationPaletteIndex != 0) {
-			const uint8_t *trn = Monsters[corpse.translationPaletteIndex - 1].uniqueMonsterTRN.get();
+			std::array<uint8_t, 256> trnBuffer;
+			const uint8_t *trn = ComposeTRN(corpse.trn, Monsters[corpse.translationPaletteIndex - 1].uniqueMonsterTRN.get(), trnBuffer);
 			ClxDrawTRN(out, position, sprite, trn);
 		} else {
-			ClxDrawLight(out, position, sprite, lightTableIndex);
+			ClxDrawLight(out, position, sprite, lightTableIndex, corpse.trn);
 		}
 	}
 
@@ -944,6 +988,36 @@ void DrawFloor(const Surface &out, const Lightmap &lightmap, Point tilePosition,
 	}
 }
 
+/**
+ * @brief Render the floor tiles in horizontal bands on the render worker threads
+ *
+ * Each band draws the same tiles in the same order, clipped to its own rows of the buffer,
+ * so the result is identical to a single DrawFloor call.
+ * @param out Output buffer
+ * @param lightmap Per-pixel light buffer
+ * @param tilePosition dPiece coordinates
+ * @param targetBufferPosition Buffer coordinates
+ * @param rows Number of rows
+ * @param columns Tile in a row
+ */
+void DrawFloorInBands(const Surface &out, const Lightmap &lightmap, Point tilePosition, Point targetBufferPosition, int rows, int columns)
+{
+	const size_t bandCount = GetRenderBandCount(out.h());
+	if (bandCount == 1) {
+		DrawFloor(out, lightmap, tilePosition, targetBufferPosition, rows, columns);
+		return;
+	}
+
+	const int bandHeight = (out.h() + static_cast<int>(bandCount) - 1) / static_cast<int>(bandCount);
+	RunRenderBands(bandCount, [&](size_t band) {
+		const int y = static_cast<int>(band) * bandHeight;
+		const int height = std::min(bandHeight, out.h() - y);
+		if (height <= 0)
+			return;
+		DrawFloor(out.subregionY(y, height), lightmap, tilePosition, targetBufferPosition - Displacement { 0, y }, rows, columns);
+	});
+}
+
 /**
  * @brief Renders the floor tiles
  * @param out Output buffer
@@ -1024,43 +1098,8 @@ void Zoom(const Surface &out)
 		}
 	}
 
-	// We round to even for the source width and height.
-	// If the width / height was odd, we copy just one extra pixel / row later on.
-	const int srcWidth = (viewportWidth + 1) / 2;
-	const int doubleableWidth = viewportWidth / 2;
-	const int srcHeight = (out.h() + 1) / 2;
-	const int doubleableHeight = out.h() / 2;
-
-	uint8_t *src = out.at(srcWidth - 1, srcHeight - 1);
-	uint8_t *dst = out.at(viewportOffsetX + viewportWidth - 1, out.h() - 1);
-	const bool oddViewportWidth = (viewportWidth % 2) == 1;
-
-	for (int hgt = 0; hgt < doubleableHeight; hgt++) {
-		// Double the pixels in the line.
-		for (int i = 0; i < doubleableWidth; i++) {
-			*dst-- = *src;
-			*dst-- = *src;
-			--src;
-		}
-
-		// Copy a single extra pixel if the output width is odd.
-		if (oddViewportWidth) {
-			*dst-- = *src;
-			--src;
-		}
-
-		// Skip the rest of the source line.
-		src -= (out.pitch() - srcWidth);
-
-		// Double the line.
-		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
-
-		// Skip the rest of the destination line.
-		dst -= 2 * out.pitch() - viewportWidth;
-	}
-	if ((out.h() % 2) == 1) {
-		memcpy(dst - out.pitch() + 1, dst + 1, viewportWidth);
-	}
+	// If the width / height is odd, the first column / row of the source is only copied once.
+	UpscaleInPlace(out.begin(), out.pitch(), viewportOffsetX, viewportWidth, out.h(), 2);
 }
 
 Displacement tileOffset;
@@ -1171,7 +1210,7 @@ void DrawGame(const Surface &fullOut, Point position, Displacement offset)
 	    out.at(0, 0), out.pitch(), LightTables, FullyLitLightTable, FullyDarkLightTable,
 	    dLight, MicroTileLen);
 
-	DrawFloor(out, lightmap, position, Point {} + offset, rows, columns);
+	DrawFloorInBands(out, lightmap, position, Point {} + offset, rows, columns);
 	DrawTileContent(out, lightmap, position, Point {} + offset, rows, columns);
 
 	if (*GetOptions().Graphics.zoom) {
@@ -1385,9 +1424,7 @@ void DoBlitScreen(Rectangle area)
 	DrawVerticalLine(out, area.position, area.size.height, debugColor);
 	DrawVerticalLine(out, area.position + Displacement { area.size.width - 1, 0 }, area.size.height, debugColor);
 #endif
-	SDL_Rect srcRect = MakeSdlRect(area);
-	SDL_Rect dstRect = MakeSdlRect(area);
-	BltFast(&srcRect, &dstRect);
+	BltFastChanged(MakeSdlRect(area));
 }
 
 /**
@@ -1716,7 +1753,7 @@ void scrollrt_draw_game_screen()
 	DrawCursor(out);
 	DrawMain(hgt, false, false, false, false, false);
 
-	RenderPresent();
+	RenderPresentChanged();
 }
 
 void DrawAndBlit()
@@ -1808,7 +1845,7 @@ void DrawAndBlit()
 		}
 	}
 
-	RenderPresent();
+	RenderPresentChanged();
 }
 
 } // namespace devilution
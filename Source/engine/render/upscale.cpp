@@ -0,0 +1,136 @@
+#include "engine/render/upscale.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DEVILUTIONX_UPSCALE_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define DEVILUTIONX_UPSCALE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace devilution {
+
+namespace {
+
+/** @brief The SIMD kernels process this many source pixels at a time. */
+constexpr unsigned ChunkSize = 16;
+
+/**
+ * @brief Upscales the source pixels `[begin, end)` to `dst`, from the last chunk to the first.
+ *
+ * Returns the number of pixels at the start of the range that are left for the scalar loop.
+ */
+template <unsigned Factor>
+unsigned UpscaleChunks(const uint8_t *src, uint8_t *dst, unsigned begin, unsigned end)
+{
+#if defined(DEVILUTIONX_UPSCALE_SSE2)
+	if constexpr (Factor == 2 || Factor == 4) {
+		while (end - begin >= ChunkSize) {
+			end -= ChunkSize;
+			const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + end));
+			const __m128i lo = _mm_unpacklo_epi8(v, v);
+			const __m128i hi = _mm_unpackhi_epi8(v, v);
+			uint8_t *out = dst + (end - begin) * Factor;
+			if constexpr (Factor == 2) {
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out), lo);
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), hi);
+			} else {
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_unpacklo_epi16(lo, lo));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), _mm_unpackhi_epi16(lo, lo));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 32), _mm_unpacklo_epi16(hi, hi));
+				_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 48), _mm_unpackhi_epi16(hi, hi));
+			}
+		}
+	}
+#elif defined(DEVILUTIONX_UPSCALE_NEON)
+	if constexpr (Factor >= 2 && Factor <= 4) {
+		while (end - begin >= ChunkSize) {
+			end -= ChunkSize;
+			const uint8x16_t v = vld1q_u8(src + end);
+			uint8_t *out = dst + (end - begin) * Factor;
+			if constexpr (Factor == 2) {
+				vst2q_u8(out, (uint8x16x2_t { { v, v } }));
+			} else if constexpr (Factor == 3) {
+				vst3q_u8(out, (uint8x16x3_t { { v, v, v } }));
+			} else {
+				vst4q_u8(out, (uint8x16x4_t { { v, v, v, v } }));
+			}
+		}
+	}
+#endif
+	return end - begin;
+}
+
+template <unsigned Factor>
+void UpscaleRowImpl(const uint8_t *src, uint8_t *dst, unsigned srcWidth, unsigned firstPixelCopies)
+{
+	// `dst` for the pixels after the first one, which are all repeated exactly `Factor` times.
+	uint8_t *rest = dst + firstPixelCopies;
+	const unsigned remaining = UpscaleChunks<Factor>(src, rest, 1, srcWidth);
+	uint8_t *out = rest + remaining * Factor;
+	for (const uint8_t *in = src + remaining; in != src; --in) {
+		out -= Factor;
+		const uint8_t color = *in;
+		for (unsigned i = 0; i < Factor; ++i)
+			out[i] = color;
+	}
+	memset(dst, *src, firstPixelCopies);
+}
+
+} // namespace
+
+void UpscaleRow(const uint8_t *src, uint8_t *dst, unsigned dstWidth, unsigned factor)
+{
+	assert(factor >= 1);
+	if (dstWidth == 0) return;
+	const unsigned srcWidth = (dstWidth + factor - 1) / factor;
+	const unsigned firstPixelCopies = dstWidth - (srcWidth - 1) * factor;
+	switch (factor) {
+	case 1:
+		memmove(dst, src, dstWidth);
+		return;
+	case 2:
+		UpscaleRowImpl<2>(src, dst, srcWidth, firstPixelCopies);
+		return;
+	case 3:
+		UpscaleRowImpl<3>(src, dst, srcWidth, firstPixelCopies);
+		return;
+	case 4:
+		UpscaleRowImpl<4>(src, dst, srcWidth, firstPixelCopies);
+		return;
+	default:
+		for (unsigned i = srcWidth - 1; i > 0; --i) {
+			memset(dst + firstPixelCopies + (i - 1) * factor, src[i], factor);
+		}
+		memset(dst, *src, firstPixelCopies);
+		return;
+	}
+}
+
+void UpscaleInPlace(uint8_t *pixels, int pitch, unsigned dstOffsetX, unsigned dstWidth, unsigned dstHeight, unsigned factor)
+{
+	assert(factor >= 1);
+	if (dstWidth == 0 || dstHeight == 0) return;
+	const unsigned srcHeight = (dstHeight + factor - 1) / factor;
+	const unsigned firstRowCopies = dstHeight - (srcHeight - 1) * factor;
+
+	// Going from the bottom up, every destination row is at or below its source row,
+	// so no source row is overwritten before it is read.
+	for (unsigned srcY = srcHeight; srcY-- > 0;) {
+		const unsigned copies = srcY == 0 ? firstRowCopies : factor;
+		const unsigned firstDstY = srcY == 0 ? 0 : firstRowCopies + (srcY - 1) * factor;
+		const uint8_t *src = pixels + static_cast<ptrdiff_t>(srcY) * pitch;
+		uint8_t *lastDst = pixels + static_cast<ptrdiff_t>(firstDstY + copies - 1) * pitch + dstOffsetX;
+		UpscaleRow(src, lastDst, dstWidth, factor);
+		for (unsigned i = 1; i < copies; ++i) {
+			memcpy(lastDst - static_cast<ptrdiff_t>(i) * pitch, lastDst, dstWidth);
+		}
+	}
+}
+
+} // namespace devilution
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace devilution {
+
+/**
+ * @brief Repeats each pixel of `src` `factor` times horizontally, producing `dstWidth` pixels in `dst`.
+ *
+ * `src` has `ceil(dstWidth / factor)` pixels. If `dstWidth` is not a multiple of `factor`,
+ * the first pixel is repeated fewer times than the others.
+ *
+ * Works backwards, so `dst` may overlap `src` as long as `dst >= src`.
+ */
+void UpscaleRow(const uint8_t *src, uint8_t *dst, unsigned dstWidth, unsigned factor);
+
+/**
+ * @brief Upscales an 8-bit image in place by an integer `factor`.
+ *
+ * The source is the top-left `ceil(dstWidth / factor)` x `ceil(dstHeight / factor)` pixels of `pixels`.
+ * The result is written to the `dstWidth` x `dstHeight` area that starts `dstOffsetX` pixels to the right of `pixels`.
+ * As in `UpscaleRow`, the first row and column are repeated fewer times if the size is not a multiple of `factor`.
+ */
+void UpscaleInPlace(uint8_t *pixels, int pitch, unsigned dstOffsetX, unsigned dstWidth, unsigned dstHeight, unsigned factor);
+
+} // namespace devilution
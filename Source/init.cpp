@@ -13,6 +13,7 @@
 #include <config.h>
 
 #include "DiabloUI/diabloui.h"
+#include "engine/asset_prefetch.hpp"
 #include "engine/assets.hpp"
 #include "engine/backbuffer_state.hpp"
 #include "engine/dx.h"
@@ -52,7 +53,7 @@ constexpr char ExtraFontsVersion[] = "1\n";
 bool AssetContentsEq(AssetRef &&ref, std::string_view expected)
 {
 	const size_t size = ref.size();
-	AssetHandle handle = OpenAsset(std::move(ref), false);
+	AssetHandle handle = OpenAsset(std::move(ref));
 	if (!handle.ok()) return false;
 	const std::unique_ptr<char[]> contents { new char[size] };
 	if (!handle.read(contents.get(), size)) return false;
@@ -118,8 +119,8 @@ void init_cleanup()
 		sfile_write_stash();
 	}
 
-	MpqArchives.clear();
-	HasHellfireMpq = false;
+	ShutdownAssetPrefetch();
+	UnloadArchives();
 
 	NetClose();
 }
@@ -41,6 +41,7 @@ std::vector<PLStruct> ItemPrefixes;
 
 /** Contains the data related to each item suffix. */
 std::vector<PLStruct> ItemSuffixes;
+uint32_t ItemAffixesGeneration;
 
 namespace {
 
@@ -699,6 +700,7 @@ void LoadItemData()
 	LoadUniqueItemDat();
 	LoadItemAffixesDat("txtdata\\items\\item_prefixes.tsv", ItemPrefixes);
 	LoadItemAffixesDat("txtdata\\items\\item_suffixes.tsv", ItemSuffixes);
+	++ItemAffixesGeneration;
 }
 
 std::string_view ItemTypeToString(ItemType itemType)
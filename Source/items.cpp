@@ -20,6 +20,7 @@
 #include <vector>
 
 #include <SDL.h>
+#include <ankerl/unordered_dense.h>
 #include <fmt/core.h>
 
 #include "DiabloUI/ui_flags.hpp"
@@ -81,7 +82,6 @@
 #include "utils/log.hpp"
 #include "utils/math.h"
 #include "utils/sdl_geometry.h"
-#include "utils/static_vector.hpp"
 #include "utils/str_cat.hpp"
 #include "utils/str_split.hpp"
 #include "utils/string_or_view.hpp"
@@ -1031,6 +1031,37 @@ bool StringInPanel(const char *str)
 	return GetLineWidth(str, GameFont12, 2) < 254;
 }
 
+/**
+ * @brief Returns a generated untranslated item name, reusing it if the same key was seen before.
+ *
+ * Generating a name formats it and measures it against the info panel, and the store restock
+ * loops generate the same base item and affix combinations over and over.
+ */
+std::string_view GetCachedItemName(const std::string &key, tl::function_ref<std::string()> generate)
+{
+	// Bounds the memory used by long sessions, rebuilding is cheap.
+	constexpr size_t MaxCachedItemNames = 4096;
+
+	static ankerl::unordered_dense::map<std::string, std::string> CachedNames;
+	static uint32_t CachedNamesGeneration;
+
+	if (CachedNamesGeneration != ItemAffixesGeneration || CachedNames.size() >= MaxCachedItemNames) {
+		CachedNames.clear();
+		CachedNamesGeneration = ItemAffixesGeneration;
+	}
+
+	auto it = CachedNames.find(key);
+	if (it == CachedNames.end())
+		it = CachedNames.emplace(key, generate()).first;
+	return it->second;
+}
+
+/** @brief Appends the identity of an affix to a `GetCachedItemName` key. */
+void AppendAffixKey(std::string &key, const std::vector<PLStruct> &affixList, const PLStruct *affix)
+{
+	StrAppend(key, ":", affix != nullptr ? static_cast<int>(affix - affixList.data()) : -1);
+}
+
 int PLVal(int pv, int p1, int p2, int minv, int maxv)
 {
 	if (p1 == p2)
@@ -1055,7 +1086,23 @@ void SaveItemAffix(const Player &player, Item &item, const PLStruct &affix)
 	}
 }
 
-std::optional<const PLStruct *> SelectAffix(
+/**
+ * @brief The affixes matching one set of `SelectAffix` filters, weighted by `PLChance`.
+ *
+ * Affix `i` covers the rolls in `[cumulativeChance[i - 1], cumulativeChance[i])`,
+ * which matches the order in which the affixes appear in the affix list.
+ */
+struct AffixTable {
+	std::vector<const PLStruct *> affixes;
+	std::vector<uint32_t> cumulativeChance;
+};
+
+struct AffixTableCache {
+	uint32_t generation = 0;
+	ankerl::unordered_dense::map<uint64_t, AffixTable> tables;
+};
+
+AffixTable BuildAffixTable(
     const std::vector<PLStruct> &affixList,
     AffixItemType type,
     int minlvl, int maxlvl,
@@ -1063,7 +1110,8 @@ std::optional<const PLStruct *> SelectAffix(
     goodorevil goe,
     bool excludeChargesForStaffs)
 {
-	StaticVector<const PLStruct *, 256> eligibleAffixes;
+	AffixTable table;
+	uint32_t totalChance = 0;
 
 	for (const PLStruct &affix : affixList) {
 		if (!HasAnyOf(type, affix.PLIType))
@@ -1076,16 +1124,63 @@ std::optional<const PLStruct *> SelectAffix(
 			continue;
 		if (excludeChargesForStaffs && type == AffixItemType::Staff && affix.power.type == IPL_CHARGES)
 			continue;
+		if (affix.PLChance == 0)
+			continue;
 
-		for (int i = 0; i < affix.PLChance; ++i) {
-			eligibleAffixes.push_back(&affix);
-		}
+		totalChance += affix.PLChance;
+		table.affixes.push_back(&affix);
+		table.cumulativeChance.push_back(totalChance);
+	}
+
+	return table;
+}
+
+const AffixTable &GetAffixTable(
+    const std::vector<PLStruct> &affixList,
+    AffixItemType type,
+    int minlvl, int maxlvl,
+    bool onlygood,
+    goodorevil goe,
+    bool excludeChargesForStaffs)
+{
+	static AffixTableCache PrefixTables;
+	static AffixTableCache SuffixTables;
+	AffixTableCache &cache = &affixList == &ItemPrefixes ? PrefixTables : SuffixTables;
+	assert(&affixList == &ItemPrefixes || &affixList == &ItemSuffixes);
+
+	if (cache.generation != ItemAffixesGeneration) {
+		cache.tables.clear();
+		cache.generation = ItemAffixesGeneration;
 	}
 
-	if (eligibleAffixes.empty())
+	const uint64_t key = static_cast<uint64_t>(static_cast<uint16_t>(minlvl))
+	    | (static_cast<uint64_t>(static_cast<uint16_t>(maxlvl)) << 16)
+	    | (static_cast<uint64_t>(type) << 32)
+	    | (static_cast<uint64_t>(goe) << 40)
+	    | (static_cast<uint64_t>(onlygood ? 1 : 0) << 48)
+	    | (static_cast<uint64_t>(excludeChargesForStaffs ? 1 : 0) << 49);
+	auto it = cache.tables.find(key);
+	if (it == cache.tables.end()) {
+		it = cache.tables.emplace(key, BuildAffixTable(affixList, type, minlvl, maxlvl, onlygood, goe, excludeChargesForStaffs)).first;
+	}
+	return it->second;
+}
+
+std::optional<const PLStruct *> SelectAffix(
+    const std::vector<PLStruct> &affixList,
+    AffixItemType type,
+    int minlvl, int maxlvl,
+    bool onlygood,
+    goodorevil goe,
+    bool excludeChargesForStaffs)
+{
+	const AffixTable &table = GetAffixTable(affixList, type, minlvl, maxlvl, onlygood, goe, excludeChargesForStaffs);
+	if (table.affixes.empty())
 		return std::nullopt;
 
-	return eligibleAffixes[GenerateRnd(static_cast<int>(eligibleAffixes.size()))];
+	const uint32_t roll = static_cast<uint32_t>(GenerateRnd(static_cast<int>(table.cumulativeChance.back())));
+	const auto it = std::upper_bound(table.cumulativeChance.begin(), table.cumulativeChance.end(), roll);
+	return table.affixes[it - table.cumulativeChance.begin()];
 }
 
 std::optional<const PLStruct *> GetStaffPrefix(int maxlvl, bool onlygood)
@@ -1135,11 +1230,15 @@ void GetStaffPower(const Player &player, Item &item, int maxlvl, bool onlygood)
 	}
 
 	const ItemData &baseItemData = AllItemsList[item.IDidx];
-	const std::string staffName = GenerateStaffName(baseItemData, item._iSpell, false);
-
-	CopyUtf8(item._iName, staffName, ItemNameLength);
+	static std::string Key;
+	Key.clear();
+	StrAppend(Key, "staff:", item.IDidx, ":", static_cast<int>(item._iSpell));
+	CopyUtf8(item._iName, GetCachedItemName(Key, [&]() { return GenerateStaffName(baseItemData, item._iSpell, false); }), ItemNameLength);
 	if (prefix.has_value()) {
-		const std::string staffNameMagical = GenerateStaffNameMagical(baseItemData, item._iSpell, **prefix, false, std::nullopt);
+		AppendAffixKey(Key, ItemPrefixes, *prefix);
+		const std::string_view staffNameMagical = GetCachedItemName(Key, [&]() {
+			return GenerateStaffNameMagical(baseItemData, item._iSpell, **prefix, false, std::nullopt);
+		});
 		CopyUtf8(item._iIName, staffNameMagical, ItemNameLength);
 	} else {
 		CopyUtf8(item._iIName, item._iName, ItemNameLength);
@@ -1221,10 +1320,21 @@ void GetItemPower(const Player &player, Item &item, int minlvl, int maxlvl, Affi
 		    pSufix = &suffix;
 	    });
 
-	CopyUtf8(item._iIName, GenerateMagicItemName(item._iName, pPrefix, pSufix, false), ItemNameLength);
-	if (!StringInPanel(item._iIName)) {
-		CopyUtf8(item._iIName, GenerateMagicItemName(AllItemsList[item.IDidx].iSName, pPrefix, pSufix, false), ItemNameLength);
-	}
+	static std::string Key;
+	Key.clear();
+	StrAppend(Key, "magic:", item.IDidx);
+	AppendAffixKey(Key, ItemPrefixes, pPrefix);
+	AppendAffixKey(Key, ItemSuffixes, pSufix);
+	StrAppend(Key, ":", item._iName);
+	const std::string_view name = GetCachedItemName(Key, [&]() {
+		// Truncate like `_iIName` does before measuring, so that the result stays the same.
+		char fullName[ItemNameLength];
+		CopyUtf8(fullName, GenerateMagicItemName(item._iName, pPrefix, pSufix, false), ItemNameLength);
+		if (StringInPanel(fullName))
+			return std::string(fullName);
+		return GenerateMagicItemName(AllItemsList[item.IDidx].iSName, pPrefix, pSufix, false);
+	});
+	CopyUtf8(item._iIName, name, ItemNameLength);
 	if (pPrefix != nullptr || pSufix != nullptr)
 		CalcItemValue(item);
 }
@@ -3,8 +3,10 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -13,6 +15,7 @@
 #include <magic_enum/magic_enum.hpp>
 
 #include "engine/clx_sprite.hpp"
+#include "engine/converted_asset_cache.hpp"
 #include "engine/load_file.hpp"
 #include "engine/random.hpp"
 #include "engine/world_tile.hpp"
@@ -29,6 +32,7 @@
 #include "objects.h"
 #include "utils/algorithm/container.hpp"
 #include "utils/bitset2d.hpp"
+#include "utils/endian_read.hpp"
 #include "utils/is_of.hpp"
 #include "utils/log.hpp"
 #include "utils/status_macros.hpp"
@@ -505,7 +509,7 @@ tl::expected<void, std::string> LoadLevelSOLData()
 	return {};
 }
 
-void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen)
+void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen, std::string_view dungeonCelsPath)
 {
 	microTileLen = 10;
 	size_t blocks = 10;
@@ -540,7 +544,34 @@ void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &m
 	c_sort(frameToTypeList, [](const std::pair<uint16_t, DunFrameInfo> &a, const std::pair<uint16_t, DunFrameInfo> &b) {
 		return a.first < b.first;
 	});
-	ReencodeDungeonCels(dungeonCels, frameToTypeList);
+
+	// The re-encoded cels only depend on the source cels and on the frame list (derived from the MIN and SOL data).
+	std::optional<ConvertedAssetCacheKey> cacheKey;
+	if (!dungeonCelsPath.empty()) {
+		uint64_t framesHash = StableHash64Seed;
+		for (const auto &[frame, info] : frameToTypeList) {
+			const uint8_t frameBytes[] = {
+				static_cast<uint8_t>(frame & 0xFF),
+				static_cast<uint8_t>(frame >> 8),
+				info.microTileIndex,
+				static_cast<uint8_t>(info.type),
+				static_cast<uint8_t>(info.properties),
+			};
+			framesHash = StableHash64(frameBytes, sizeof(frameBytes), framesHash);
+		}
+		cacheKey = ConvertedAssetCacheKey::ForAsset(FindAsset(dungeonCelsPath), "dun_cels", ReencodeDungeonCelsVersion, framesHash);
+	}
+	size_t cachedSize;
+	std::unique_ptr<std::byte[]> cached = cacheKey ? LoadCachedAssetData(*cacheKey, cachedSize) : nullptr;
+	if (cached != nullptr) {
+		dungeonCels = std::move(cached);
+	} else {
+		ReencodeDungeonCels(dungeonCels, frameToTypeList);
+		if (cacheKey) {
+			const auto *offsets = reinterpret_cast<const uint8_t *>(dungeonCels.get());
+			StoreCachedAssetData(*cacheKey, dungeonCels.get(), LoadLE32(&offsets[4 * (frameToTypeList.size() + 1)]));
+		}
+	}
 
 	std::vector<std::pair<uint16_t, uint16_t>> celBlockAdjustments = ComputeCelBlockAdjustments(frameToTypeList);
 	if (celBlockAdjustments.size() == 0) return;
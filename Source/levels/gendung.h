@@ -299,7 +299,14 @@ struct Miniset {
 }
 
 tl::expected<void, std::string> LoadLevelSOLData();
-void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen);
+/**
+ * @brief Sets up `DPieceMicros` and re-encodes the dungeon cels.
+ *
+ * @param dungeonCels The dungeon cels as loaded from the `.cel` file. Replaced with the re-encoded cels.
+ * @param microTileLen Set to the number of micro tiles per level piece.
+ * @param dungeonCelsPath The asset path of `dungeonCels`. If not empty, the re-encoded cels are cached on disk.
+ */
+void SetDungeonMicros(std::unique_ptr<std::byte[]> &dungeonCels, uint_fast8_t &microTileLen, std::string_view dungeonCelsPath = {});
 void DRLG_InitTrans();
 void DRLG_MRectTrans(WorldTilePosition origin, WorldTilePosition extent);
 void DRLG_MRectTrans(WorldTileRectangle area);
@@ -7,6 +7,10 @@
 
 #include <cmath>
 #include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -15,11 +19,16 @@
 #include "controls/plrctrls.h"
 #include "cursor.h"
 #include "diablo_msg.hpp"
+#include "engine/asset_prefetch.hpp"
 #include "game_mode.hpp"
+#include "headless_mode.hpp"
+#include "monster.h"
 #include "multi.h"
+#include "quests.h"
 #include "utils/algorithm/container.hpp"
 #include "utils/is_of.hpp"
 #include "utils/language.h"
+#include "utils/str_cat.hpp"
 #include "utils/utf8.hpp"
 
 namespace devilution {
@@ -66,6 +75,67 @@ const uint16_t L5DownList[] = { 124, 125, 128, 130, 131, 134, 135, 139, 141 };
 const uint16_t L6TWarpUpList[] = { 78, 79, 80, 81, 82, 83, 84, 85, 86, 87, 88, 89, 90, 91 };
 const uint16_t L6UpList[] = { 64, 65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77 };
 const uint16_t L6DownList[] = { 56, 57, 58, 59, 60, 61, 62, 63 };
+
+/** The distance in tiles from a trigger at which the files of the level it leads to start being read in the background. */
+constexpr int TriggerPrefetchDistance = 8;
+
+/** The level that the prefetching state below belongs to. */
+int PrefetchFromLevel = -1;
+bool PrefetchFromSetLevel;
+/** The level whose files are being prefetched, or -1. */
+int PrefetchTargetLevel = -1;
+
+int GetTriggerTargetLevel(const TriggerStruct &trigger)
+{
+	switch (trigger._tmsg) {
+	case WM_DIABNEXTLVL:
+		return currlevel + 1;
+	case WM_DIABPREVLVL:
+		return currlevel - 1;
+	case WM_DIABRTNLVL:
+		return GetMapReturnLevel();
+	case WM_DIABTOWNWARP:
+		return trigger._tlvl;
+	case WM_DIABTWARPUP:
+		return 0;
+	default:
+		return -1;
+	}
+}
+
+void AppendLevelTilesetPaths(dungeon_type levelType, std::vector<std::string> &paths)
+{
+	std::string_view prefix;
+	switch (levelType) {
+	case DTYPE_TOWN:
+		prefix = gbIsHellfire ? "nlevels\\towndata\\town" : "levels\\towndata\\town";
+		break;
+	case DTYPE_CATHEDRAL:
+		prefix = "levels\\l1data\\l1";
+		break;
+	case DTYPE_CATACOMBS:
+		prefix = "levels\\l2data\\l2";
+		break;
+	case DTYPE_CAVES:
+		prefix = "levels\\l3data\\l3";
+		break;
+	case DTYPE_HELL:
+		prefix = "levels\\l4data\\l4";
+		break;
+	case DTYPE_NEST:
+		prefix = "nlevels\\l6data\\l6";
+		break;
+	case DTYPE_CRYPT:
+		prefix = "nlevels\\l5data\\l5";
+		break;
+	default:
+		return;
+	}
+	for (const std::string_view ext : { ".cel", ".til", ".min", ".sol" }) {
+		paths.push_back(StrCat(prefix, ext));
+	}
+	paths.push_back(levelType == DTYPE_TOWN ? "levels\\towndata\\automap.amp" : StrCat(prefix, ".amp"));
+}
 } // namespace
 
 void InitNoTriggers()
@@ -935,6 +1005,43 @@ void CheckTriggers()
 	}
 }
 
+void PrefetchTriggerLevels()
+{
+	if (HeadlessMode)
+		return;
+
+	const Point position = MyPlayer->position.tile;
+	int targetLevel = -1;
+	for (int i = 0; i < numtrigs; i++) {
+		if (position.WalkingDistance(trigs[i].position) <= TriggerPrefetchDistance) {
+			targetLevel = GetTriggerTargetLevel(trigs[i]);
+			break;
+		}
+	}
+
+	if (PrefetchFromLevel != currlevel || PrefetchFromSetLevel != setlevel) {
+		// The files of the previous target have been loaded by now, free the rest.
+		// The player usually arrives next to a trigger, so it is ignored until they walk away from it.
+		PrefetchFromLevel = currlevel;
+		PrefetchFromSetLevel = setlevel;
+		PrefetchTargetLevel = targetLevel;
+		PrefetchAssets({});
+		return;
+	}
+
+	if (targetLevel == PrefetchTargetLevel)
+		return;
+	PrefetchTargetLevel = targetLevel;
+	if (targetLevel == -1)
+		return;
+
+	std::vector<std::string> paths;
+	AppendLevelTilesetPaths(GetLevelType(targetLevel), paths);
+	if (targetLevel != 0)
+		AppendPossibleMonsterSpritePaths(targetLevel, paths);
+	PrefetchAssets(std::move(paths));
+}
+
 bool EntranceBoundaryContains(Point entrance, Point position)
 {
 	constexpr Displacement entranceOffsets[7] = { { 0, 0 }, { -1, 0 }, { 0, -1 }, { -1, -1 }, { -2, -1 }, { -1, -2 }, { -2, -2 } };
@@ -41,6 +41,11 @@ void Freeupstairs();
 void CheckTrigForce();
 void CheckTriggers();
 
+/**
+ * @brief Starts reading the files of the level behind the nearest trigger in the background, so that it loads faster.
+ */
+void PrefetchTriggerLevels();
+
 /**
  * @brief Check if the provided position is in the entrance boundary of the entrance.
  * @param entrance The entrance to check.
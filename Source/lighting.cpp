@@ -19,12 +19,14 @@
 #include "engine/load_file.hpp"
 #include "engine/point.hpp"
 #include "engine/points_in_rectangle_range.hpp"
+#include "engine/rectangle.hpp"
 #include "engine/world_tile.hpp"
 #include "levels/tile_properties.hpp"
 #include "objects.h"
 #include "player.h"
 #include "utils/attributes.h"
 #include "utils/is_of.hpp"
+#include "utils/static_vector.hpp"
 #include "utils/status_macros.hpp"
 #include "vision.hpp"
 
@@ -56,6 +58,46 @@ bool UpdateVision;
 /** interpolations of a 32x32 (16x16 mirrored) light circle moving between tiles in steps of 1/8 of a tile */
 uint8_t LightConeInterpolations[8][8][16][16];
 
+/** @brief Maximum distance in tiles from a light to the tiles it can affect. */
+constexpr int LightContributionRadius = 15;
+constexpr int LightContributionSize = 2 * LightContributionRadius + 1;
+/** @brief Marks the tiles in a LightContribution that the light doesn't affect. */
+constexpr uint8_t NoContribution = 0xFF;
+
+/**
+ * @brief The light levels that a light applies to the tiles around it.
+ */
+struct LightContribution {
+	/** Tile corresponding to `levels[0][0]`. */
+	Point origin;
+	/** Light level per tile, or NoContribution. Indexed by [x][y] relative to `origin`. */
+	uint8_t levels[LightContributionSize][LightContributionSize];
+	/** The tiles that the light makes brighter than LightsMax, the others are left at NoContribution. */
+	Rectangle bounds;
+};
+
+/**
+ * @brief What ProcessLightList last applied for a light in `Lights`.
+ */
+struct AppliedLight {
+	bool isApplied;
+	WorldTilePosition tile;
+	DisplacementOf<int8_t> offset;
+	uint8_t radius;
+	LightContribution contribution;
+};
+
+std::array<AppliedLight, MAXLIGHTS> AppliedLights;
+
+/**
+ * @brief Copy of dLight as ProcessLightList left it.
+ *
+ * If dLight still matches it, lights that haven't changed since then only need to be reapplied
+ * where other lights were removed.
+ */
+uint8_t LightMapSnapshot[MAXDUNX][MAXDUNY];
+bool IsLightMapSnapshotValid;
+
 void RotateRadius(DisplacementOf<int8_t> &offset, DisplacementOf<int8_t> &dist, DisplacementOf<int8_t> &light, DisplacementOf<int8_t> &block)
 {
 	dist = { static_cast<int8_t>(7 - dist.deltaY), dist.deltaX };
@@ -74,20 +116,12 @@ void RotateRadius(DisplacementOf<int8_t> &offset, DisplacementOf<int8_t> &dist,
 	}
 }
 
-DVL_ALWAYS_INLINE void SetLight(Point position, uint8_t v)
-{
-	if (LoadingMapObjects)
-		dPreLight[position.x][position.y] = v;
-	else
-		dLight[position.x][position.y] = v;
-}
-
-DVL_ALWAYS_INLINE uint8_t GetLight(Point position)
+/**
+ * @brief The light map that lights are applied to: the static lights while loading map objects, dLight otherwise.
+ */
+DVL_ALWAYS_INLINE uint8_t (&GetLightMap())[MAXDUNX][MAXDUNY]
 {
-	if (LoadingMapObjects)
-		return dPreLight[position.x][position.y];
-
-	return dLight[position.x][position.y];
+	return LoadingMapObjects ? dPreLight : dLight;
 }
 
 bool TileAllowsLight(Point position)
@@ -109,22 +143,10 @@ void DoVisionFlags(Point position, MapExplorationType doAutomap, bool visible)
 	dFlags[position.x][position.y] |= DungeonFlag::Visible;
 }
 
-} // namespace
-
-void DoUnLight(Point position, uint8_t radius)
-{
-	radius++;
-	radius++; // If lights moved at a diagonal it can result in some extra tiles being lit
-
-	auto searchArea = PointsInRectangle(WorldTileRectangle { position, radius });
-
-	for (const WorldTilePosition targetPosition : searchArea) {
-		if (InDungeonBounds(targetPosition))
-			dLight[targetPosition.x][targetPosition.y] = dPreLight[targetPosition.x][targetPosition.y];
-	}
-}
-
-void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
+/**
+ * @brief Calculates which tiles a light affects and how bright it makes them.
+ */
+void CalculateLightContribution(Point position, uint8_t radius, DisplacementOf<int8_t> offset, LightContribution &contribution)
 {
 	assert(radius >= 0 && radius <= NumLightRadiuses);
 	assert(InDungeonBounds(position));
@@ -160,13 +182,13 @@ void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
 		maxY = MAXDUNY - position.y;
 	}
 
+	contribution.origin = position - Displacement { LightContributionRadius };
+	memset(contribution.levels, NoContribution, sizeof(contribution.levels));
+
 	// Allow for dim lights in crypt and nest
-	if (IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT)) {
-		if (GetLight(position) > LightFalloffs[radius][0])
-			SetLight(position, LightFalloffs[radius][0]);
-	} else {
-		SetLight(position, 0);
-	}
+	contribution.levels[LightContributionRadius][LightContributionRadius] = IsAnyOf(leveltype, DTYPE_NEST, DTYPE_CRYPT) ? LightFalloffs[radius][0] : 0;
+	Displacement boundsMin = {};
+	Displacement boundsMax = {};
 
 	for (int i = 0; i < 4; i++) {
 		const int yBound = i > 0 && i < 3 ? maxY : minY;
@@ -176,16 +198,76 @@ void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
 				const int linearDistance = LightConeInterpolations[offset.deltaX][offset.deltaY][x + block.deltaX][y + block.deltaY];
 				if (linearDistance >= 128)
 					continue;
-				const Point temp = position + (Displacement { x, y }).Rotate(-i);
 				const uint8_t v = LightFalloffs[radius][linearDistance];
+				if (v >= LightsMax)
+					continue; // dLight never exceeds LightsMax, so this wouldn't change anything
+				const Displacement rotated = (Displacement { x, y }).Rotate(-i);
+				const Point temp = position + rotated;
 				if (!InDungeonBounds(temp))
 					continue;
-				if (v < GetLight(temp))
-					SetLight(temp, v);
+				uint8_t &level = contribution.levels[LightContributionRadius + rotated.deltaX][LightContributionRadius + rotated.deltaY];
+				level = std::min(level, v);
+				boundsMin = { std::min(boundsMin.deltaX, rotated.deltaX), std::min(boundsMin.deltaY, rotated.deltaY) };
+				boundsMax = { std::max(boundsMax.deltaX, rotated.deltaX), std::max(boundsMax.deltaY, rotated.deltaY) };
 			}
 		}
 		RotateRadius(offset, dist, light, block);
 	}
+
+	contribution.bounds = { position + boundsMin, Size { boundsMax.deltaX - boundsMin.deltaX + 1, boundsMax.deltaY - boundsMin.deltaY + 1 } };
+}
+
+/**
+ * @brief Applies the part of a light's contribution that lies within the given area.
+ */
+void ApplyLightContribution(const LightContribution &contribution, Rectangle area)
+{
+	const Rectangle &bounds = contribution.bounds;
+	const int minX = std::max({ area.position.x, bounds.position.x, 0 });
+	const int minY = std::max({ area.position.y, bounds.position.y, 0 });
+	const int maxX = std::min({ area.position.x + area.size.width, bounds.position.x + bounds.size.width, MAXDUNX });
+	const int maxY = std::min({ area.position.y + area.size.height, bounds.position.y + bounds.size.height, MAXDUNY });
+	uint8_t(&lightMap)[MAXDUNX][MAXDUNY] = GetLightMap();
+	for (int x = minX; x < maxX; x++) {
+		const uint8_t *levels = contribution.levels[x - contribution.origin.x];
+		uint8_t *column = lightMap[x];
+		for (int y = minY; y < maxY; y++) {
+			// NoContribution is larger than any light level, so it is never applied.
+			column[y] = std::min(column[y], levels[y - contribution.origin.y]);
+		}
+	}
+}
+
+void ApplyLightContribution(const LightContribution &contribution)
+{
+	ApplyLightContribution(contribution, Rectangle { contribution.origin, Size { LightContributionSize } });
+}
+
+/**
+ * @brief Returns the area that DoUnLight resets.
+ */
+Rectangle GetUnLightArea(Point position, uint8_t radius)
+{
+	// If lights moved at a diagonal it can result in some extra tiles being lit
+	return Rectangle { position, radius + 2 };
+}
+
+} // namespace
+
+void DoUnLight(Point position, uint8_t radius)
+{
+	const Rectangle area = GetUnLightArea(position, radius);
+	for (const Point targetPosition : PointsInRectangle(area)) {
+		if (InDungeonBounds(targetPosition))
+			dLight[targetPosition.x][targetPosition.y] = dPreLight[targetPosition.x][targetPosition.y];
+	}
+}
+
+void DoLighting(Point position, uint8_t radius, DisplacementOf<int8_t> offset)
+{
+	LightContribution contribution;
+	CalculateLightContribution(position, radius, offset, contribution);
+	ApplyLightContribution(contribution);
 }
 
 void DoUnVision(Point position, uint8_t radius)
@@ -283,6 +365,10 @@ void MakeLightTable()
 		FullyDarkLightTable = nullptr; // Tiles in Hellfire levels are never completely black
 	}
 
+	// The light falloffs below depend on the level type
+	for (AppliedLight &appliedLight : AppliedLights)
+		appliedLight.isApplied = false;
+
 	// Verify that fully lit and fully dark light table optimizations are correctly enabled/disabled (nullptr = disabled)
 	assert((FullyLitLightTable != nullptr) == (LightTables[0][0] == 0 && std::adjacent_find(LightTables[0].begin(), LightTables[0].end() - 1, [](auto x, auto y) { return (x + 1) != y; }) == LightTables[0].end() - 1));
 	assert((FullyDarkLightTable != nullptr) == (std::all_of(LightTables[LightsMax].begin(), LightTables[LightsMax].end(), [](auto x) { return x == 0; })));
@@ -356,6 +442,9 @@ void InitLighting()
 #endif
 
 	std::iota(ActiveLights.begin(), ActiveLights.end(), uint8_t { 0 });
+	for (AppliedLight &appliedLight : AppliedLights)
+		appliedLight.isApplied = false;
+	IsLightMapSnapshotValid = false;
 	VisionActive = {};
 	TransList = {};
 }
@@ -480,29 +569,59 @@ void ProcessLightList()
 #endif
 	if (!UpdateLighting)
 		return;
+
+	// Unless something else has modified dLight since the last update, the lights that haven't changed
+	// are still applied everywhere except where removed or changed lights are being reset.
+	const bool reapplyAll = LoadingMapObjects || !IsLightMapSnapshotValid || memcmp(dLight, LightMapSnapshot, sizeof(dLight)) != 0;
+
+	StaticVector<Rectangle, 2 * MAXLIGHTS> unlitAreas;
 	for (int i = 0; i < ActiveLightCount; i++) {
 		Light &light = Lights[ActiveLights[i]];
 		if (light.isInvalid) {
 			DoUnLight(light.position.tile, light.radius);
+			unlitAreas.push_back(GetUnLightArea(light.position.tile, light.radius));
 		}
 		if (light.hasChanged) {
 			DoUnLight(light.position.old, light.oldRadius);
+			unlitAreas.push_back(GetUnLightArea(light.position.old, light.oldRadius));
 			light.hasChanged = false;
 		}
 	}
 	for (int i = 0; i < ActiveLightCount; i++) {
 		const Light &light = Lights[ActiveLights[i]];
+		AppliedLight &appliedLight = AppliedLights[ActiveLights[i]];
 		if (light.isInvalid) {
+			appliedLight.isApplied = false;
 			ActiveLightCount--;
 			std::swap(ActiveLights[ActiveLightCount], ActiveLights[i]);
 			i--;
 			continue;
 		}
-		if (TileHasAny(light.position.tile, TileProperties::Solid))
+		if (TileHasAny(light.position.tile, TileProperties::Solid)) {
+			appliedLight.isApplied = false;
 			continue; // Monster hidden in a wall, don't spoil the surprise
-		DoLighting(light.position.tile, light.radius, light.position.offset);
+		}
+		if (!appliedLight.isApplied || appliedLight.tile != light.position.tile
+		    || appliedLight.offset != light.position.offset || appliedLight.radius != light.radius) {
+			CalculateLightContribution(light.position.tile, light.radius, light.position.offset, appliedLight.contribution);
+			ApplyLightContribution(appliedLight.contribution);
+			appliedLight.isApplied = true;
+			appliedLight.tile = light.position.tile;
+			appliedLight.offset = light.position.offset;
+			appliedLight.radius = light.radius;
+			continue;
+		}
+		if (reapplyAll) {
+			ApplyLightContribution(appliedLight.contribution);
+			continue;
+		}
+		for (const Rectangle &area : unlitAreas)
+			ApplyLightContribution(appliedLight.contribution, area);
 	}
 
+	if (!LoadingMapObjects)
+		memcpy(LightMapSnapshot, dLight, sizeof(dLight));
+	IsLightMapSnapshotValid = !LoadingMapObjects;
 	UpdateLighting = false;
 }
 
@@ -591,4 +710,11 @@ void lighting_color_cycling()
 	}
 }
 
+#ifdef BUILD_TESTING
+void TestReapplyAllLights()
+{
+	IsLightMapSnapshotValid = false;
+}
+#endif
+
 } // namespace devilution
@@ -77,6 +77,11 @@ void ChangeVisionXY(size_t id, Point position);
 void ProcessVisionList();
 void lighting_color_cycling();
 
+#ifdef BUILD_TESTING
+/** @brief Makes the next ProcessLightList reapply every light in full, as if dLight had been modified elsewhere. */
+void TestReapplyAllLights();
+#endif
+
 constexpr int MaxCrawlRadius = 18;
 
 } // namespace devilution
@@ -6,7 +6,6 @@
 #pragma once
 
 #include <cstdint>
-#include <list>
 #include <optional>
 
 #include "engine/displacement.hpp"
@@ -17,6 +16,7 @@
 #include "player.h"
 #include "spelldat.h"
 #include "utils/is_of.hpp"
+#include "utils/slot_map.hpp"
 
 namespace devilution {
 
@@ -235,7 +235,7 @@ public:
 	}
 };
 
-extern std::list<Missile> Missiles;
+extern SlotMap<Missile> Missiles;
 extern bool MissilePreFlag;
 
 struct DamageRange {
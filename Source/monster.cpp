@@ -19,6 +19,7 @@
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -37,6 +38,7 @@
 #include "effects.h"
 #include "engine/animationinfo.h"
 #include "engine/clx_sprite.hpp"
+#include "engine/demomode.h"
 #include "engine/direction.hpp"
 #include "engine/lighting_defs.hpp"
 #include "engine/load_cl2.hpp"
@@ -45,7 +47,6 @@
 #include "engine/point.hpp"
 #include "engine/points_in_rectangle_range.hpp"
 #include "engine/random.hpp"
-#include "engine/render/clx_render.hpp"
 #include "engine/sound.h"
 #include "engine/sound_position.hpp"
 #include "engine/world_tile.hpp"
@@ -126,6 +127,32 @@ size_t totalmonsters;
 int monstimgtot;
 int uniquetrans;
 
+/**
+ * @brief The active monsters that have MFLAG_GOLEM (golems and berserked monsters), in `ActiveMonsters` order.
+ *
+ * Unless a monster is a golem or berserked itself, these are the only monsters that it can pick as its enemy.
+ * The list is built at the start of `ProcessMonsters`. While monsters are processed, none of them gain or
+ * lose MFLAG_GOLEM and none are deleted, so the list only has to be rebuilt when monsters are added.
+ */
+struct GolemTargetList {
+	StaticVector<unsigned, MaxMonsters> monsterIds;
+	size_t activeMonsterCount;
+	bool valid = false;
+};
+GolemTargetList GolemTargets;
+
+void BuildGolemTargets()
+{
+	GolemTargets.monsterIds.clear();
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		const unsigned monsterId = ActiveMonsters[i];
+		if ((Monsters[monsterId].flags & MFLAG_GOLEM) != 0)
+			GolemTargets.monsterIds.push_back(monsterId);
+	}
+	GolemTargets.activeMonsterCount = ActiveMonsterCount;
+	GolemTargets.valid = true;
+}
+
 constexpr const std::array<_monster_id, 12> SkeletonTypes {
 	MT_WSKELAX,
 	MT_TSKELAX,
@@ -144,6 +171,46 @@ constexpr const std::array<_monster_id, 12> SkeletonTypes {
 /** Maps from monster action to monster animation letter. */
 constexpr char Animletter[7] = "nwahds";
 
+struct FixedMonsterType {
+	_monster_id type;
+	placeflag placeFlag;
+};
+
+/** @brief Returns the monster types that every instance of the given dungeon level has, in addition to the random ones. */
+std::span<const FixedMonsterType> GetFixedLevelMonsterTypes(int level)
+{
+	switch (level) {
+	case 16: {
+		static constexpr FixedMonsterType Types[] { { MT_ADVOCATE, PLACE_SCATTER }, { MT_RBLACK, PLACE_SCATTER }, { MT_DIABLO, PLACE_SPECIAL } };
+		return Types;
+	}
+	case 18: {
+		static constexpr FixedMonsterType Types[] { { MT_HORKSPWN, PLACE_SCATTER } };
+		return Types;
+	}
+	case 19: {
+		static constexpr FixedMonsterType Types[] { { MT_HORKSPWN, PLACE_SCATTER }, { MT_HORKDMN, PLACE_UNIQUE } };
+		return Types;
+	}
+	case 20: {
+		static constexpr FixedMonsterType Types[] { { MT_DEFILER, PLACE_UNIQUE } };
+		return Types;
+	}
+	case 24: {
+		static constexpr FixedMonsterType Types[] { { MT_ARCHLICH, PLACE_SCATTER }, { MT_NAKRUL, PLACE_SPECIAL } };
+		return Types;
+	}
+	default:
+		return {};
+	}
+}
+
+/** @brief Diablo's level only has its fixed monster types. */
+bool HasRandomMonsterTypes(int level)
+{
+	return level != 16;
+}
+
 size_t GetNumAnims(const MonsterData &monsterData)
 {
 	return monsterData.hasSpecial ? 6 : 5;
@@ -166,23 +233,9 @@ void InitMonsterTRN(CMonster &monst)
 {
 	char path[64];
 	*BufCopy(path, "monsters\\", monst.data().trnFile, ".trn") = '\0';
-	std::array<uint8_t, 256> colorTranslations;
-	LoadFileInMem(path, colorTranslations);
-	std::replace(colorTranslations.begin(), colorTranslations.end(), 255, 0);
-
-	const size_t numAnims = GetNumAnims(monst.data());
-	for (size_t i = 0; i < numAnims; i++) {
-		if (i == 1 && IsAnyOf(monst.type, MT_COUNSLR, MT_MAGISTR, MT_CABALIST, MT_ADVOCATE)) {
-			continue;
-		}
-
-		AnimStruct &anim = monst.anims[i];
-		if (anim.sprites->isSheet()) {
-			ClxApplyTrans(ClxSpriteSheet { anim.sprites->sheet() }, colorTranslations.data());
-		} else {
-			ClxApplyTrans(ClxSpriteList { anim.sprites->list() }, colorTranslations.data());
-		}
-	}
+	monst.trn = std::unique_ptr<uint8_t[]> { new uint8_t[256] };
+	LoadFileInMem(path, monst.trn.get(), 256);
+	std::replace(monst.trn.get(), monst.trn.get() + 256, 255, 0);
 }
 
 void InitMonster(Monster &monster, Direction rd, size_t typeIndex, Point position)
@@ -690,19 +743,18 @@ void UpdateEnemy(Monster &monster)
 			}
 		}
 	}
-	for (size_t i = 0; i < ActiveMonsterCount; i++) {
-		const unsigned monsterId = ActiveMonsters[i];
+	const auto considerMonster = [&](unsigned monsterId) {
 		Monster &otherMonster = Monsters[monsterId];
 		if (&otherMonster == &monster)
-			continue;
+			return;
 		if ((otherMonster.hitPoints >> 6) <= 0)
-			continue;
+			return;
 		if (otherMonster.position.tile == GolemHoldingCell)
-			continue;
+			return;
 		if (otherMonster.talkMsg != TEXT_NONE && M_Talker(otherMonster))
-			continue;
+			return;
 		if (isPlayerMinion && otherMonster.isPlayerMinion()) // prevent golems from fighting each other
-			continue;
+			return;
 
 		const int dist = otherMonster.position.tile.WalkingDistance(position);
 		if (((monster.flags & MFLAG_GOLEM) == 0
@@ -712,7 +764,7 @@ void UpdateEnemy(Monster &monster)
 		    || ((monster.flags & MFLAG_GOLEM) == 0
 		        && (monster.flags & MFLAG_BERSERK) == 0
 		        && (otherMonster.flags & MFLAG_GOLEM) == 0)) {
-			continue;
+			return;
 		}
 		const bool sameroom = dTransVal[position.x][position.y] == dTransVal[otherMonster.position.tile.x][otherMonster.position.tile.y];
 		if ((sameroom && !bestsameroom)
@@ -724,6 +776,18 @@ void UpdateEnemy(Monster &monster)
 			bestDist = dist;
 			bestsameroom = sameroom;
 		}
+	};
+	if ((monster.flags & (MFLAG_GOLEM | MFLAG_BERSERK)) == 0 && GolemTargets.valid) {
+		// Other monsters are skipped above, visiting the rest in the same order picks the same enemy.
+		if (GolemTargets.activeMonsterCount != ActiveMonsterCount)
+			BuildGolemTargets();
+		for (const unsigned monsterId : GolemTargets.monsterIds) {
+			considerMonster(monsterId);
+		}
+	} else {
+		for (size_t i = 0; i < ActiveMonsterCount; i++) {
+			considerMonster(ActiveMonsters[i]);
+		}
 	}
 	if (menemy != -1) {
 		monster.flags &= ~MFLAG_NO_ENEMY;
@@ -1690,18 +1754,40 @@ bool RandomWalk2(Monster &monster, Direction md)
 }
 
 /**
- * @brief Check if a tile is affected by a spell we are vulnerable to
+ * @brief The properties of a monster that decide which tiles it is willing to walk on
  */
-bool IsTileSafe(const Monster &monster, Point position)
+struct Passability {
+	bool canOpenDoors;
+	bool fearsFire;
+	bool fearsLightning;
+
+	bool operator==(const Passability &other) const = default;
+};
+
+Passability GetPassability(const Monster &monster)
+{
+	return Passability {
+		.canOpenDoors = (monster.flags & MFLAG_CAN_OPEN_DOOR) != 0,
+		.fearsFire = (monster.resistance & IMMUNE_FIRE) == 0 || monster.type().type == MT_DIABLO,
+		.fearsLightning = (monster.resistance & IMMUNE_LIGHTNING) == 0 || monster.type().type == MT_DIABLO,
+	};
+}
+
+bool IsTileSafe(Passability passability, Point position)
 {
 	if (!InDungeonBounds(position))
 		return false;
 
-	const bool fearsFire = (monster.resistance & IMMUNE_FIRE) == 0 || monster.type().type == MT_DIABLO;
-	const bool fearsLightning = (monster.resistance & IMMUNE_LIGHTNING) == 0 || monster.type().type == MT_DIABLO;
+	return !(passability.fearsFire && HasAnyOf(dFlags[position.x][position.y], DungeonFlag::MissileFireWall))
+	    && !(passability.fearsLightning && HasAnyOf(dFlags[position.x][position.y], DungeonFlag::MissileLightningWall));
+}
 
-	return !(fearsFire && HasAnyOf(dFlags[position.x][position.y], DungeonFlag::MissileFireWall))
-	    && !(fearsLightning && HasAnyOf(dFlags[position.x][position.y], DungeonFlag::MissileLightningWall));
+/**
+ * @brief Check if a tile is affected by a spell we are vulnerable to
+ */
+bool IsTileSafe(const Monster &monster, Point position)
+{
+	return IsTileSafe(GetPassability(monster), position);
 }
 
 /**
@@ -1732,6 +1818,54 @@ bool IsTileAccessible(const Monster &monster, Point position)
 	return IsTileSafe(monster, position);
 }
 
+/**
+ * @brief A distance field to a monster's target, shared by all monsters with the same target and passability.
+ */
+struct PackPath {
+	Passability passability;
+	PathDistanceField field;
+};
+
+/**
+ * @brief The pack paths built during the current game tick.
+ *
+ * Only the first PackPathCount entries are valid, the others are kept to reuse their memory.
+ */
+std::vector<PackPath> PackPaths;
+size_t PackPathCount;
+
+bool UsePackPathfinding()
+{
+	// Pack paths don't break ties between equally short paths like FindPath does,
+	// so they can't be used where the game has to be reproduced exactly.
+	return *GetOptions().Gameplay.packPathfinding && !gbIsMultiplayer && !demo::IsRunning() && !demo::IsRecording();
+}
+
+/**
+ * @brief Returns the first step towards the monster's enemy, from a distance field shared with the rest of its pack.
+ *
+ * Unlike FindPath, other monsters and players are not treated as obstacles, since they move during the tick.
+ * RandomWalk steps around them instead.
+ */
+int8_t GetPackPathStep(const Monster &monster)
+{
+	const Passability passability = GetPassability(monster);
+	for (size_t i = 0; i < PackPathCount; i++) {
+		const PackPath &packPath = PackPaths[i];
+		if (packPath.passability == passability && packPath.field.destination() == monster.enemyPosition)
+			return packPath.field.getFirstStep(CanStep, monster.position.tile);
+	}
+
+	if (PackPathCount == PackPaths.size())
+		PackPaths.emplace_back();
+	PackPath &packPath = PackPaths[PackPathCount++];
+	packPath.passability = passability;
+	packPath.field.build(
+	    CanStep, [passability](Point position) { return IsTileSafe(passability, position) && IsTileWalkable(position, passability.canOpenDoors); },
+	    monster.enemyPosition, MaxPathLengthMonsters);
+	return packPath.field.getFirstStep(CanStep, monster.position.tile);
+}
+
 bool AiPlanWalk(Monster &monster)
 {
 	int8_t path[MaxPathLengthMonsters];
@@ -1739,7 +1873,11 @@ bool AiPlanWalk(Monster &monster)
 	/** Maps from walking path step to facing direction. */
 	const Direction plr2monst[9] = { Direction::South, Direction::NorthEast, Direction::NorthWest, Direction::SouthEast, Direction::SouthWest, Direction::North, Direction::East, Direction::South, Direction::West };
 
-	if (FindPath(CanStep, [&monster](Point position) { return IsTileAccessible(monster, position); }, monster.position.tile, monster.enemyPosition, path, MaxPathLengthMonsters) == 0) {
+	if (UsePackPathfinding()) {
+		path[0] = GetPackPathStep(monster);
+		if (path[0] == -1)
+			return false;
+	} else if (FindPath(CanStep, [&monster](Point position) { return IsTileAccessible(monster, position); }, monster.position.tile, monster.enemyPosition, path, MaxPathLengthMonsters) == 0) {
 		return false;
 	}
 
@@ -3071,7 +3209,7 @@ bool IsRelativeMoveOK(const Monster &monster, Point position, Direction mdir)
 	return true;
 }
 
-bool IsMonsterAvailable(const MonsterData &monsterData)
+bool IsMonsterAvailable(const MonsterData &monsterData, int level)
 {
 	if (monsterData.availability == MonsterAvailability::Never)
 		return false;
@@ -3079,7 +3217,7 @@ bool IsMonsterAvailable(const MonsterData &monsterData)
 	if (gbIsSpawn && monsterData.availability == MonsterAvailability::Retail)
 		return false;
 
-	return currlevel >= monsterData.minDunLvl && currlevel <= monsterData.maxDunLvl;
+	return level >= monsterData.minDunLvl && level <= monsterData.maxDunLvl;
 }
 
 bool UpdateModeStance(Monster &monster)
@@ -3336,25 +3474,11 @@ void InitLevelMonsters()
 tl::expected<void, std::string> GetLevelMTypes()
 {
 	RETURN_IF_ERROR(AddMonsterType(MT_GOLEM, PLACE_SPECIAL));
-	if (currlevel == 16) {
-		RETURN_IF_ERROR(AddMonsterType(MT_ADVOCATE, PLACE_SCATTER));
-		RETURN_IF_ERROR(AddMonsterType(MT_RBLACK, PLACE_SCATTER));
-		RETURN_IF_ERROR(AddMonsterType(MT_DIABLO, PLACE_SPECIAL));
-		return {};
-	}
-
-	if (currlevel == 18)
-		RETURN_IF_ERROR(AddMonsterType(MT_HORKSPWN, PLACE_SCATTER));
-	if (currlevel == 19) {
-		RETURN_IF_ERROR(AddMonsterType(MT_HORKSPWN, PLACE_SCATTER));
-		RETURN_IF_ERROR(AddMonsterType(MT_HORKDMN, PLACE_UNIQUE));
-	}
-	if (currlevel == 20)
-		RETURN_IF_ERROR(AddMonsterType(MT_DEFILER, PLACE_UNIQUE));
-	if (currlevel == 24) {
-		RETURN_IF_ERROR(AddMonsterType(MT_ARCHLICH, PLACE_SCATTER));
-		RETURN_IF_ERROR(AddMonsterType(MT_NAKRUL, PLACE_SPECIAL));
+	for (const FixedMonsterType &fixedType : GetFixedLevelMonsterTypes(currlevel)) {
+		RETURN_IF_ERROR(AddMonsterType(fixedType.type, fixedType.placeFlag));
 	}
+	if (!HasRandomMonsterTypes(currlevel))
+		return {};
 
 	if (!setlevel) {
 		if (Quests[Q_BUTCHER].IsAvailable())
@@ -3377,7 +3501,7 @@ tl::expected<void, std::string> GetLevelMTypes()
 			int skeletonTypeCount = 0;
 			_monster_id skeltypes[NUM_MAX_MTYPES];
 			for (const _monster_id skeletonType : SkeletonTypes) {
-				if (!IsMonsterAvailable(MonstersData[skeletonType]))
+				if (!IsMonsterAvailable(MonstersData[skeletonType], currlevel))
 					continue;
 
 				skeltypes[skeletonTypeCount++] = skeletonType;
@@ -3389,7 +3513,7 @@ tl::expected<void, std::string> GetLevelMTypes()
 
 		int nt = 0;
 		for (size_t i = 0; i < MonstersData.size(); i++) {
-			if (!IsMonsterAvailable(MonstersData[i]))
+			if (!IsMonsterAvailable(MonstersData[i], currlevel))
 				continue;
 
 			typelist[nt++] = (_monster_id)i;
@@ -3448,16 +3572,13 @@ tl::expected<void, std::string> InitMonsterSND(CMonster &monsterType)
 	return {};
 }
 
-tl::expected<void, std::string> InitMonsterGFX(CMonster &monsterType, MonsterSpritesData &&spritesData)
-{
-	if (HeadlessMode)
-		return {};
+namespace {
 
+tl::expected<void, std::string> InitMonsterGFX(CMonster &monsterType, std::shared_ptr<std::byte[]> animData, const std::array<uint32_t, MonsterSpritesData::MaxAnims + 1> &offsets)
+{
 	const _monster_id mtype = monsterType.type;
 	const MonsterData &monsterData = MonstersData[mtype];
-	if (spritesData.data == nullptr)
-		spritesData = LoadMonsterSpritesData(monsterData);
-	monsterType.animData = std::move(spritesData.data);
+	monsterType.animData = std::move(animData);
 
 	const size_t numAnims = GetNumAnims(monsterData);
 	for (size_t i = 0, j = 0; i < numAnims; ++i) {
@@ -3465,14 +3586,15 @@ tl::expected<void, std::string> InitMonsterGFX(CMonster &monsterType, MonsterSpr
 			monsterType.anims[i].sprites = std::nullopt;
 			continue;
 		}
-		const uint32_t begin = spritesData.offsets[j];
-		const uint32_t end = spritesData.offsets[j + 1];
+		const uint32_t begin = offsets[j];
+		const uint32_t end = offsets[j + 1];
 		auto *animSpritesData = reinterpret_cast<uint8_t *>(&monsterType.animData[begin]);
 		const uint16_t numLists = GetNumListsFromClxListOrSheetBuffer(animSpritesData, end - begin);
 		monsterType.anims[i].sprites = ClxSpriteListOrSheet { animSpritesData, numLists };
 		++j;
 	}
 
+	// The sprite data may be shared with other monster types, so the TRN is applied at draw time.
 	if (!monsterData.trnFile.empty()) {
 		InitMonsterTRN(monsterType);
 	}
@@ -3522,6 +3644,18 @@ tl::expected<void, std::string> InitMonsterGFX(CMonster &monsterType, MonsterSpr
 	return {};
 }
 
+} // namespace
+
+tl::expected<void, std::string> InitMonsterGFX(CMonster &monsterType, MonsterSpritesData &&spritesData)
+{
+	if (HeadlessMode)
+		return {};
+
+	if (spritesData.data == nullptr)
+		spritesData = LoadMonsterSpritesData(monsterType.data());
+	return InitMonsterGFX(monsterType, std::move(spritesData.data), spritesData.offsets);
+}
+
 tl::expected<void, std::string> InitAllMonsterGFX()
 {
 	if (HeadlessMode)
@@ -3532,7 +3666,6 @@ tl::expected<void, std::string> InitAllMonsterGFX()
 	for (size_t i = 0; i < LevelMonsterTypeCount; ++i) {
 		monstersBySprite[static_cast<size_t>(LevelMonsterTypes[i].data().spriteId)].emplace_back(i);
 	}
-	size_t totalUniqueBytes = 0;
 	size_t totalBytes = 0;
 	for (const LevelMonsterTypeIndices &monsterTypes : monstersBySprite) {
 		if (monsterTypes.empty())
@@ -3542,19 +3675,17 @@ tl::expected<void, std::string> InitAllMonsterGFX()
 			continue;
 		MonsterSpritesData spritesData = LoadMonsterSpritesData(firstMonster.data());
 		const size_t spritesDataSize = spritesData.offsets[GetNumAnimsWithGraphics(firstMonster.data())];
-		for (size_t i = 1; i < monsterTypes.size(); ++i) {
-			MonsterSpritesData spritesDataCopy { std::unique_ptr<std::byte[]> { new std::byte[spritesDataSize] }, spritesData.offsets };
-			memcpy(spritesDataCopy.data.get(), spritesData.data.get(), spritesDataSize);
-			RETURN_IF_ERROR(InitMonsterGFX(LevelMonsterTypes[monsterTypes[i]], std::move(spritesDataCopy)));
+		const std::shared_ptr<std::byte[]> animData = std::move(spritesData.data);
+		// Monster types that use the same sprite share the sprite data, recolored variants apply their TRN at draw time.
+		for (const size_t monsterType : monsterTypes) {
+			RETURN_IF_ERROR(InitMonsterGFX(LevelMonsterTypes[monsterType], animData, spritesData.offsets));
 		}
 		LogVerbose("Loaded monster graphics: {:15s} {:>4d} KiB   x{:d}", firstMonster.data().spritePath(), spritesDataSize / 1024, monsterTypes.size());
-		totalUniqueBytes += spritesDataSize;
-		totalBytes += spritesDataSize * monsterTypes.size();
-		RETURN_IF_ERROR(InitMonsterGFX(firstMonster, std::move(spritesData)));
+		totalBytes += spritesDataSize;
 	}
-	LogVerbose(" Total monster graphics:                 {:>4d} KiB {:>4d} KiB", totalUniqueBytes / 1024, totalBytes / 1024);
+	LogVerbose(" Total monster graphics:                 {:>4d} KiB", totalBytes / 1024);
 
-	if (totalUniqueBytes > 0) {
+	if (totalBytes > 0) {
 		// we loaded new sprites, check if we need to update existing monsters
 		for (size_t i = 0; i < ActiveMonsterCount; i++) {
 			Monster &monster = Monsters[ActiveMonsters[i]];
@@ -3565,6 +3696,39 @@ tl::expected<void, std::string> InitAllMonsterGFX()
 	return {};
 }
 
+void AppendPossibleMonsterSpritePaths(int level, std::vector<std::string> &paths)
+{
+	// Most likely first, so that the prefetch budget goes to the sprites that are actually loaded.
+	std::vector<_monster_id> types { MT_GOLEM };
+	for (const FixedMonsterType &fixedType : GetFixedLevelMonsterTypes(level)) {
+		types.push_back(fixedType.type);
+	}
+	if (HasRandomMonsterTypes(level)) {
+		const size_t firstRandom = types.size();
+		for (size_t i = 0; i < MonstersData.size(); i++) {
+			if (IsMonsterAvailable(MonstersData[i], level))
+				types.push_back(static_cast<_monster_id>(i));
+		}
+		// `GetLevelMTypes` drops the types that no longer fit the remaining image budget,
+		// so types with smaller sprites are picked more often.
+		std::stable_sort(types.begin() + firstRandom, types.end(), [](_monster_id a, _monster_id b) {
+			return MonstersData[a].image < MonstersData[b].image;
+		});
+	}
+
+	for (const _monster_id type : types) {
+		const MonsterData &monsterData = MonstersData[type];
+		const FileNameWithCharAffixGenerator getFilename({ "monsters\\", monsterData.spritePath() }, DEVILUTIONX_CL2_EXT, Animletter);
+		for (size_t i = 0, numAnims = GetNumAnims(monsterData); i < numAnims; ++i) {
+			if (!monsterData.hasAnim(i))
+				continue;
+			std::string path = getFilename(i);
+			if (c_find(paths, path) == paths.end())
+				paths.push_back(std::move(path));
+		}
+	}
+}
+
 void WeakenNaKrul()
 {
 	if (currlevel != 24 || static_cast<size_t>(UberDiabloMonsterIndex) >= ActiveMonsterCount)
@@ -4123,6 +4287,8 @@ void RemoveEnemyReferences(const Player &player)
 void ProcessMonsters()
 {
 	DeleteMonsterList();
+	BuildGolemTargets();
+	PackPathCount = 0;
 
 	assert(ActiveMonsterCount <= MaxMonsters);
 	for (size_t i = 0; i < ActiveMonsterCount; i++) {
@@ -4199,6 +4365,7 @@ void ProcessMonsters()
 		}
 	}
 
+	GolemTargets.valid = false;
 	DeleteMonsterList();
 }
 
@@ -4206,6 +4373,7 @@ void FreeMonsters()
 {
 	for (CMonster &monsterType : LevelMonsterTypes) {
 		monsterType.animData = nullptr;
+		monsterType.trn = nullptr;
 		monsterType.corpseId = 0;
 		for (AnimStruct &animData : monsterType.anims) {
 			animData.sprites = std::nullopt;
@@ -4810,6 +4978,25 @@ void decode_enemy(Monster &monster, uint8_t enemyId)
 	}
 }
 
+const uint8_t *CMonster::getTRN(ClxSprite sprite) const
+{
+	if (trn == nullptr)
+		return nullptr;
+
+	// Advocates and the like do not recolor their walking animation.
+	if (IsAnyOf(type, MT_COUNSLR, MT_MAGISTR, MT_CABALIST, MT_ADVOCATE)) {
+		const OptionalClxSpriteListOrSheet &walkSprites = getAnimData(MonsterGraphic::Walk).sprites;
+		if (walkSprites) {
+			const uint8_t *begin = walkSprites->isSheet() ? walkSprites->sheet().data() : walkSprites->list().data();
+			const uint8_t *end = begin + walkSprites->dataSize();
+			if (sprite.pixelData() >= begin && sprite.pixelData() < end)
+				return nullptr;
+		}
+	}
+
+	return trn.get();
+}
+
 [[nodiscard]] size_t Monster::getId() const
 {
 	return std::distance<const Monster *>(&Monsters[0], this);
@@ -4978,4 +5165,16 @@ void Monster::occupyTile(Point tile, bool isMoving) const
 	dMonster[tile.x][tile.y] = isMoving ? -id : id;
 }
 
+#ifdef BUILD_TESTING
+void TestUpdateEnemies(bool useGolemTargets)
+{
+	if (useGolemTargets)
+		BuildGolemTargets();
+	for (size_t i = 0; i < ActiveMonsterCount; i++) {
+		UpdateEnemy(Monsters[ActiveMonsters[i]]);
+	}
+	GolemTargets.valid = false;
+}
+#endif
+
 } // namespace devilution
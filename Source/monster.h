@@ -10,7 +10,9 @@
 
 #include <array>
 #include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <expected.hpp>
 #include <function_ref.hpp>
@@ -184,7 +186,10 @@ struct MonsterSpritesData {
 };
 
 struct CMonster {
-	std::unique_ptr<std::byte[]> animData;
+	/** @brief Sprite data, shared between all level monster types that use the same sprite. */
+	std::shared_ptr<std::byte[]> animData;
+	/** @brief Color translation applied at draw time, for types that recolor a shared sprite. */
+	std::unique_ptr<uint8_t[]> trn;
 	AnimStruct anims[6];
 	std::unique_ptr<TSnd> sounds[4][2];
 
@@ -205,6 +210,12 @@ struct CMonster {
 	{
 		return anims[static_cast<int>(graphic)];
 	}
+
+	/**
+	 * @brief Returns the TRN to draw the given sprite of this monster type with.
+	 * @return nullptr if the sprite is drawn with its own colors
+	 */
+	[[nodiscard]] const uint8_t *getTRN(ClxSprite sprite) const;
 };
 
 extern CMonster LevelMonsterTypes[MaxLvlMTypes];
@@ -496,6 +507,15 @@ inline tl::expected<size_t, std::string> AddMonsterType(UniqueMonsterType unique
 tl::expected<void, std::string> InitMonsterSND(CMonster &monsterType);
 tl::expected<void, std::string> InitMonsterGFX(CMonster &monsterType, MonsterSpritesData &&spritesData = {});
 tl::expected<void, std::string> InitAllMonsterGFX();
+/**
+ * @brief Appends the paths of the sprites of all the monster types that can appear on the given level.
+ *
+ * The random monster types of a level are only known once it is generated, because the dungeon
+ * generator consumes the level's random seed first. The paths are appended in order of likelihood:
+ * the golem and the fixed types of the level, then the random candidates with the smallest sprites first.
+ * Quest monsters are not included.
+ */
+void AppendPossibleMonsterSpritePaths(int level, std::vector<std::string> &paths);
 void WeakenNaKrul();
 void InitGolems();
 tl::expected<void, std::string> InitMonsters();
@@ -571,4 +591,12 @@ bool CanTalkToMonst(const Monster &monster);
 uint8_t encode_enemy(Monster &monster);
 void decode_enemy(Monster &monster, uint8_t enemyId);
 
+#ifdef BUILD_TESTING
+/**
+ * @brief Picks a new enemy for every active monster, as `ProcessMonsters` does.
+ * @param useGolemTargets Only consider golems and berserked monsters as targets for ordinary monsters
+ */
+void TestUpdateEnemies(bool useGolemTargets);
+#endif
+
 } // namespace devilution
@@ -0,0 +1,142 @@
+#include "mpq/mpq_block_cache.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <utility>
+
+#include "utils/sdl_mutex.h"
+
+#ifndef DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE
+#define DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE (4 * 1024 * 1024)
+#endif
+
+namespace devilution::mpq_block_cache {
+
+namespace {
+
+using Key = std::tuple<uint32_t, uint32_t, uint32_t>;
+
+struct Entry {
+	Key key;
+	MpqBlockRef block;
+};
+
+struct BlockCache {
+	SdlMutex mutex;
+
+	// Most recently used first.
+	std::list<Entry> entries;
+
+	// Ordered so that all the blocks of an archive can be erased as a range.
+	std::map<Key, std::list<Entry>::iterator> index;
+
+	std::size_t size = 0;
+	std::size_t capacity = DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE;
+
+	// Must be called with `mutex` held.
+	void Erase(std::map<Key, std::list<Entry>::iterator>::iterator it)
+	{
+		size -= it->second->block->size;
+		entries.erase(it->second);
+		index.erase(it);
+	}
+
+	// Must be called with `mutex` held.
+	void EvictUntilFits(std::size_t extraSize)
+	{
+		while (!entries.empty() && size + extraSize > capacity) {
+			Erase(index.find(entries.back().key));
+		}
+	}
+};
+
+BlockCache &GetCache()
+{
+	// Never destroyed so that archives can be closed during static destruction.
+	static auto *cache = new BlockCache();
+	return *cache;
+}
+
+std::atomic<uint32_t> NextArchiveId { 1 };
+
+} // namespace
+
+uint32_t NewArchiveId()
+{
+	return NextArchiveId.fetch_add(1, std::memory_order_relaxed);
+}
+
+MpqBlockRef Find(uint32_t archiveId, uint32_t fileNumber, uint32_t blockNumber)
+{
+	BlockCache &cache = GetCache();
+	const std::lock_guard<SdlMutex> lock(cache.mutex);
+	const auto it = cache.index.find(Key { archiveId, fileNumber, blockNumber });
+	if (it == cache.index.end())
+		return nullptr;
+	cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+	return it->second->block;
+}
+
+MpqBlockRef Insert(uint32_t archiveId, uint32_t fileNumber, uint32_t blockNumber, MpqBlockRef block)
+{
+	BlockCache &cache = GetCache();
+	const std::lock_guard<SdlMutex> lock(cache.mutex);
+	if (block->size > cache.capacity)
+		return block;
+	const Key key { archiveId, fileNumber, blockNumber };
+	if (const auto it = cache.index.find(key); it != cache.index.end()) {
+		cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+		return it->second->block;
+	}
+	cache.EvictUntilFits(block->size);
+	cache.size += block->size;
+	cache.entries.push_front(Entry { key, block });
+	cache.index.emplace(key, cache.entries.begin());
+	return block;
+}
+
+bool IsCacheable(std::size_t fileSize)
+{
+	return fileSize <= GetCapacity() / 8;
+}
+
+void EraseArchive(uint32_t archiveId)
+{
+	BlockCache &cache = GetCache();
+	const std::lock_guard<SdlMutex> lock(cache.mutex);
+	auto it = cache.index.lower_bound(Key { archiveId, 0, 0 });
+	while (it != cache.index.end() && std::get<0>(it->first) == archiveId) {
+		cache.Erase(it++);
+	}
+}
+
+void SetCapacity(std::size_t capacity)
+{
+	BlockCache &cache = GetCache();
+	const std::lock_guard<SdlMutex> lock(cache.mutex);
+	cache.index.clear();
+	cache.entries.clear();
+	cache.size = 0;
+	cache.capacity = capacity;
+}
+
+std::size_t GetCapacity()
+{
+	BlockCache &cache = GetCache();
+	const std::lock_guard<SdlMutex> lock(cache.mutex);
+	return cache.capacity;
+}
+
+std::size_t GetSize()
+{
+	BlockCache &cache = GetCache();
+	const std::lock_guard<SdlMutex> lock(cache.mutex);
+	return cache.size;
+}
+
+} // namespace devilution::mpq_block_cache
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace devilution {
+
+// A decompressed MPQ file block (sector).
+struct MpqBlock {
+	std::unique_ptr<std::uint8_t[]> data;
+	std::size_t size;
+
+	[[nodiscard]] std::span<const std::uint8_t> span() const
+	{
+		return { data.get(), size };
+	}
+};
+
+// Keeps the block alive (and the view into it valid) even if it is evicted from the cache.
+using MpqBlockRef = std::shared_ptr<const MpqBlock>;
+
+// A size-bounded LRU cache of decompressed MPQ blocks shared by all the archives.
+// The default capacity is set by the `DEVILUTIONX_MPQ_BLOCK_CACHE_SIZE` build option.
+// All the functions are thread-safe.
+namespace mpq_block_cache {
+
+// Returns a new ID that identifies an opened archive file in the cache.
+uint32_t NewArchiveId();
+
+// Returns nullptr if the block is not in the cache.
+MpqBlockRef Find(uint32_t archiveId, uint32_t fileNumber, uint32_t blockNumber);
+
+// Adds the block to the cache, evicting the least recently used blocks if needed.
+// If the block has been added concurrently, returns the existing one instead.
+MpqBlockRef Insert(uint32_t archiveId, uint32_t fileNumber, uint32_t blockNumber, MpqBlockRef block);
+
+// Whether the blocks of a file of the given size should be added to the cache.
+// Large files, such as music, would evict everything else while being streamed.
+bool IsCacheable(std::size_t fileSize);
+
+// Removes all the blocks of the given archive.
+void EraseArchive(uint32_t archiveId);
+
+// Removes all the blocks and sets the capacity in bytes. A capacity of 0 disables the cache.
+void SetCapacity(std::size_t capacity);
+
+std::size_t GetCapacity();
+
+// Total size of the cached blocks in bytes.
+std::size_t GetSize();
+
+} // namespace mpq_block_cache
+
+} // namespace devilution
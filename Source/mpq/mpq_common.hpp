@@ -11,6 +11,9 @@ namespace devilution {
 
 constexpr size_t MaxMpqPathSize = 256;
 
+// Larger hash tables are rejected as corrupt.
+constexpr uint32_t MaxHashEntriesCount = 1 << 20;
+
 #pragma pack(push, 1)
 struct MpqFileHeader {
 	static constexpr uint32_t DiabloSignature = LoadLE32("MPQ\x1A");
@@ -1,14 +1,310 @@
 #include "mpq/mpq_reader.hpp"
 
+#include <array>
+#include <cctype>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string_view>
+#include <utility>
 
+#include <SDL_endian.h>
 #include <libmpq/mpq.h>
 
+#include "encrypt.h"
+#include "utils/sdl_mutex.h"
+
 namespace devilution {
 
+namespace {
+
+constexpr uint32_t MpqHashFileKey = 3;
+
+using CryptTable = std::array<uint32_t, 0x500>;
+
+const CryptTable &GetCryptTable()
+{
+	static const CryptTable Table = []() {
+		CryptTable table;
+		uint32_t seed = 0x00100001;
+		for (uint32_t index1 = 0; index1 < 0x100; ++index1) {
+			for (uint32_t index2 = index1, i = 0; i < 5; ++i, index2 += 0x100) {
+				seed = (seed * 125 + 3) % 0x2AAAAB;
+				const uint32_t high = (seed & 0xFFFF) << 16;
+				seed = (seed * 125 + 3) % 0x2AAAAB;
+				table[index2] = high | (seed & 0xFFFF);
+			}
+		}
+		return table;
+	}();
+	return Table;
+}
+
+// The encryption key of a file is the hash of its name without the directory.
+uint32_t GetFileEncryptionKey(std::string_view filename)
+{
+	const size_t separator = filename.find_last_of("\\/");
+	if (separator != std::string_view::npos)
+		filename.remove_prefix(separator + 1);
+
+	const CryptTable &table = GetCryptTable();
+	uint32_t seed1 = 0x7FED7FED;
+	uint32_t seed2 = 0xEEEEEEEE;
+	for (const char c : filename) {
+		const uint32_t ch = static_cast<unsigned char>(std::toupper(static_cast<unsigned char>(c)));
+		seed1 = table[(MpqHashFileKey << 8) + ch] ^ (seed1 + seed2);
+		seed2 = ch + seed1 + seed2 + (seed2 << 5) + 3;
+	}
+	return seed1;
+}
+
+bool IsValidBlockOffsetTable(const std::vector<uint32_t> &offsets, std::size_t packedSize)
+{
+	if (offsets[0] != offsets.size() * sizeof(uint32_t))
+		return false;
+	for (size_t i = 1; i < offsets.size(); ++i) {
+		if (offsets[i] < offsets[i - 1])
+			return false;
+	}
+	return offsets.back() <= packedSize;
+}
+
+} // namespace
+
+MpqFileReader::MpqFileReader(MpqFileReader &&other) noexcept
+    : archive_(nullptr)
+{
+	*this = std::move(other);
+}
+
+MpqFileReader &MpqFileReader::operator=(MpqFileReader &&other) noexcept
+{
+	Close();
+	archive_ = std::exchange(other.archive_, nullptr);
+	fileNumber_ = other.fileNumber_;
+	size_ = other.size_;
+	blockSize_ = other.blockSize_;
+	numBlocks_ = other.numBlocks_;
+	direct_ = other.direct_;
+	imploded_ = other.imploded_;
+	encrypted_ = other.encrypted_;
+	encryptionKey_ = other.encryptionKey_;
+	fileOffset_ = other.fileOffset_;
+	blockOffsets_ = std::move(other.blockOffsets_);
+	packedBlock_ = std::move(other.packedBlock_);
+	explodeBuffer_ = std::move(other.explodeBuffer_);
+	return *this;
+}
+
+MpqFileReader::~MpqFileReader()
+{
+	Close();
+}
+
+void MpqFileReader::Close()
+{
+	if (archive_ == nullptr || direct_)
+		return;
+	const std::lock_guard<SdlMutex> lock(*archive_->libmpqMutex_);
+	archive_->CloseBlockOffsetTable(fileNumber_);
+	archive_ = nullptr;
+}
+
+int32_t MpqFileReader::Init(std::string_view filename)
+{
+	int32_t error;
+	size_ = archive_->GetUnpackedFileSize(fileNumber_, error);
+	if (error != 0)
+		return error;
+	numBlocks_ = archive_->GetNumBlocks(fileNumber_, error);
+	if (error != 0)
+		return error;
+
+	direct_ = InitDirect(filename);
+	if (direct_)
+		return 0;
+
+	const std::lock_guard<SdlMutex> lock(*archive_->libmpqMutex_);
+	error = archive_->OpenBlockOffsetTable(fileNumber_, filename);
+	if (error != 0)
+		return error;
+	libmpq__off_t blockSize;
+	error = libmpq__block_size_unpacked(archive_->archive_, fileNumber_, 0, &blockSize);
+	if (error != 0) {
+		archive_->CloseBlockOffsetTable(fileNumber_);
+		return error;
+	}
+	blockSize_ = static_cast<size_t>(blockSize);
+	packedBlock_.resize(blockSize_);
+	return 0;
+}
+
+bool MpqFileReader::InitDirect(std::string_view filename)
+{
+	if (archive_->blockSize_ == 0)
+		return false;
+	blockSize_ = archive_->blockSize_;
+
+	// Only PKWARE implode is handled directly, as used by the Diablo and Hellfire MPQs.
+	// Anything else, such as multi-compression and single-unit files, goes through libmpq.
+	mpq_archive_s *archive = archive_->archive_;
+	uint32_t compressed;
+	uint32_t imploded;
+	uint32_t encrypted;
+	libmpq__off_t offset;
+	libmpq__off_t packedSize;
+	if (libmpq__file_compressed(archive, fileNumber_, &compressed) != 0 || compressed != 0
+	    || libmpq__file_imploded(archive, fileNumber_, &imploded) != 0
+	    || libmpq__file_encrypted(archive, fileNumber_, &encrypted) != 0
+	    || libmpq__file_offset(archive, fileNumber_, &offset) != 0
+	    || libmpq__file_size_packed(archive, fileNumber_, &packedSize) != 0) {
+		return false;
+	}
+	if (numBlocks_ != (size_ + blockSize_ - 1) / blockSize_)
+		return false;
+	imploded_ = imploded != 0;
+	encrypted_ = encrypted != 0;
+	fileOffset_ = static_cast<std::uint64_t>(offset);
+
+	if (!imploded_) {
+		// Stored files are rarely encrypted and we cannot validate the key for them.
+		return !encrypted_ && static_cast<size_t>(packedSize) >= size_;
+	}
+
+	std::vector<uint32_t> offsets(numBlocks_ + 1);
+	const size_t offsetsSize = offsets.size() * sizeof(uint32_t);
+	if (!archive_->file_.ReadAt(fileOffset_, offsets.data(), offsetsSize))
+		return false;
+
+	if (encrypted_) {
+		// Some files use a key adjusted by their position and size. Detect this by
+		// checking which key results in a valid block offset table.
+		const uint32_t key = GetFileEncryptionKey(filename);
+		const uint32_t fixedKey = (key + static_cast<uint32_t>(offset)) ^ static_cast<uint32_t>(size_);
+		for (const uint32_t candidateKey : { key, fixedKey }) {
+			blockOffsets_ = offsets;
+			libmpq__decrypt_block(blockOffsets_.data(), static_cast<uint32_t>(offsetsSize), candidateKey - 1);
+			if (IsValidBlockOffsetTable(blockOffsets_, static_cast<size_t>(packedSize))) {
+				encryptionKey_ = candidateKey;
+				break;
+			}
+			blockOffsets_.clear();
+		}
+		if (blockOffsets_.empty())
+			return false;
+	} else {
+		for (uint32_t &blockOffset : offsets)
+			blockOffset = SDL_SwapLE32(blockOffset);
+		if (!IsValidBlockOffsetTable(offsets, static_cast<size_t>(packedSize)))
+			return false;
+		blockOffsets_ = std::move(offsets);
+	}
+
+	packedBlock_.resize(blockSize_);
+	explodeBuffer_ = std::unique_ptr<char[]> { new char[PkwareDecompressWorkBufferSize()] };
+	return true;
+}
+
+std::size_t MpqFileReader::blockSize(uint32_t blockNumber) const
+{
+	if (blockNumber + 1 < numBlocks_)
+		return blockSize_;
+	return size_ - static_cast<size_t>(blockNumber) * blockSize_;
+}
+
+int32_t MpqFileReader::ReadBlock(uint32_t blockNumber, uint8_t *out)
+{
+	const size_t outSize = blockSize(blockNumber);
+	if (direct_)
+		return ReadBlockDirect(blockNumber, out, outSize);
+
+	const std::lock_guard<SdlMutex> lock(*archive_->libmpqMutex_);
+	return libmpq__block_read_with_temporary_buffer(
+	    archive_->archive_, fileNumber_, blockNumber, out, static_cast<libmpq__off_t>(outSize),
+	    packedBlock_.data(), static_cast<libmpq__off_t>(packedBlock_.size()),
+	    /*transferred=*/nullptr);
+}
+
+int32_t MpqFileReader::ReadBlockDirect(uint32_t blockNumber, uint8_t *out, std::size_t outSize)
+{
+	if (!imploded_) {
+		if (!archive_->file_.ReadAt(fileOffset_ + static_cast<std::uint64_t>(blockNumber) * blockSize_, out, outSize))
+			return LIBMPQ_ERROR_READ;
+		return 0;
+	}
+
+	const uint32_t packedSize = blockOffsets_[blockNumber + 1] - blockOffsets_[blockNumber];
+	if (packedSize > outSize)
+		return LIBMPQ_ERROR_READ;
+	// Blocks that do not compress are stored as is.
+	uint8_t *packed = packedSize == outSize ? out : packedBlock_.data();
+	if (!archive_->file_.ReadAt(fileOffset_ + blockOffsets_[blockNumber], packed, packedSize))
+		return LIBMPQ_ERROR_READ;
+	if (encrypted_)
+		libmpq__decrypt_block(reinterpret_cast<uint32_t *>(packed), packedSize, encryptionKey_ + blockNumber);
+	if (packed == out)
+		return 0;
+
+	const uint32_t unpackedSize = PkwareDecompress(reinterpret_cast<const std::byte *>(packed), packedSize,
+	    reinterpret_cast<std::byte *>(out), outSize, explodeBuffer_.get());
+	if (unpackedSize != outSize)
+		return LIBMPQ_ERROR_UNPACK;
+	return 0;
+}
+
+MpqBlockRef MpqFileReader::FindCachedBlock(uint32_t blockNumber) const
+{
+	return mpq_block_cache::Find(archive_->cacheId_, fileNumber_, blockNumber);
+}
+
+MpqBlockRef MpqFileReader::GetBlock(uint32_t blockNumber, int32_t &error)
+{
+	error = 0;
+	if (MpqBlockRef cached = FindCachedBlock(blockNumber); cached != nullptr)
+		return cached;
+
+	// Decompress outside of the cache lock so that other threads are not blocked.
+	const size_t size = blockSize(blockNumber);
+	auto block = std::make_shared<MpqBlock>();
+	block->data = std::unique_ptr<uint8_t[]> { new uint8_t[size] };
+	block->size = size;
+	error = ReadBlock(blockNumber, block->data.get());
+	if (error != 0)
+		return nullptr;
+	return mpq_block_cache::Insert(archive_->cacheId_, fileNumber_, blockNumber, std::move(block));
+}
+
+int32_t MpqFileReader::ReadAll(uint8_t *out)
+{
+	const bool cacheBlocks = mpq_block_cache::IsCacheable(size_);
+	for (uint32_t blockNumber = 0; blockNumber < numBlocks_; ++blockNumber) {
+		uint8_t *blockOut = out + static_cast<size_t>(blockNumber) * blockSize_;
+		MpqBlockRef block = FindCachedBlock(blockNumber);
+		int32_t error = 0;
+		if (block == nullptr && cacheBlocks)
+			block = GetBlock(blockNumber, error);
+		if (block != nullptr) {
+			std::memcpy(blockOut, block->data.get(), block->size);
+		} else {
+			error = error != 0 ? error : ReadBlock(blockNumber, blockOut);
+		}
+		if (error != 0)
+			return error;
+	}
+	return 0;
+}
+
+MpqArchive::MpqArchive(std::string path, mpq_archive_s *archive)
+    : path_(std::move(path))
+    , archive_(archive)
+    , cacheId_(mpq_block_cache::NewArchiveId())
+    , libmpqMutex_(std::make_unique<SdlMutex>())
+{
+}
+
 std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error)
 {
 	mpq_archive_s *archive;
@@ -18,16 +314,17 @@ std::optional<MpqArchive> MpqArchive::Open(const char *path, int32_t &error)
 			error = 0;
 		return std::nullopt;
 	}
-	return MpqArchive { std::string(path), archive };
-}
+	MpqArchive result { std::string(path), archive };
 
-std::optional<MpqArchive> MpqArchive::Clone(int32_t &error)
-{
-	mpq_archive_s *copy;
-	error = libmpq__archive_dup(archive_, path_.c_str(), &copy);
-	if (error != 0)
-		return std::nullopt;
-	return MpqArchive { path_, copy };
+	// Direct reads expect the archive to start at the beginning of the file, as all the Diablo MPQs do.
+	// Otherwise, all the reads go through libmpq.
+	MpqFileHeader header;
+	if (result.file_.Open(path)
+	    && result.file_.ReadAt(0, &header, MpqFileHeader::DiabloSize)
+	    && SDL_SwapLE32(header.signature) == MpqFileHeader::DiabloSignature) {
+		result.blockSize_ = static_cast<size_t>(512) << SDL_SwapLE16(header.blockSizeFactor);
+	}
+	return result;
 }
 
 const char *MpqArchive::ErrorMessage(int32_t errorCode)
@@ -35,14 +332,30 @@ const char *MpqArchive::ErrorMessage(int32_t errorCode)
 	return libmpq__strerror(errorCode);
 }
 
+MpqArchive::MpqArchive(MpqArchive &&other) noexcept
+    : path_(std::move(other.path_))
+    , archive_(std::exchange(other.archive_, nullptr))
+    , file_(std::move(other.file_))
+    , blockSize_(other.blockSize_)
+    , cacheId_(std::exchange(other.cacheId_, 0))
+    , libmpqMutex_(std::move(other.libmpqMutex_))
+    , openBlockOffsetTables_(std::move(other.openBlockOffsetTables_))
+{
+}
+
 MpqArchive &MpqArchive::operator=(MpqArchive &&other) noexcept
 {
 	path_ = std::move(other.path_);
 	if (archive_ != nullptr)
 		libmpq__archive_close(archive_);
-	archive_ = other.archive_;
-	other.archive_ = nullptr;
-	tmp_buf_ = std::move(other.tmp_buf_);
+	if (cacheId_ != 0)
+		mpq_block_cache::EraseArchive(cacheId_);
+	archive_ = std::exchange(other.archive_, nullptr);
+	file_ = std::move(other.file_);
+	blockSize_ = other.blockSize_;
+	cacheId_ = std::exchange(other.cacheId_, 0);
+	libmpqMutex_ = std::move(other.libmpqMutex_);
+	openBlockOffsetTables_ = std::move(other.openBlockOffsetTables_);
 	return *this;
 }
 
@@ -50,71 +363,85 @@ MpqArchive::~MpqArchive()
 {
 	if (archive_ != nullptr)
 		libmpq__archive_close(archive_);
+	if (cacheId_ != 0)
+		mpq_block_cache::EraseArchive(cacheId_);
 }
 
-bool MpqArchive::GetFileNumber(MpqFileHash fileHash, uint32_t &fileNumber)
+bool MpqArchive::GetFileNumber(MpqFileHash fileHash, uint32_t &fileNumber) const
 {
 	return libmpq__file_number_from_hash(archive_, fileHash[0], fileHash[1], fileHash[2], &fileNumber) == 0;
 }
 
-std::unique_ptr<std::byte[]> MpqArchive::ReadFile(std::string_view filename, std::size_t &fileSize, int32_t &error)
+bool MpqArchive::ForEachFile(tl::function_ref<void(uint32_t hashA, uint32_t hashB, uint32_t fileNumber)> fn) const
 {
-	std::unique_ptr<std::byte[]> result;
-	std::uint32_t fileNumber;
-	error = libmpq__file_number_s(archive_, filename.data(), filename.size(), &fileNumber);
-	if (error != 0)
-		return result;
+	MpqFileHeader header;
+	if (blockSize_ == 0 || !file_.ReadAt(0, &header, MpqFileHeader::DiabloSize))
+		return false;
+	const uint32_t count = SDL_SwapLE32(header.hashEntriesCount);
+	if (count == 0 || (count & (count - 1)) != 0 || count > MaxHashEntriesCount)
+		return false;
 
-	libmpq__off_t unpackedSize;
-	error = libmpq__file_size_unpacked(archive_, fileNumber, &unpackedSize);
-	if (error != 0)
-		return result;
+	std::unique_ptr<MpqHashEntry[]> hashTable { new MpqHashEntry[count] };
+	const uint32_t size = count * sizeof(MpqHashEntry);
+	if (!file_.ReadAt(SDL_SwapLE32(header.hashEntriesOffset), hashTable.get(), size))
+		return false;
+	libmpq__decrypt_block(reinterpret_cast<uint32_t *>(hashTable.get()), size, LIBMPQ_HASH_TABLE_HASH_KEY);
 
-	error = OpenBlockOffsetTable(fileNumber, filename);
-	if (error != 0)
-		return result;
+	for (uint32_t i = 0; i < count; ++i) {
+		const MpqHashEntry &entry = hashTable[i];
+		if (entry.block == MpqHashEntry::NullBlock || entry.block == MpqHashEntry::DeletedBlock)
+			continue;
+		// A lookup starts probing at the index hash, so starting at `i` finds this entry first.
+		uint32_t fileNumber;
+		if (GetFileNumber({ i, entry.hashA, entry.hashB }, fileNumber))
+			fn(entry.hashA, entry.hashB, fileNumber);
+	}
+	return true;
+}
 
-	result = std::make_unique<std::byte[]>(static_cast<size_t>(unpackedSize));
+std::optional<MpqFileReader> MpqArchive::OpenFile(uint32_t fileNumber, std::string_view filename, int32_t &error)
+{
+	MpqFileReader reader { *this, fileNumber };
+	error = reader.Init(filename);
+	if (error != 0) {
+		// Nothing to close.
+		reader.archive_ = nullptr;
+		return std::nullopt;
+	}
+	return reader;
+}
 
-	const std::size_t blockSize = GetBlockSize(fileNumber, 0, error);
+std::unique_ptr<std::byte[]> MpqArchive::ReadFile(std::string_view filename, std::size_t &fileSize, int32_t &error)
+{
+	std::unique_ptr<std::byte[]> result;
+	std::uint32_t fileNumber;
+	error = libmpq__file_number_s(archive_, filename.data(), filename.size(), &fileNumber);
 	if (error != 0)
 		return result;
 
-	std::vector<std::uint8_t> &tmp = GetTemporaryBuffer(blockSize);
-	if (error != 0)
+	std::optional<MpqFileReader> reader = OpenFile(fileNumber, filename, error);
+	if (!reader)
 		return result;
 
-	error = libmpq__file_read_with_filename_and_temporary_buffer_s(
-	    archive_, fileNumber, filename.data(), filename.size(), reinterpret_cast<std::uint8_t *>(result.get()), unpackedSize,
-	    tmp.data(), static_cast<libmpq__off_t>(blockSize), nullptr);
+	result = std::unique_ptr<std::byte[]> { new std::byte[reader->size()] };
+	error = reader->ReadAll(reinterpret_cast<uint8_t *>(result.get()));
 	if (error != 0) {
 		result = nullptr;
-		CloseBlockOffsetTable(fileNumber);
 		return result;
 	}
-	CloseBlockOffsetTable(fileNumber);
 
-	fileSize = static_cast<size_t>(unpackedSize);
+	fileSize = reader->size();
 	return result;
 }
 
-int32_t MpqArchive::ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, size_t outSize)
-{
-	std::vector<std::uint8_t> &tmpBuf = GetTemporaryBuffer(outSize);
-	return libmpq__block_read_with_temporary_buffer(
-	    archive_, fileNumber, blockNumber, out, static_cast<libmpq__off_t>(outSize),
-	    tmpBuf.data(), outSize,
-	    /*transferred=*/nullptr);
-}
-
-std::size_t MpqArchive::GetUnpackedFileSize(uint32_t fileNumber, int32_t &error)
+std::size_t MpqArchive::GetUnpackedFileSize(uint32_t fileNumber, int32_t &error) const
 {
 	libmpq__off_t unpackedSize;
 	error = libmpq__file_size_unpacked(archive_, fileNumber, &unpackedSize);
 	return static_cast<size_t>(unpackedSize);
 }
 
-uint32_t MpqArchive::GetNumBlocks(uint32_t fileNumber, int32_t &error)
+uint32_t MpqArchive::GetNumBlocks(uint32_t fileNumber, int32_t &error) const
 {
 	uint32_t numBlocks;
 	error = libmpq__file_blocks(archive_, fileNumber, &numBlocks);
@@ -123,20 +450,27 @@ uint32_t MpqArchive::GetNumBlocks(uint32_t fileNumber, int32_t &error)
 
 int32_t MpqArchive::OpenBlockOffsetTable(uint32_t fileNumber, std::string_view filename)
 {
-	return libmpq__block_open_offset_with_filename_s(archive_, fileNumber, filename.data(), filename.size());
-}
-
-int32_t MpqArchive::CloseBlockOffsetTable(uint32_t fileNumber)
-{
-	return libmpq__block_close_offset(archive_, fileNumber);
+	uint32_t &numReaders = openBlockOffsetTables_[fileNumber];
+	if (numReaders == 0) {
+		const int32_t error = libmpq__block_open_offset_with_filename_s(archive_, fileNumber, filename.data(), filename.size());
+		if (error != 0) {
+			openBlockOffsetTables_.erase(fileNumber);
+			return error;
+		}
+	}
+	++numReaders;
+	return 0;
 }
 
-// Requires the block offset table to be open
-std::size_t MpqArchive::GetBlockSize(uint32_t fileNumber, uint32_t blockNumber, int32_t &error)
+void MpqArchive::CloseBlockOffsetTable(uint32_t fileNumber)
 {
-	libmpq__off_t blockSize;
-	error = libmpq__block_size_unpacked(archive_, fileNumber, blockNumber, &blockSize);
-	return static_cast<size_t>(blockSize);
+	const auto it = openBlockOffsetTables_.find(fileNumber);
+	if (it == openBlockOffsetTables_.end())
+		return;
+	if (--it->second == 0) {
+		libmpq__block_close_offset(archive_, fileNumber);
+		openBlockOffsetTables_.erase(it);
+	}
 }
 
 bool MpqArchive::HasFile(std::string_view filename) const
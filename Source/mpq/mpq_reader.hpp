@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -9,7 +10,11 @@
 #include <utility>
 #include <vector>
 
+#include <function_ref.hpp>
+
+#include "mpq/mpq_block_cache.hpp"
 #include "mpq/mpq_common.hpp"
+#include "utils/positional_file.hpp"
 
 // Forward-declare so that we can avoid exposing libmpq.
 struct mpq_archive;
@@ -17,65 +22,149 @@ using mpq_archive_s = struct mpq_archive;
 
 namespace devilution {
 
-class MpqArchive {
-public:
-	// If the file does not exist, returns nullopt without an error.
-	static std::optional<MpqArchive> Open(const char *path, int32_t &error);
+class MpqArchive;
+class SdlMutex;
 
-	std::optional<MpqArchive> Clone(int32_t &error);
+// Reads a single file of an `MpqArchive`.
+// Holds all the per-reader state and scratch buffers, so that several threads can read
+// from the same archive at the same time as long as each one uses its own `MpqFileReader`.
+class MpqFileReader {
+public:
+	MpqFileReader(MpqFileReader &&other) noexcept;
+	MpqFileReader &operator=(MpqFileReader &&other) noexcept;
+	~MpqFileReader();
 
-	static const char *ErrorMessage(int32_t errorCode);
+	[[nodiscard]] std::size_t size() const
+	{
+		return size_;
+	}
 
-	MpqArchive(MpqArchive &&other) noexcept
-	    : path_(std::move(other.path_))
-	    , archive_(other.archive_)
-	    , tmp_buf_(std::move(other.tmp_buf_))
+	[[nodiscard]] uint32_t numBlocks() const
 	{
-		other.archive_ = nullptr;
+		return numBlocks_;
 	}
 
-	MpqArchive &operator=(MpqArchive &&other) noexcept;
+	// Unpacked size of the given block.
+	[[nodiscard]] std::size_t blockSize(uint32_t blockNumber) const;
 
-	~MpqArchive();
+	// Reads and decompresses a block into `out`, which must fit `blockSize(blockNumber)` bytes.
+	// Returns error code.
+	int32_t ReadBlock(uint32_t blockNumber, uint8_t *out);
 
-	// Returns false if the file does not exit.
-	bool GetFileNumber(MpqFileHash fileHash, uint32_t &fileNumber);
+	// Returns the decompressed block from the shared block cache, reading and adding it to the cache if needed.
+	// Returns nullptr on error.
+	MpqBlockRef GetBlock(uint32_t blockNumber, int32_t &error);
 
-	std::unique_ptr<std::byte[]> ReadFile(std::string_view filename, std::size_t &fileSize, int32_t &error);
+	// Same as `GetBlock` but only returns a block if it is already cached.
+	[[nodiscard]] MpqBlockRef FindCachedBlock(uint32_t blockNumber) const;
 
+	// Reads the whole file into `out`, which must fit `size()` bytes.
 	// Returns error code.
-	int32_t ReadBlock(uint32_t fileNumber, uint32_t blockNumber, uint8_t *out, size_t outSize);
+	int32_t ReadAll(uint8_t *out);
 
-	std::size_t GetUnpackedFileSize(uint32_t fileNumber, int32_t &error);
+private:
+	friend class MpqArchive;
 
-	uint32_t GetNumBlocks(uint32_t fileNumber, int32_t &error);
+	MpqFileReader(MpqArchive &archive, uint32_t fileNumber)
+	    : archive_(&archive)
+	    , fileNumber_(fileNumber)
+	{
+	}
 
-	int32_t OpenBlockOffsetTable(uint32_t fileNumber, std::string_view filename);
+	// Returns error code.
+	int32_t Init(std::string_view filename);
+
+	void Close();
+
+	// Returns false if the file must be read with libmpq instead.
+	bool InitDirect(std::string_view filename);
+
+	int32_t ReadBlockDirect(uint32_t blockNumber, uint8_t *out, std::size_t outSize);
+
+	MpqArchive *archive_;
+	uint32_t fileNumber_;
+	std::size_t size_ = 0;
+	std::size_t blockSize_ = 0;
+	uint32_t numBlocks_ = 0;
+
+	// Whether the file is read directly with positional I/O rather than with libmpq.
+	// libmpq keeps the file position and block offset tables in the archive,
+	// so reads of the files that libmpq has to handle are serialized.
+	bool direct_ = false;
+	bool imploded_ = false;
+	bool encrypted_ = false;
+	uint32_t encryptionKey_ = 0;
+	std::uint64_t fileOffset_ = 0;
+	std::vector<uint32_t> blockOffsets_;
+
+	// Scratch buffers:
+	std::vector<uint8_t> packedBlock_;
+	std::unique_ptr<char[]> explodeBuffer_;
+};
+
+class MpqArchive {
+public:
+	// If the file does not exist, returns nullopt without an error.
+	static std::optional<MpqArchive> Open(const char *path, int32_t &error);
 
-	int32_t CloseBlockOffsetTable(uint32_t fileNumber);
+	static const char *ErrorMessage(int32_t errorCode);
+
+	MpqArchive(MpqArchive &&other) noexcept;
+	MpqArchive &operator=(MpqArchive &&other) noexcept;
 
-	// Requires the block offset table to be open
-	std::size_t GetBlockSize(uint32_t fileNumber, uint32_t blockNumber, int32_t &error);
+	~MpqArchive();
+
+	// All the functions below are thread-safe.
+	// File lookups only read the immutable archive tables and do not lock.
+
+	// Returns false if the file does not exit.
+	bool GetFileNumber(MpqFileHash fileHash, uint32_t &fileNumber) const;
+
+	std::optional<MpqFileReader> OpenFile(uint32_t fileNumber, std::string_view filename, int32_t &error);
+
+	std::unique_ptr<std::byte[]> ReadFile(std::string_view filename, std::size_t &fileSize, int32_t &error);
+
+	std::size_t GetUnpackedFileSize(uint32_t fileNumber, int32_t &error) const;
+
+	uint32_t GetNumBlocks(uint32_t fileNumber, int32_t &error) const;
 
 	bool HasFile(std::string_view filename) const;
 
-private:
-	MpqArchive(std::string path, mpq_archive_s *archive)
-	    : path_(std::move(path))
-	    , archive_(archive)
-	{
-	}
+	// Calls `fn` with the name hashes (`fileHash[1]` and `fileHash[2]`) and the number of every file in the archive.
+	// Returns false if the hash table cannot be read directly.
+	bool ForEachFile(tl::function_ref<void(uint32_t hashA, uint32_t hashB, uint32_t fileNumber)> fn) const;
 
-	std::vector<std::uint8_t> &GetTemporaryBuffer(std::size_t size)
+	[[nodiscard]] const std::string &GetPath() const
 	{
-		if (tmp_buf_.size() < size)
-			tmp_buf_.resize(size);
-		return tmp_buf_;
+		return path_;
 	}
 
+private:
+	friend class MpqFileReader;
+
+	MpqArchive(std::string path, mpq_archive_s *archive);
+
+	// Must be called with `libmpqMutex_` held.
+	int32_t OpenBlockOffsetTable(uint32_t fileNumber, std::string_view filename);
+	void CloseBlockOffsetTable(uint32_t fileNumber);
+
 	std::string path_;
 	mpq_archive_s *archive_;
-	std::vector<std::uint8_t> tmp_buf_;
+
+	// Opened separately from libmpq's file for lock-free reads.
+	PositionalFile file_;
+
+	// 0 if the archive is not laid out the way direct reads expect.
+	std::size_t blockSize_ = 0;
+
+	// Identifies the archive file in the block cache.
+	uint32_t cacheId_;
+
+	// Guards libmpq's file position and block offset tables.
+	std::unique_ptr<SdlMutex> libmpqMutex_;
+
+	// Number of the readers using each open libmpq block offset table.
+	std::map<uint32_t, uint32_t> openBlockOffsetTables_;
 };
 
 } // namespace devilution
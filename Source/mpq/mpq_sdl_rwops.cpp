@@ -12,18 +12,21 @@ namespace {
 
 struct Data {
 	// File information:
-	std::optional<MpqArchive> ownedArchive;
-	MpqArchive *mpqArchive;
-	uint32_t fileNumber;
+	std::optional<MpqFileReader> reader;
 	size_t blockSize;
 	size_t lastBlockSize;
 	uint32_t numBlocks;
 	size_t size;
+	bool cacheBlocks;
 
 	// State:
 	size_t position;
-	bool blockRead;
-	std::unique_ptr<uint8_t[]> blockData;
+
+	// The current block, or nullptr if it has not been read yet.
+	MpqBlockRef block;
+
+	// Used instead of the block cache for large files.
+	std::shared_ptr<MpqBlock> ownBlock;
 };
 
 Data *GetData(struct SDL_RWops *context)
@@ -36,6 +39,28 @@ void SetData(struct SDL_RWops *context, Data *data)
 	context->hidden.unknown.data1 = data;
 }
 
+bool ReadCurrentBlock(Data &data, uint32_t blockNumber)
+{
+	int32_t error = 0;
+	if (data.cacheBlocks) {
+		data.block = data.reader->GetBlock(blockNumber, error);
+	} else if ((data.block = data.reader->FindCachedBlock(blockNumber)) == nullptr) {
+		if (data.ownBlock == nullptr) {
+			data.ownBlock = std::make_shared<MpqBlock>();
+			data.ownBlock->data = std::unique_ptr<uint8_t[]> { new uint8_t[data.blockSize] };
+			data.ownBlock->size = data.blockSize;
+		}
+		error = data.reader->ReadBlock(blockNumber, data.ownBlock->data.get());
+		if (error == 0)
+			data.block = data.ownBlock;
+	}
+	if (error != 0) {
+		SDL_SetError("MpqFileRwRead ReadBlock: %s", MpqArchive::ErrorMessage(error));
+		return false;
+	}
+	return true;
+}
+
 #ifndef USE_SDL1
 using OffsetType = Sint64;
 using SizeType = size_t;
@@ -85,7 +110,7 @@ static OffsetType MpqFileRwSeek(struct SDL_RWops *context, OffsetType offset, in
 	}
 
 	if (data.position / data.blockSize != static_cast<size_t>(newPosition) / data.blockSize)
-		data.blockRead = false;
+		data.block = nullptr;
 
 	data.position = static_cast<size_t>(newPosition);
 
@@ -100,10 +125,6 @@ static SizeType MpqFileRwRead(struct SDL_RWops *context, void *ptr, SizeType siz
 
 	auto *out = static_cast<uint8_t *>(ptr);
 
-	if (data.blockData == nullptr) {
-		data.blockData = std::unique_ptr<uint8_t[]> { new uint8_t[data.blockSize] };
-	}
-
 	uint32_t blockNumber = static_cast<uint32_t>(data.position / data.blockSize);
 	while (remainingSize > 0) {
 		if (data.position == data.size) {
@@ -112,30 +133,25 @@ static SizeType MpqFileRwRead(struct SDL_RWops *context, void *ptr, SizeType siz
 
 		const size_t currentBlockSize = blockNumber + 1 == data.numBlocks ? data.lastBlockSize : data.blockSize;
 
-		if (!data.blockRead) {
-			const int32_t error = data.mpqArchive->ReadBlock(data.fileNumber, blockNumber, data.blockData.get(), currentBlockSize);
-			if (error != 0) {
-				SDL_SetError("MpqFileRwRead ReadBlock: %s", MpqArchive::ErrorMessage(error));
-				return 0;
-			}
-			data.blockRead = true;
-		}
+		if (data.block == nullptr && !ReadCurrentBlock(data, blockNumber))
+			return 0;
 
+		const uint8_t *blockData = data.block->data.get();
 		const size_t blockPosition = data.position - blockNumber * data.blockSize;
 		const size_t remainingBlockSize = currentBlockSize - blockPosition;
 
 		if (remainingSize < remainingBlockSize) {
-			std::memcpy(out, data.blockData.get() + blockPosition, remainingSize);
+			std::memcpy(out, blockData + blockPosition, remainingSize);
 			data.position += remainingSize;
 			return maxnum;
 		}
 
-		std::memcpy(out, data.blockData.get() + blockPosition, remainingBlockSize);
+		std::memcpy(out, blockData + blockPosition, remainingBlockSize);
 		out += remainingBlockSize;
 		data.position += remainingBlockSize;
 		remainingSize -= remainingBlockSize;
 		++blockNumber;
-		data.blockRead = false;
+		data.block = nullptr;
 	}
 
 	return static_cast<SizeType>((totalSize - remainingSize) / size);
@@ -143,9 +159,7 @@ static SizeType MpqFileRwRead(struct SDL_RWops *context, void *ptr, SizeType siz
 
 static int MpqFileRwClose(struct SDL_RWops *context)
 {
-	Data *data = GetData(context);
-	data->mpqArchive->CloseBlockOffsetTable(data->fileNumber);
-	delete data;
+	delete GetData(context);
 	delete context;
 	return 0;
 }
@@ -154,7 +168,7 @@ static int MpqFileRwClose(struct SDL_RWops *context)
 
 } // namespace
 
-SDL_RWops *SDL_RWops_FromMpqFile(MpqArchive &mpqArchive, uint32_t fileNumber, std::string_view filename, bool threadsafe)
+SDL_RWops *SDL_RWops_FromMpqFile(MpqArchive &mpqArchive, uint32_t fileNumber, std::string_view filename)
 {
 	auto result = std::make_unique<SDL_RWops>();
 	std::memset(result.get(), 0, sizeof(*result));
@@ -174,57 +188,21 @@ SDL_RWops *SDL_RWops_FromMpqFile(MpqArchive &mpqArchive, uint32_t fileNumber, st
 	auto data = std::make_unique<Data>();
 	int32_t error = 0;
 
-	if (threadsafe) {
-		data->ownedArchive = mpqArchive.Clone(error);
-		if (error != 0) {
-			SDL_SetError("MpqFileRwRead Clone: %s", MpqArchive::ErrorMessage(error));
-			return nullptr;
-		}
-		data->mpqArchive = &*data->ownedArchive;
-	} else {
-		data->mpqArchive = &mpqArchive;
-	}
-	data->fileNumber = fileNumber;
-	MpqArchive &archive = *data->mpqArchive;
-
-	error = archive.OpenBlockOffsetTable(fileNumber, filename);
-	if (error != 0) {
-		SDL_SetError("MpqFileRwRead OpenBlockOffsetTable: %s", MpqArchive::ErrorMessage(error));
-		return nullptr;
-	}
-
-	data->size = archive.GetUnpackedFileSize(fileNumber, error);
-	if (error != 0) {
-		SDL_SetError("MpqFileRwRead GetUnpackedFileSize: %s", MpqArchive::ErrorMessage(error));
+	// Each SDL_RWops has its own reader, so it can be used on any thread.
+	data->reader = mpqArchive.OpenFile(fileNumber, filename, error);
+	if (!data->reader) {
+		SDL_SetError("MpqFileRwRead OpenFile: %s", MpqArchive::ErrorMessage(error));
 		return nullptr;
 	}
+	MpqFileReader &reader = *data->reader;
 
-	const std::uint32_t numBlocks = archive.GetNumBlocks(fileNumber, error);
-	if (error != 0) {
-		SDL_SetError("MpqFileRwRead GetNumBlocks: %s", MpqArchive::ErrorMessage(error));
-		return nullptr;
-	}
-	data->numBlocks = numBlocks;
-
-	const size_t blockSize = archive.GetBlockSize(fileNumber, 0, error);
-	if (error != 0) {
-		SDL_SetError("MpqFileRwRead GetBlockSize: %s", MpqArchive::ErrorMessage(error));
-		return nullptr;
-	}
-	data->blockSize = blockSize;
-
-	if (numBlocks > 1) {
-		data->lastBlockSize = archive.GetBlockSize(fileNumber, numBlocks - 1, error);
-		if (error != 0) {
-			SDL_SetError("MpqFileRwRead GetBlockSize: %s", MpqArchive::ErrorMessage(error));
-			return nullptr;
-		}
-	} else {
-		data->lastBlockSize = blockSize;
-	}
+	data->size = reader.size();
+	data->numBlocks = reader.numBlocks();
+	data->blockSize = reader.blockSize(0);
+	data->lastBlockSize = reader.numBlocks() > 1 ? reader.blockSize(reader.numBlocks() - 1) : data->blockSize;
 
+	data->cacheBlocks = mpq_block_cache::IsCacheable(data->size);
 	data->position = 0;
-	data->blockRead = false;
 
 	SetData(result.get(), data.release());
 	return result.release();
@@ -638,6 +638,9 @@ bool multi_handle_delta()
 			shareNextHighPriorityMessage = true;
 		}
 	}
+	// Send this tick's turn and messages together to players that support batching
+	if (!SNetFlush())
+		nthread_terminate_game("SNetFlush");
 	MonsterSeeds();
 
 	return true;
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "msg.h"
+#include "multi_defs.hpp"
 #include "utils/attributes.h"
 
 namespace devilution {
@@ -17,9 +18,6 @@ namespace devilution {
 // Defined in player.h, forward declared here to allow for functions which operate in the context of a player.
 struct Player;
 
-// must be unsigned to generate unsigned comparisons with pnum
-#define MAX_PLRS 4
-
 struct GameData {
 	int32_t size;
 	uint8_t reserved[4];
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace devilution {
+
+// must be unsigned to generate unsigned comparisons with pnum
+#define MAX_PLRS 4
+
+#define LEAVE_ENDING 0x40000004
+#define LEAVE_DROP 0x40000006
+#define LEAVE_NO_GAME 0x40000007
+
+} // namespace devilution
@@ -54,6 +54,8 @@ void NthreadHandler()
 			break;
 		}
 		nthread_send_and_recv_turn(0, 0);
+		if (!SNetFlush())
+			nthread_terminate_game("SNetFlush");
 		int delta = gnTickDelay;
 		if (nthread_recv_turns())
 			delta = last_tick - SDL_GetTicks();
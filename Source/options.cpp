@@ -217,6 +217,7 @@ void LoadOptions()
 
 	ini->getUtf8Buf("Hellfire", "SItem", options.Hellfire.szItem, sizeof(options.Hellfire.szItem));
 	ini->getUtf8Buf("Network", "Bind Address", "0.0.0.0", options.Network.szBindAddress, sizeof(options.Network.szBindAddress));
+	ini->getUtf8Buf("Network", "Dedicated Server", options.Network.szDedicatedServer, sizeof(options.Network.szDedicatedServer));
 	ini->getUtf8Buf("Network", "Previous Game ID", options.Network.szPreviousZTGame, sizeof(options.Network.szPreviousZTGame));
 	ini->getUtf8Buf("Network", "Previous Host", options.Network.szPreviousHost, sizeof(options.Network.szPreviousHost));
 
@@ -249,6 +250,7 @@ void SaveOptions()
 	ini->set("Hellfire", "SItem", options.Hellfire.szItem);
 
 	ini->set("Network", "Bind Address", options.Network.szBindAddress);
+	ini->set("Network", "Dedicated Server", options.Network.szDedicatedServer);
 	ini->set("Network", "Previous Game ID", options.Network.szPreviousZTGame);
 	ini->set("Network", "Previous Host", options.Network.szPreviousHost);
 
@@ -818,6 +820,7 @@ GameplayOptions::GameplayOptions()
               { FloatingNumbers::Vertical, N_("Vertical Only") },
           })
     , skipLoadingScreenThresholdMs("Skip loading screen threshold, ms", OptionEntryFlags::Invisible, "", "", 0)
+    , packPathfinding("Pack Pathfinding", OptionEntryFlags::Invisible, "", "", false)
 {
 }
 
@@ -865,6 +868,7 @@ std::vector<OptionEntryBase *> GameplayOptions::GetEntries()
 		&grabInput,
 		&pauseOnFocusLoss,
 		&skipLoadingScreenThresholdMs,
+		&packPathfinding,
 	};
 }
 
@@ -880,12 +884,14 @@ std::vector<OptionEntryBase *> ControllerOptions::GetEntries()
 NetworkOptions::NetworkOptions()
     : OptionCategoryBase("Network", N_("Network"), N_("Network Settings"))
     , port("Port", OptionEntryFlags::Invisible, "Port", "What network port to use.", 6112)
+    , batchTurns("Batch Turns", OptionEntryFlags::Invisible, "Batch Turns", "Send each game tick's turn and messages in a single packet.", true)
 {
 }
 std::vector<OptionEntryBase *> NetworkOptions::GetEntries()
 {
 	return {
 		&port,
+		&batchTurns,
 	};
 }
 
@@ -637,6 +637,14 @@ struct GameplayOptions : OptionCategoryBase {
 	 * Advanced option, not displayed in the UI.
 	 */
 	OptionEntryInt<int> skipLoadingScreenThresholdMs;
+
+	/**
+	 * @brief Monsters chasing the same target share one path search per game tick.
+	 *
+	 * Paths can differ from the original game, so this only applies to single player games that aren't demos.
+	 * Advanced option, not displayed in the UI.
+	 */
+	OptionEntryBoolean packPathfinding;
 };
 
 struct ControllerOptions : OptionCategoryBase {
@@ -659,12 +667,20 @@ struct NetworkOptions : OptionCategoryBase {
 
 	/** @brief Optionally bind to a specific network interface. */
 	char szBindAddress[129];
+	/** @brief Create TCP games on this devilutionx-server instead of hosting them locally. */
+	char szDedicatedServer[129];
 	/** @brief Most recently entered ZeroTier Game ID. */
 	char szPreviousZTGame[129];
 	/** @brief Most recently entered Hostname in join dialog. */
 	char szPreviousHost[129];
 	/** @brief What network port to use. */
 	OptionEntryInt<uint16_t> port;
+	/**
+	 * @brief Send each game tick's turn and messages in a single packet to players that support it.
+	 *
+	 * Only used when every other player supports it. Advanced option, not displayed in the UI.
+	 */
+	OptionEntryBoolean batchTurns;
 };
 
 struct ChatOptions : OptionCategoryBase {
@@ -0,0 +1,184 @@
+/**
+ * @file server/main.cpp
+ *
+ * Headless relay server for TCP games.
+ *
+ * Runs the same `tcp_server` that a hosting client embeds, but on its own `io_context`,
+ * so relaying does not depend on the frame rate of any player's game.
+ */
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dvlnet/tcp_server.h"
+
+#include <asio/signal_set.hpp>
+#include <asio/steady_timer.hpp>
+
+#include "dvlnet/packet.h"
+#include "utils/log.hpp"
+#include "utils/parse_int.hpp"
+
+namespace devilution {
+namespace net {
+namespace {
+
+struct ServerOptions {
+	std::string bindAddress = "0.0.0.0";
+	unsigned short port = 6112;
+	std::string password;
+	std::chrono::seconds statsInterval { 60 };
+	std::chrono::seconds echoInterval { 5 };
+};
+
+void PrintHelp()
+{
+	std::printf("%s", "Options:\n"
+	                  "    --help                    Print this message and exit\n"
+	                  "    --bind <address>          Address to listen on (default: 0.0.0.0)\n"
+	                  "    --port <port>             Port to listen on (default: 6112)\n"
+	                  "    --password <password>     Game password, empty for public games\n"
+	                  "    --stats-interval <secs>   How often to log connection stats, 0 to disable (default: 60)\n"
+	                  "    --echo-interval <secs>    How often to measure the round-trip time, 0 to disable (default: 5)\n");
+}
+
+[[noreturn]] void PrintHelpAndExit(int status)
+{
+	PrintHelp();
+	std::exit(status);
+}
+
+std::chrono::seconds ParseSeconds(std::string_view arg, std::string_view value)
+{
+	const ParseIntResult<int> seconds = ParseInt<int>(value, 0);
+	if (!seconds.has_value()) {
+		LogError("Invalid value for {}: {}", arg, value);
+		PrintHelpAndExit(1);
+	}
+	return std::chrono::seconds(*seconds);
+}
+
+ServerOptions ParseArgs(int argc, char **argv)
+{
+	ServerOptions options;
+	for (int i = 1; i < argc; i++) {
+		const std::string_view arg = argv[i];
+		if (arg == "-h" || arg == "--help")
+			PrintHelpAndExit(0);
+		if (i + 1 == argc) {
+			LogError("Missing value for {}", arg);
+			PrintHelpAndExit(1);
+		}
+		const std::string_view value = argv[++i];
+		if (arg == "--bind") {
+			options.bindAddress = std::string(value);
+		} else if (arg == "--port") {
+			const ParseIntResult<unsigned short> port = ParseInt<unsigned short>(value, 1);
+			if (!port.has_value()) {
+				LogError("Invalid port: {}", value);
+				PrintHelpAndExit(1);
+			}
+			options.port = *port;
+		} else if (arg == "--password") {
+			options.password = std::string(value);
+		} else if (arg == "--stats-interval") {
+			options.statsInterval = ParseSeconds(arg, value);
+		} else if (arg == "--echo-interval") {
+			options.echoInterval = ParseSeconds(arg, value);
+		} else {
+			LogError("Unknown option: {}", arg);
+			PrintHelpAndExit(1);
+		}
+	}
+	return options;
+}
+
+void LogConnectionStats(const tcp_server &server)
+{
+	const std::vector<connection_stats> stats = server.GetConnectionStats();
+	if (stats.empty()) {
+		Log("No players connected");
+		return;
+	}
+	for (const connection_stats &con : stats) {
+		if (con.echoReplies == 0) {
+			Log("Player {} ({}): {} packets in, {} packets out, {} bytes in, {} bytes out",
+			    con.plr, con.address, con.packetsReceived, con.packetsSent, con.bytesReceived, con.bytesSent);
+		} else {
+			Log("Player {} ({}): {} packets in, {} packets out, {} bytes in, {} bytes out, round-trip {} ms (min {} / avg {} / max {})",
+			    con.plr, con.address, con.packetsReceived, con.packetsSent, con.bytesReceived, con.bytesSent,
+			    con.lastRoundTripMs, con.minRoundTripMs, con.totalRoundTripMs / con.echoReplies, con.maxRoundTripMs);
+		}
+	}
+}
+
+class StatsReporter {
+public:
+	StatsReporter(asio::io_context &ioc, tcp_server &server, std::chrono::seconds interval)
+	    : server_(server)
+	    , timer_(ioc)
+	    , interval_(interval)
+	{
+		Start();
+	}
+
+private:
+	void Start()
+	{
+		timer_.expires_after(std::chrono::seconds(1));
+		timer_.async_wait([this](const asio::error_code &ec) {
+			if (ec)
+				return;
+			if (tl::expected<void, PacketError> result = server_.CheckIoHandlerError(); !result.has_value())
+				LogError("Server error: {}", result.error().what());
+			if (interval_.count() > 0 && ++elapsed_ >= interval_.count()) {
+				elapsed_ = 0;
+				LogConnectionStats(server_);
+			}
+			Start();
+		});
+	}
+
+	tcp_server &server_;
+	asio::steady_timer timer_;
+	std::chrono::seconds interval_;
+	int64_t elapsed_ = 0;
+};
+
+int RunServer(const ServerOptions &options)
+{
+	packet_factory pktfty(options.password);
+	asio::io_context ioc;
+	tcp_server server(ioc, options.bindAddress, options.port, pktfty);
+	if (options.echoInterval.count() > 0)
+		server.EnableEchoRequests(options.echoInterval);
+	StatsReporter reporter(ioc, server, options.statsInterval);
+
+	asio::signal_set signals(ioc, SIGINT, SIGTERM);
+	signals.async_wait([&](const asio::error_code &ec, int signal) {
+		if (ec)
+			return;
+		Log("Received signal {}, shutting down", signal);
+		server.Close();
+		ioc.stop();
+	});
+
+	Log("Listening on {}:{}", options.bindAddress, options.port);
+	ioc.run();
+	return 0;
+}
+
+} // namespace
+} // namespace net
+} // namespace devilution
+
+int main(int argc, char **argv)
+{
+	const devilution::net::ServerOptions options = devilution::net::ParseArgs(argc, argv);
+	return devilution::net::RunServer(options);
+}
@@ -0,0 +1,34 @@
+/**
+ * @file server/server_support.cpp
+ *
+ * Fatal error handlers for headless tools that do not link the game's UI.
+ */
+#include <cstdlib>
+#include <string_view>
+
+#include "appfat.h"
+#include "utils/log.hpp"
+
+namespace devilution {
+
+[[noreturn]] void app_fatal(std::string_view str)
+{
+	LogCritical("{}", str);
+	std::exit(1);
+}
+
+[[noreturn]] void ErrDlg(const char *title, std::string_view error, std::string_view logFilePath, int logLineNr)
+{
+	LogCritical("{}: {}\n{}:{}", title, error, logFilePath, logLineNr);
+	std::exit(1);
+}
+
+#ifdef _DEBUG
+[[noreturn]] void assert_fail(int nLineNo, const char *pszFile, const char *pszFail)
+{
+	LogCritical("Assertion failed in {}:{}: {}", pszFile, nLineNo, pszFail);
+	std::abort();
+}
+#endif
+
+} // namespace devilution
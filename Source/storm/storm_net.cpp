@@ -193,6 +193,14 @@ bool SNetGetTurnsInTransit(uint32_t *turns)
 	return dvlnet_inst->SNetGetTurnsInTransit(turns);
 }
 
+bool SNetFlush()
+{
+#ifndef NONET
+	std::lock_guard<SdlMutex> lg(storm_net_mutex);
+#endif
+	return dvlnet_inst->SNetFlush();
+}
+
 /**
  * @brief engine calls this only once with argument 1
  */
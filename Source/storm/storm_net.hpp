@@ -46,9 +46,6 @@ struct _SNETEVENT {
 #define PS_TURN_ARRIVED 0x20000
 #define PS_ACTIVE 0x40000
 
-#define LEAVE_ENDING 0x40000004
-#define LEAVE_DROP 0x40000006
-
 bool SNetCreateGame(const char *pszGameName, const char *pszGamePassword, char *GameTemplateData, int GameTemplateSize, int *playerID);
 bool SNetDestroy();
 
@@ -125,6 +122,14 @@ constexpr uint8_t SNPLAYER_OTHERS = 0xFF;
  */
 bool SNetSendTurn(char *data, size_t databytes);
 
+/**
+ * @brief Sends the turns and messages that were held back to be batched.
+ *
+ * Called once per game tick, so that peers which support batching receive
+ * everything sent during the tick in a single packet.
+ */
+bool SNetFlush();
+
 bool SNetGetOwnerTurnsWaiting(uint32_t *);
 bool SNetUnregisterEventHandler(event_type);
 bool SNetRegisterEventHandler(event_type, SEVTHANDLER);
@@ -237,6 +237,8 @@ bool BlitFrame()
 		}
 	}
 
+	// The frame was written to the output surface directly.
+	InvalidateOutputTexture();
 	RenderPresent();
 	return true;
 }
@@ -307,6 +309,7 @@ bool SVidPlayBegin(const char *filename, int flags)
 		const int renderWidth = static_cast<int>(SVidWidth);
 		const int renderHeight = static_cast<int>(SVidHeight);
 		texture = SDLWrap::CreateTexture(renderer, DEVILUTIONX_DISPLAY_TEXTURE_FORMAT, SDL_TEXTUREACCESS_STREAMING, renderWidth, renderHeight);
+		InvalidateOutputTexture();
 		if (SDL_RenderSetLogicalSize(renderer, renderWidth, renderHeight) <= -1) {
 			ErrSdl();
 		}
@@ -401,6 +404,7 @@ void SVidPlayEnd()
 #ifndef USE_SDL1
 	if (renderer != nullptr) {
 		texture = SDLWrap::CreateTexture(renderer, DEVILUTIONX_DISPLAY_TEXTURE_FORMAT, SDL_TEXTUREACCESS_STREAMING, gnScreenWidth, gnScreenHeight);
+		InvalidateOutputTexture();
 		if (renderer != nullptr && SDL_RenderSetLogicalSize(renderer, gnScreenWidth, gnScreenHeight) <= -1) {
 			ErrSdl();
 		}
@@ -1,22 +1,29 @@
 #pragma once
 
 #include <cstdint>
-#include <cstring>
-
-#include <SDL_endian.h>
 
 namespace devilution {
 
 inline void WriteLE16(void *out, uint16_t val)
 {
-	const uint16_t littleEndian = SDL_SwapLE16(val);
-	memcpy(out, &littleEndian, 2);
+	auto *b = static_cast<uint8_t *>(out);
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	b[0] = static_cast<uint8_t>(val);
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	b[1] = static_cast<uint8_t>(val >> 8);
 }
 
 inline void WriteLE32(void *out, uint32_t val)
 {
-	const uint32_t littleEndian = SDL_SwapLE32(val);
-	memcpy(out, &littleEndian, 4);
+	auto *b = static_cast<uint8_t *>(out);
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	b[0] = static_cast<uint8_t>(val);
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	b[1] = static_cast<uint8_t>(val >> 8);
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	b[2] = static_cast<uint8_t>(val >> 16);
+	// NOLINTNEXTLINE(readability-magic-numbers)
+	b[3] = static_cast<uint8_t>(val >> 24);
 }
 
 } // namespace devilution
@@ -2,47 +2,47 @@
 
 #include <string_view>
 
-#include <SDL.h>
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
 
 #include "utils/str_cat.hpp"
 
-#ifdef USE_SDL1
-#include "utils/sdl2_to_1_2_backports.h"
-#endif
-
 namespace devilution {
 
 // Local definition to fix compilation issue due to header conflict.
 [[noreturn]] extern void app_fatal(std::string_view);
 
+// The values match SDL's log categories and priorities.
 enum class LogCategory {
-	Application = SDL_LOG_CATEGORY_APPLICATION,
-	Error = SDL_LOG_CATEGORY_ERROR,
-	Assert = SDL_LOG_CATEGORY_ASSERT,
-	System = SDL_LOG_CATEGORY_SYSTEM,
-	Audio = SDL_LOG_CATEGORY_AUDIO,
-	Video = SDL_LOG_CATEGORY_VIDEO,
-	Render = SDL_LOG_CATEGORY_RENDER,
-	Input = SDL_LOG_CATEGORY_INPUT,
-	Test = SDL_LOG_CATEGORY_TEST,
+	Application = 0,
+	Error = 1,
+	Assert = 2,
+	System = 3,
+	Audio = 4,
+	Video = 5,
+	Render = 6,
+	Input = 7,
+	Test = 8,
 };
 
 constexpr auto defaultCategory = LogCategory::Application;
 
 enum class LogPriority {
-	Verbose = SDL_LOG_PRIORITY_VERBOSE,
-	Debug = SDL_LOG_PRIORITY_DEBUG,
-	Info = SDL_LOG_PRIORITY_INFO,
-	Warn = SDL_LOG_PRIORITY_WARN,
-	Error = SDL_LOG_PRIORITY_ERROR,
-	Critical = SDL_LOG_PRIORITY_CRITICAL,
+	Verbose = 1,
+	Debug = 2,
+	Info = 3,
+	Warn = 4,
+	Error = 5,
+	Critical = 6,
 };
 
 namespace detail {
 
+// Implemented by the log backend: SDL for the game (log_sdl.cpp), stdio for tools without SDL (log_stdio.cpp).
+void LogMessage(LogCategory category, LogPriority priority, std::string_view str);
+LogPriority GetLogPriority(LogCategory category);
+
 template <typename... Args>
 std::string format(std::string_view fmt, Args &&...args)
 {
@@ -56,7 +56,7 @@ std::string format(std::string_view fmt, Args &&...args)
 		// e.what() is undefined if exceptions are disabled, so we wrap the whole block
 		// with an `FMT_EXCEPTIONS` check.
 		std::string error = StrCat("Format error, fmt: ", fmt, " error: ", e.what());
-		SDL_LogCritical(SDL_LOG_CATEGORY_APPLICATION, "%s", error.c_str());
+		LogMessage(LogCategory::Application, LogPriority::Critical, error);
 		app_fatal(error);
 #endif
 	}
@@ -66,27 +66,27 @@ std::string format(std::string_view fmt, Args &&...args)
 
 inline void Log(std::string_view str)
 {
-	SDL_Log("%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(defaultCategory, LogPriority::Info, str);
 }
 
 template <typename... Args>
 void Log(std::string_view fmt, Args &&...args)
 {
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_Log("%s", str.c_str());
+	detail::LogMessage(defaultCategory, LogPriority::Info, str);
 }
 
 inline void LogVerbose(LogCategory category, std::string_view str)
 {
-	SDL_LogVerbose(static_cast<int>(category), "%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(category, LogPriority::Verbose, str);
 }
 
 template <typename... Args>
 void LogVerbose(LogCategory category, std::string_view fmt, Args &&...args)
 {
-	if (SDL_LogGetPriority(static_cast<int>(category)) > SDL_LOG_PRIORITY_VERBOSE) return;
+	if (detail::GetLogPriority(category) > LogPriority::Verbose) return;
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_LogVerbose(static_cast<int>(category), "%s", str.c_str());
+	detail::LogMessage(category, LogPriority::Verbose, str);
 }
 
 template <typename... Args>
@@ -97,15 +97,15 @@ void LogVerbose(std::string_view fmt, Args &&...args)
 
 inline void LogDebug(LogCategory category, std::string_view str)
 {
-	SDL_LogDebug(static_cast<int>(category), "%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(category, LogPriority::Debug, str);
 }
 
 template <typename... Args>
 void LogDebug(LogCategory category, std::string_view fmt, Args &&...args)
 {
-	if (SDL_LogGetPriority(static_cast<int>(category)) > SDL_LOG_PRIORITY_DEBUG) return;
+	if (detail::GetLogPriority(category) > LogPriority::Debug) return;
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_LogDebug(static_cast<int>(category), "%s", str.c_str());
+	detail::LogMessage(category, LogPriority::Debug, str);
 }
 
 template <typename... Args>
@@ -116,14 +116,14 @@ void LogDebug(std::string_view fmt, Args &&...args)
 
 inline void LogInfo(LogCategory category, std::string_view str)
 {
-	SDL_LogInfo(static_cast<int>(category), "%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(category, LogPriority::Info, str);
 }
 
 template <typename... Args>
 void LogInfo(LogCategory category, std::string_view fmt, Args &&...args)
 {
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_LogInfo(static_cast<int>(category), "%s", str.c_str());
+	detail::LogMessage(category, LogPriority::Info, str);
 }
 
 template <typename... Args>
@@ -134,14 +134,14 @@ void LogInfo(std::string_view fmt, Args &&...args)
 
 inline void LogWarn(LogCategory category, std::string_view str)
 {
-	SDL_LogWarn(static_cast<int>(category), "%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(category, LogPriority::Warn, str);
 }
 
 template <typename... Args>
 void LogWarn(LogCategory category, std::string_view fmt, Args &&...args)
 {
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_LogWarn(static_cast<int>(category), "%s", str.c_str());
+	detail::LogMessage(category, LogPriority::Warn, str);
 }
 
 template <typename... Args>
@@ -152,14 +152,14 @@ void LogWarn(std::string_view fmt, Args &&...args)
 
 inline void LogError(LogCategory category, std::string_view str)
 {
-	SDL_LogError(static_cast<int>(category), "%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(category, LogPriority::Error, str);
 }
 
 template <typename... Args>
 void LogError(LogCategory category, std::string_view fmt, Args &&...args)
 {
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_LogError(static_cast<int>(category), "%s", str.c_str());
+	detail::LogMessage(category, LogPriority::Error, str);
 }
 
 template <typename... Args>
@@ -170,14 +170,14 @@ void LogError(std::string_view fmt, Args &&...args)
 
 inline void LogCritical(LogCategory category, std::string_view str)
 {
-	SDL_LogCritical(static_cast<int>(category), "%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(category, LogPriority::Critical, str);
 }
 
 template <typename... Args>
 void LogCritical(LogCategory category, std::string_view fmt, Args &&...args)
 {
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_LogCritical(static_cast<int>(category), "%s", str.c_str());
+	detail::LogMessage(category, LogPriority::Critical, str);
 }
 
 template <typename... Args>
@@ -188,15 +188,14 @@ void LogCritical(std::string_view fmt, Args &&...args)
 
 inline void LogMessageV(LogCategory category, LogPriority priority, std::string_view str)
 {
-	SDL_LogMessage(static_cast<int>(category), static_cast<SDL_LogPriority>(priority),
-	    "%.*s", static_cast<int>(str.size()), str.data());
+	detail::LogMessage(category, priority, str);
 }
 
 template <typename... Args>
 void LogMessageV(LogCategory category, LogPriority priority, std::string_view fmt, Args &&...args)
 {
 	auto str = detail::format(fmt, std::forward<Args>(args)...);
-	SDL_LogMessageV(static_cast<int>(category), static_cast<SDL_LogPriority>(priority), "%s", str.c_str());
+	detail::LogMessage(category, priority, str);
 }
 
 template <typename... Args>
@@ -0,0 +1,27 @@
+#include "utils/log.hpp"
+
+#include <SDL.h>
+
+#ifdef USE_SDL1
+#include "utils/sdl2_to_1_2_backports.h"
+#endif
+
+namespace devilution::detail {
+
+static_assert(static_cast<int>(LogCategory::Application) == SDL_LOG_CATEGORY_APPLICATION);
+static_assert(static_cast<int>(LogCategory::Test) == SDL_LOG_CATEGORY_TEST);
+static_assert(static_cast<int>(LogPriority::Verbose) == SDL_LOG_PRIORITY_VERBOSE);
+static_assert(static_cast<int>(LogPriority::Critical) == SDL_LOG_PRIORITY_CRITICAL);
+
+void LogMessage(LogCategory category, LogPriority priority, std::string_view str)
+{
+	SDL_LogMessage(static_cast<int>(category), static_cast<SDL_LogPriority>(priority),
+	    "%.*s", static_cast<int>(str.size()), str.data());
+}
+
+LogPriority GetLogPriority(LogCategory category)
+{
+	return static_cast<LogPriority>(SDL_LogGetPriority(static_cast<int>(category)));
+}
+
+} // namespace devilution::detail
@@ -0,0 +1,43 @@
+#include "utils/log.hpp"
+
+#include <cstdio>
+
+namespace devilution::detail {
+
+namespace {
+
+const char *PriorityPrefix(LogPriority priority)
+{
+	switch (priority) {
+	case LogPriority::Verbose:
+		return "VERBOSE";
+	case LogPriority::Debug:
+		return "DEBUG";
+	case LogPriority::Info:
+		return "INFO";
+	case LogPriority::Warn:
+		return "WARN";
+	case LogPriority::Error:
+		return "ERROR";
+	case LogPriority::Critical:
+		return "CRITICAL";
+	}
+	return "";
+}
+
+} // namespace
+
+void LogMessage(LogCategory category, LogPriority priority, std::string_view str)
+{
+	if (priority < GetLogPriority(category))
+		return;
+	std::fprintf(stderr, "%s: %.*s\n", PriorityPrefix(priority), static_cast<int>(str.size()), str.data());
+	std::fflush(stderr);
+}
+
+LogPriority GetLogPriority(LogCategory category)
+{
+	return LogPriority::Info;
+}
+
+} // namespace devilution::detail
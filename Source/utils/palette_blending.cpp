@@ -1,8 +1,12 @@
 #include "utils/palette_blending.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <limits>
+#include <memory>
 
 #include <SDL.h>
 
@@ -23,6 +27,36 @@ namespace {
 
 PaletteKdTree CurrentPaletteKdTree;
 
+#if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
+/** Range of colors whose entries in `paletteTransparencyLookupBlack16` are out of date, empty if `StaleBlack16From > StaleBlack16To`. */
+unsigned StaleBlack16From = 256;
+unsigned StaleBlack16To = 0;
+#endif
+
+/** Number of threads used to generate the lookup table, 0 for as many as there are CPU cores. */
+unsigned BlendedLookupTableThreadCount = 0;
+
+/** Never use more threads than this, the table is too small to benefit. */
+constexpr unsigned MaxBlendedLookupTableThreads = 4;
+
+/**
+ * @brief Recently generated lookup tables.
+ *
+ * Palettes are only switched on level changes, so going back and forth between two levels
+ * (e.g. town and the dungeon) can reuse the table instead of generating it again.
+ */
+struct BlendedLookupTableCacheEntry {
+	std::array<uint8_t, 256 * 3> palette;
+	int skipFrom;
+	int skipTo;
+	uint32_t lastUsed = 0;
+	std::unique_ptr<uint8_t[]> table;
+};
+
+constexpr size_t BlendedLookupTableCacheSize = 3;
+std::array<BlendedLookupTableCacheEntry, BlendedLookupTableCacheSize> BlendedLookupTableCache;
+uint32_t BlendedLookupTableCacheClock = 0;
+
 using RGB = std::array<uint8_t, 3>;
 
 RGB BlendColors(const SDL_Color &a, const SDL_Color &b)
@@ -41,24 +75,116 @@ void SetPaletteTransparencyLookupBlack16(unsigned i, unsigned j)
 }
 #endif
 
-} // namespace
+std::array<uint8_t, 256 * 3> PaletteToRGB(const SDL_Color *palette)
+{
+	std::array<uint8_t, 256 * 3> result;
+	for (unsigned i = 0; i < 256; ++i) {
+		result[i * 3] = palette[i].r;
+		result[i * 3 + 1] = palette[i].g;
+		result[i * 3 + 2] = palette[i].b;
+	}
+	return result;
+}
 
-void GenerateBlendedLookupTable(const SDL_Color *palette, int skipFrom, int skipTo)
+/**
+ * @brief Computes the upper triangle of the rows `first`, `first + stride`, `first + 2 * stride`, ...
+ *
+ * Rows get shorter as `i` grows, so interleaving them keeps the work of each thread about the same.
+ */
+void ComputeBlendedRows(const SDL_Color *palette, unsigned first, unsigned stride)
 {
-	CurrentPaletteKdTree = PaletteKdTree { palette, skipFrom, skipTo };
-	for (unsigned i = 0; i < 256; i++) {
+	for (unsigned i = first; i < 256; i += stride) {
 		paletteTransparencyLookup[i][i] = i;
-		unsigned j = 0;
-		for (; j < i; j++) {
-			paletteTransparencyLookup[i][j] = paletteTransparencyLookup[j][i];
-		}
-		++j;
-		for (; j < 256; j++) {
+		for (unsigned j = i + 1; j < 256; j++) {
 			paletteTransparencyLookup[i][j] = CurrentPaletteKdTree.findNearestNeighbor(BlendColors(palette[i], palette[j]));
 		}
 	}
+}
+
+struct BlendedRowsJob {
+	const SDL_Color *palette;
+	unsigned first;
+	unsigned stride;
+};
+
+int SDLCALL BlendedRowsThread(void *data)
+{
+	const auto &job = *static_cast<const BlendedRowsJob *>(data);
+	ComputeBlendedRows(job.palette, job.first, job.stride);
+	return 0;
+}
+
+unsigned GetBlendedLookupTableThreadCount()
+{
+	if (BlendedLookupTableThreadCount != 0) return BlendedLookupTableThreadCount;
+	return std::clamp(static_cast<unsigned>(SDL_GetCPUCount()), 1U, MaxBlendedLookupTableThreads);
+}
+
+void ComputeBlendedLookupTable(const SDL_Color *palette)
+{
+	const unsigned numThreads = GetBlendedLookupTableThreadCount();
+	std::array<BlendedRowsJob, MaxBlendedLookupTableThreads> jobs;
+	std::array<SDL_Thread *, MaxBlendedLookupTableThreads> threads {};
+	for (unsigned t = 1; t < numThreads; ++t) {
+		jobs[t] = BlendedRowsJob { palette, t, numThreads };
+#ifdef USE_SDL1
+		threads[t] = SDL_CreateThread(BlendedRowsThread, &jobs[t]);
+#else
+		threads[t] = SDL_CreateThread(BlendedRowsThread, "blending", &jobs[t]);
+#endif
+		// If we fail to create a thread, do its work on this one.
+		if (threads[t] == nullptr) ComputeBlendedRows(palette, t, numThreads);
+	}
+	ComputeBlendedRows(palette, 0, numThreads);
+	for (unsigned t = 1; t < numThreads; ++t) {
+		if (threads[t] != nullptr) SDL_WaitThread(threads[t], nullptr);
+	}
+
+	for (unsigned i = 1; i < 256; i++) {
+		for (unsigned j = 0; j < i; j++) {
+			paletteTransparencyLookup[i][j] = paletteTransparencyLookup[j][i];
+		}
+	}
+}
+
+bool LoadBlendedLookupTableFromCache(const std::array<uint8_t, 256 * 3> &rgb, int skipFrom, int skipTo)
+{
+	for (BlendedLookupTableCacheEntry &entry : BlendedLookupTableCache) {
+		if (entry.table == nullptr || entry.skipFrom != skipFrom || entry.skipTo != skipTo || entry.palette != rgb) continue;
+		entry.lastUsed = ++BlendedLookupTableCacheClock;
+		std::memcpy(paletteTransparencyLookup, entry.table.get(), sizeof(paletteTransparencyLookup));
+		return true;
+	}
+	return false;
+}
+
+void StoreBlendedLookupTableInCache(const std::array<uint8_t, 256 * 3> &rgb, int skipFrom, int skipTo)
+{
+	BlendedLookupTableCacheEntry &entry = *std::min_element(BlendedLookupTableCache.begin(), BlendedLookupTableCache.end(),
+	    [](const BlendedLookupTableCacheEntry &a, const BlendedLookupTableCacheEntry &b) { return a.lastUsed < b.lastUsed; });
+	if (entry.table == nullptr) entry.table = std::make_unique<uint8_t[]>(sizeof(paletteTransparencyLookup));
+	entry.palette = rgb;
+	entry.skipFrom = skipFrom;
+	entry.skipTo = skipTo;
+	entry.lastUsed = ++BlendedLookupTableCacheClock;
+	std::memcpy(entry.table.get(), paletteTransparencyLookup, sizeof(paletteTransparencyLookup));
+}
+
+} // namespace
+
+void GenerateBlendedLookupTable(const SDL_Color *palette, int skipFrom, int skipTo)
+{
+	CurrentPaletteKdTree = PaletteKdTree { palette, skipFrom, skipTo };
+
+	const std::array<uint8_t, 256 * 3> rgb = PaletteToRGB(palette);
+	if (!LoadBlendedLookupTableFromCache(rgb, skipFrom, skipTo)) {
+		ComputeBlendedLookupTable(palette);
+		StoreBlendedLookupTableInCache(rgb, skipFrom, skipTo);
+	}
 
 #if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
+	StaleBlack16From = 256;
+	StaleBlack16To = 0;
 	for (unsigned i = 0; i < 256; ++i) {
 		SetPaletteTransparencyLookupBlack16(i, i);
 		for (unsigned j = 0; j < i; ++j) {
@@ -69,6 +195,19 @@ void GenerateBlendedLookupTable(const SDL_Color *palette, int skipFrom, int skip
 #endif
 }
 
+void ClearBlendedLookupTableCache()
+{
+	for (BlendedLookupTableCacheEntry &entry : BlendedLookupTableCache) {
+		entry.table = nullptr;
+		entry.lastUsed = 0;
+	}
+}
+
+void SetBlendedLookupTableThreadCount(unsigned count)
+{
+	BlendedLookupTableThreadCount = std::min(count, MaxBlendedLookupTableThreads);
+}
+
 void UpdateBlendedLookupTableSingleColor(const SDL_Color *palette, unsigned i)
 {
 	for (unsigned j = 0; j < 256; j++) {
@@ -85,6 +224,23 @@ void UpdateBlendedLookupTableSingleColor(const SDL_Color *palette, unsigned i)
 #endif
 }
 
+void RotateBlendedLookupTable(unsigned from, unsigned middle, unsigned to)
+{
+	for (auto &row : paletteTransparencyLookup) {
+		std::rotate(std::begin(row) + from, std::begin(row) + middle, std::begin(row) + to + 1);
+	}
+	std::rotate(&paletteTransparencyLookup[from][0], &paletteTransparencyLookup[middle][0], &paletteTransparencyLookup[to + 1][0]);
+
+#if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
+	// The black LUT only depends on row 0, which moves as a whole if it is part of the range.
+	if (from == 0) {
+		InvalidateTransparencyLookupBlack16(0, 255);
+	} else {
+		InvalidateTransparencyLookupBlack16(from, to);
+	}
+#endif
+}
+
 #if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
 void UpdateTransparencyLookupBlack16(unsigned from, unsigned to)
 {
@@ -95,6 +251,20 @@ void UpdateTransparencyLookupBlack16(unsigned from, unsigned to)
 		}
 	}
 }
+
+void InvalidateTransparencyLookupBlack16(unsigned from, unsigned to)
+{
+	StaleBlack16From = std::min(StaleBlack16From, from);
+	StaleBlack16To = std::max(StaleBlack16To, to);
+}
+
+void RefreshTransparencyLookupBlack16()
+{
+	if (StaleBlack16From > StaleBlack16To) return;
+	UpdateTransparencyLookupBlack16(StaleBlack16From, StaleBlack16To);
+	StaleBlack16From = 256;
+	StaleBlack16To = 0;
+}
 #endif
 
 } // namespace devilution
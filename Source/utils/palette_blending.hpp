@@ -24,11 +24,31 @@ extern uint8_t paletteTransparencyLookup[256][256];
  */
 void GenerateBlendedLookupTable(const SDL_Color *palette, int skipFrom = -1, int skipTo = -1);
 
+/**
+ * @brief Drops the tables remembered by `GenerateBlendedLookupTable`.
+ *
+ * The last few generated tables are kept, so that switching back to a palette does not generate its table again.
+ */
+void ClearBlendedLookupTableCache();
+
+/**
+ * @brief Sets the number of threads `GenerateBlendedLookupTable` uses, 0 to use one per CPU core.
+ */
+void SetBlendedLookupTableThreadCount(unsigned count);
+
 /**
  * @brief Updates the transparency lookup table for a single color.
  */
 void UpdateBlendedLookupTableSingleColor(const SDL_Color *palette, unsigned i);
 
+/**
+ * @brief Rotates the colors `from..to` in `paletteTransparencyLookup` the same way as `std::rotate`,
+ * so that color `middle` becomes color `from`.
+ *
+ * Used for palette cycling. Only the cycled rows and the cycled part of each row are moved.
+ */
+void RotateBlendedLookupTable(unsigned from, unsigned middle, unsigned to);
+
 #if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
 /**
  * A lookup table from black for a pair of colors in `logical_palette`.
@@ -42,6 +62,20 @@ void UpdateBlendedLookupTableSingleColor(const SDL_Color *palette, unsigned i);
 extern uint16_t paletteTransparencyLookupBlack16[65536];
 
 void UpdateTransparencyLookupBlack16(unsigned from, unsigned to);
+
+/**
+ * @brief Marks the entries for colors `from..to` as out of date.
+ *
+ * They are recomputed by the next call to `RefreshTransparencyLookupBlack16`.
+ */
+void InvalidateTransparencyLookupBlack16(unsigned from, unsigned to);
+
+/**
+ * @brief Recomputes the out of date entries of `paletteTransparencyLookupBlack16`.
+ *
+ * Must be called before reading the table.
+ */
+void RefreshTransparencyLookupBlack16();
 #endif
 
 } // namespace devilution
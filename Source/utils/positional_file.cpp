@@ -0,0 +1,130 @@
+#include "utils/positional_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "utils/file_util.h"
+#include "utils/sdl_mutex.h"
+
+#if defined(DVL_POSITIONAL_FILE_WIN32)
+// Suppress definitions of `min` and `max` macros by <windows.h>:
+#define NOMINMAX 1
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(DVL_POSITIONAL_FILE_PREAD)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace devilution {
+
+PositionalFile::PositionalFile(PositionalFile &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+PositionalFile &PositionalFile::operator=(PositionalFile &&other) noexcept
+{
+	Close();
+#if defined(DVL_POSITIONAL_FILE_WIN32)
+	handle_ = std::exchange(other.handle_, nullptr);
+#elif defined(DVL_POSITIONAL_FILE_PREAD)
+	fd_ = std::exchange(other.fd_, -1);
+#else
+	file_ = std::exchange(other.file_, nullptr);
+	mutex_ = std::move(other.mutex_);
+#endif
+	return *this;
+}
+
+PositionalFile::~PositionalFile()
+{
+	Close();
+}
+
+bool PositionalFile::Open(const char *path)
+{
+	Close();
+#if defined(DVL_POSITIONAL_FILE_WIN32)
+	const std::unique_ptr<wchar_t[]> pathUtf16 = ToWideChar(path);
+	if (pathUtf16 == nullptr)
+		return false;
+	HANDLE handle = ::CreateFileW(pathUtf16.get(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false;
+	handle_ = handle;
+#elif defined(DVL_POSITIONAL_FILE_PREAD)
+	fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+#else
+	file_ = OpenFile(path, "rb");
+	if (file_ != nullptr && mutex_ == nullptr)
+		mutex_ = std::make_unique<SdlMutex>();
+#endif
+	return IsOpen();
+}
+
+void PositionalFile::Close()
+{
+#if defined(DVL_POSITIONAL_FILE_WIN32)
+	if (handle_ != nullptr)
+		::CloseHandle(std::exchange(handle_, nullptr));
+#elif defined(DVL_POSITIONAL_FILE_PREAD)
+	if (fd_ != -1)
+		::close(std::exchange(fd_, -1));
+#else
+	if (file_ != nullptr)
+		std::fclose(std::exchange(file_, nullptr));
+#endif
+}
+
+bool PositionalFile::IsOpen() const
+{
+#if defined(DVL_POSITIONAL_FILE_WIN32)
+	return handle_ != nullptr;
+#elif defined(DVL_POSITIONAL_FILE_PREAD)
+	return fd_ != -1;
+#else
+	return file_ != nullptr;
+#endif
+}
+
+bool PositionalFile::ReadAt(std::uint64_t offset, void *out, std::size_t size) const
+{
+	auto *dst = static_cast<std::byte *>(out);
+#if defined(DVL_POSITIONAL_FILE_WIN32)
+	while (size > 0) {
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		DWORD numRead;
+		const DWORD toRead = size > MAXDWORD ? MAXDWORD : static_cast<DWORD>(size);
+		if (!::ReadFile(handle_, dst, toRead, &numRead, &overlapped) || numRead == 0)
+			return false;
+		dst += numRead;
+		offset += numRead;
+		size -= numRead;
+	}
+	return true;
+#elif defined(DVL_POSITIONAL_FILE_PREAD)
+	while (size > 0) {
+		const ssize_t numRead = ::pread(fd_, dst, size, static_cast<off_t>(offset));
+		if (numRead <= 0)
+			return false;
+		dst += numRead;
+		offset += static_cast<std::uint64_t>(numRead);
+		size -= static_cast<std::size_t>(numRead);
+	}
+	return true;
+#else
+	const std::lock_guard<SdlMutex> lock(*mutex_);
+	if (std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0)
+		return false;
+	return std::fread(dst, 1, size, file_) == size;
+#endif
+}
+
+} // namespace devilution
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#if defined(_WIN32) && !defined(__UWP__) && !defined(NXDK) && !defined(DEVILUTIONX_WINDOWS_NO_WCHAR)
+#define DVL_POSITIONAL_FILE_WIN32
+#elif defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__HAIKU__)
+#define DVL_POSITIONAL_FILE_PREAD
+#endif
+
+namespace devilution {
+
+class SdlMutex;
+
+/**
+ * @brief A read-only file that supports reading at a given offset from several threads at the same time.
+ *
+ * Uses `pread` on POSIX systems and overlapped `ReadFile` on Windows.
+ * Elsewhere, falls back to `fseek` + `fread` under a mutex.
+ */
+class PositionalFile {
+public:
+	PositionalFile() = default;
+	PositionalFile(PositionalFile &&other) noexcept;
+	PositionalFile &operator=(PositionalFile &&other) noexcept;
+	PositionalFile(const PositionalFile &) = delete;
+	PositionalFile &operator=(const PositionalFile &) = delete;
+	~PositionalFile();
+
+	bool Open(const char *path);
+	void Close();
+
+	[[nodiscard]] bool IsOpen() const;
+
+	/** @brief Reads exactly `size` bytes at `offset`. Returns false on error or a short read. */
+	bool ReadAt(std::uint64_t offset, void *out, std::size_t size) const;
+
+private:
+#if defined(DVL_POSITIONAL_FILE_WIN32)
+	void *handle_ = nullptr;
+#elif defined(DVL_POSITIONAL_FILE_PREAD)
+	int fd_ = -1;
+#else
+	std::FILE *file_ = nullptr;
+	std::unique_ptr<SdlMutex> mutex_;
+#endif
+};
+
+} // namespace devilution
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "appfat.h"
+
+namespace devilution {
+
+/**
+ * @brief A pool of objects with stable addresses and handles.
+ *
+ * Objects are stored in fixed-size chunks that are never moved, so pointers and references
+ * to an element remain valid until the element is removed.
+ * The slots of removed elements are reused for new elements.
+ *
+ * Iteration visits the elements in the order they were added, like `std::list`.
+ * Elements added during iteration are visited by the same loop.
+ *
+ * @tparam T element type.
+ * @tparam ChunkSize number of elements per chunk.
+ */
+template <class T, size_t ChunkSize = 256>
+class SlotMap {
+	template <bool IsConst>
+	class Iterator;
+
+public:
+	using value_type = T;
+	using reference = T &;
+	using const_reference = const T &;
+	using size_type = size_t;
+	using iterator = Iterator</*IsConst=*/false>;
+	using const_iterator = Iterator</*IsConst=*/true>;
+
+	/**
+	 * @brief Refers to an element, or to nothing if the element has been removed.
+	 */
+	struct Handle {
+		static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+		uint32_t index = InvalidIndex;
+		uint32_t generation = 0;
+
+		bool operator==(const Handle &other) const = default;
+	};
+
+	SlotMap() = default;
+	SlotMap(const SlotMap &) = delete;
+	SlotMap &operator=(const SlotMap &) = delete;
+
+	~SlotMap()
+	{
+		for (const uint32_t index : order_) {
+			std::destroy_at(slot(index));
+		}
+	}
+
+	[[nodiscard]] iterator begin() { return iterator { this, 0 }; }
+	[[nodiscard]] iterator end() { return iterator { this, iterator::EndPos }; }
+	[[nodiscard]] const_iterator begin() const { return cbegin(); }
+	[[nodiscard]] const_iterator end() const { return cend(); }
+	[[nodiscard]] const_iterator cbegin() const { return const_iterator { this, 0 }; }
+	[[nodiscard]] const_iterator cend() const { return const_iterator { this, const_iterator::EndPos }; }
+
+	[[nodiscard]] size_t size() const { return order_.size(); }
+
+	[[nodiscard]] bool empty() const { return order_.empty(); }
+
+	// NOLINTNEXTLINE(readability-convert-member-functions-to-static)
+	[[nodiscard]] size_t max_size() const // NOLINT(readability-identifier-naming)
+	{
+		return Handle::InvalidIndex;
+	}
+
+	/** @brief The number of slots that have been allocated, including free ones. */
+	[[nodiscard]] size_t capacity() const { return chunks_.size() * ChunkSize; }
+
+	[[nodiscard]] const T &front() const { return *slot(order_.front()); }
+	[[nodiscard]] T &front() { return *slot(order_.front()); }
+
+	[[nodiscard]] const T &back() const { return *slot(order_.back()); }
+	[[nodiscard]] T &back() { return *slot(order_.back()); }
+
+	template <typename... Args>
+	T &emplace_back(Args &&...args) // NOLINT(readability-identifier-naming)
+	{
+		const uint32_t index = allocateSlot();
+		T *element = ::new (static_cast<void *>(slot(index))) T(std::forward<Args>(args)...);
+		order_.push_back(index);
+		return *element;
+	}
+
+	void push_back(const T &value) // NOLINT(readability-identifier-naming)
+	{
+		emplace_back(value);
+	}
+
+	void push_back(T &&value) // NOLINT(readability-identifier-naming)
+	{
+		emplace_back(std::move(value));
+	}
+
+	/**
+	 * @brief Removes all elements for which the predicate returns true.
+	 *
+	 * The remaining elements keep their relative order.
+	 */
+	template <typename Predicate>
+	size_t remove_if(Predicate pred) // NOLINT(readability-identifier-naming)
+	{
+		const size_t oldSize = order_.size();
+		size_t kept = 0;
+		for (size_t i = 0; i < order_.size(); ++i) {
+			const uint32_t index = order_[i];
+			if (pred(*slot(index))) {
+				freeSlot(index);
+			} else {
+				order_[kept++] = index;
+			}
+		}
+		order_.resize(kept);
+		return oldSize - kept;
+	}
+
+	/**
+	 * @brief Removes all elements.
+	 *
+	 * The chunks are kept, and slots are handed out again starting from the first one.
+	 */
+	void clear()
+	{
+		for (const uint32_t index : order_) {
+			std::destroy_at(slot(index));
+			++generations_[index];
+		}
+		order_.clear();
+		freeList_.clear();
+		for (size_t index = capacity(); index-- > 0;) {
+			freeList_.push_back(static_cast<uint32_t>(index));
+		}
+	}
+
+	/** @brief Returns a handle to an element of this map. */
+	[[nodiscard]] Handle handleOf(const T &element) const
+	{
+		const auto *storage = reinterpret_cast<const Storage *>(&element);
+		for (size_t chunk = 0; chunk < chunks_.size(); ++chunk) {
+			const Storage *first = chunks_[chunk]->data();
+			if (storage >= first && storage < first + ChunkSize) {
+				const auto index = static_cast<uint32_t>(chunk * ChunkSize + (storage - first));
+				return Handle { index, generations_[index] };
+			}
+		}
+		app_fatal("SlotMap::handleOf: element does not belong to this map");
+	}
+
+	/** @brief Returns the element that the handle refers to, or nullptr if it has been removed. */
+	[[nodiscard]] T *get(Handle handle)
+	{
+		if (handle.index >= generations_.size() || generations_[handle.index] != handle.generation)
+			return nullptr;
+		return slot(handle.index);
+	}
+
+	[[nodiscard]] const T *get(Handle handle) const
+	{
+		return const_cast<SlotMap *>(this)->get(handle);
+	}
+
+private:
+	struct Storage {
+		alignas(alignof(T)) std::byte data[sizeof(T)];
+	};
+	using Chunk = std::array<Storage, ChunkSize>;
+
+	[[nodiscard]] T *slot(uint32_t index) const
+	{
+		Storage &storage = (*chunks_[index / ChunkSize])[index % ChunkSize];
+		return std::launder(reinterpret_cast<T *>(storage.data));
+	}
+
+	uint32_t allocateSlot()
+	{
+		if (freeList_.empty()) {
+			assert(capacity() + ChunkSize <= max_size());
+			const size_t first = capacity();
+			chunks_.emplace_back(std::make_unique<Chunk>());
+			generations_.resize(capacity(), 0);
+			for (size_t index = capacity(); index-- > first;) {
+				freeList_.push_back(static_cast<uint32_t>(index));
+			}
+		}
+		const uint32_t index = freeList_.back();
+		freeList_.pop_back();
+		return index;
+	}
+
+	void freeSlot(uint32_t index)
+	{
+		std::destroy_at(slot(index));
+		++generations_[index];
+		freeList_.push_back(index);
+	}
+
+	template <bool IsConst>
+	class Iterator {
+		using Map = std::conditional_t<IsConst, const SlotMap, SlotMap>;
+
+	public:
+		static constexpr size_t EndPos = std::numeric_limits<size_t>::max();
+
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<IsConst, const T *, T *>;
+		using reference = std::conditional_t<IsConst, const T &, T &>;
+
+		Iterator() = default;
+
+		Iterator(Map *map, size_t pos)
+		    : map_(map)
+		    , pos_(pos)
+		{
+		}
+
+		reference operator*() const { return *map_->slot(map_->order_[pos_]); }
+		pointer operator->() const { return map_->slot(map_->order_[pos_]); }
+
+		Iterator &operator++()
+		{
+			++pos_;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator copy = *this;
+			++pos_;
+			return copy;
+		}
+
+		// The end iterator is a sentinel, so that elements added during iteration are visited.
+		bool operator==(const Iterator &other) const
+		{
+			if (atEnd()) return other.atEnd();
+			return pos_ == other.pos_;
+		}
+
+	private:
+		[[nodiscard]] bool atEnd() const { return pos_ >= map_->order_.size(); }
+
+		Map *map_ = nullptr;
+		size_t pos_ = 0;
+	};
+
+	std::vector<std::unique_ptr<Chunk>> chunks_;
+	/** @brief Incremented every time the element in a slot is removed. */
+	std::vector<uint32_t> generations_;
+	/** @brief Free slots, the next one to be used is at the back. */
+	std::vector<uint32_t> freeList_;
+	/** @brief Slots of the elements, in the order they were added. */
+	std::vector<uint32_t> order_;
+};
+
+} // namespace devilution
@@ -0,0 +1,61 @@
+#include <array>
+#include <cstdint>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include "engine/clx_sprite.hpp"
+#include "engine/render/clx_render.hpp"
+
+namespace devilution {
+namespace {
+
+// A 6x1 CLX sprite: 4 opaque pixels { 5, 0, 7, 9 }, then a fill of 2 pixels of color 7.
+constexpr uint8_t SpriteData[] = {
+	// Header: header size, width, height, reserved.
+	10, 0, 6, 0, 1, 0, 0, 0, 0, 0,
+	// Pixel data.
+	0xFC, 5, 0, 7, 9,
+	0xBD, 7
+};
+
+ClxSprite TestSprite()
+{
+	return ClxSprite { SpriteData, sizeof(SpriteData) };
+}
+
+std::array<uint8_t, 256> IdentityTrn()
+{
+	std::array<uint8_t, 256> trn;
+	std::iota(trn.begin(), trn.end(), 0);
+	return trn;
+}
+
+TEST(IsPointWithinClxTest, IgnoresColorZero)
+{
+	EXPECT_TRUE(IsPointWithinClx({ 0, 0 }, TestSprite()));
+	EXPECT_FALSE(IsPointWithinClx({ 1, 0 }, TestSprite()));
+	EXPECT_TRUE(IsPointWithinClx({ 2, 0 }, TestSprite()));
+	EXPECT_TRUE(IsPointWithinClx({ 4, 0 }, TestSprite()));
+}
+
+TEST(IsPointWithinClxTest, IgnoresColorsThatTrnMapsToZero)
+{
+	std::array<uint8_t, 256> trn = IdentityTrn();
+	trn[7] = 0;
+	EXPECT_TRUE(IsPointWithinClx({ 0, 0 }, TestSprite(), trn.data()));
+	EXPECT_FALSE(IsPointWithinClx({ 2, 0 }, TestSprite(), trn.data()));
+	EXPECT_TRUE(IsPointWithinClx({ 3, 0 }, TestSprite(), trn.data()));
+	EXPECT_FALSE(IsPointWithinClx({ 4, 0 }, TestSprite(), trn.data()));
+	EXPECT_FALSE(IsPointWithinClx({ 5, 0 }, TestSprite(), trn.data()));
+}
+
+TEST(IsPointWithinClxTest, SelectsColorZeroThatTrnMapsToAColor)
+{
+	std::array<uint8_t, 256> trn = IdentityTrn();
+	trn[0] = 3;
+	EXPECT_TRUE(IsPointWithinClx({ 1, 0 }, TestSprite(), trn.data()));
+}
+
+} // namespace
+} // namespace devilution
@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <span>
+#include <vector>
 
 #include <ankerl/unordered_dense.h>
 #include <benchmark/benchmark.h>
@@ -12,6 +13,7 @@
 #include "engine/lighting_defs.hpp"
 #include "engine/load_file.hpp"
 #include "engine/render/dun_render.hpp"
+#include "engine/render/light_render.hpp"
 #include "engine/surface.hpp"
 #include "levels/dun_tile.hpp"
 #include "levels/gendung.h"
@@ -27,6 +29,7 @@ SDLSurfaceUniquePtr SdlSurface;
 ankerl::unordered_dense::map<TileType, std::vector<LevelCelBlock>> Tiles;
 std::unique_ptr<std::byte[]> BmDunCelData;
 uint_fast8_t BmMicroTileLen;
+std::vector<uint8_t> BmLightmapBuffer;
 
 void InitOnce()
 {
@@ -50,6 +53,15 @@ void InitOnce()
 			exit(1);
 		}
 
+		// Diagonal bands of light levels, so that every line crosses several levels.
+		const Surface out = Surface(SdlSurface.get());
+		BmLightmapBuffer.resize(static_cast<size_t>(out.pitch()) * out.h());
+		for (int y = 0; y < out.h(); ++y) {
+			for (int x = 0; x < out.pitch(); ++x) {
+				BmLightmapBuffer[static_cast<size_t>(y) * out.pitch() + x] = static_cast<uint8_t>(((x + y) / 4) % NumLightingLevels);
+			}
+		}
+
 		for (size_t i = 0; i < 700; ++i) {
 			for (size_t j = 0; j < 10; ++j) {
 				if (const LevelCelBlock levelCelBlock = DPieceMicros[i].mt[j]; levelCelBlock.hasValue()) {
@@ -83,6 +95,30 @@ void RunForTileMaskLight(benchmark::State &state, TileType tileType, MaskType ma
 	state.SetItemsProcessed(state.iterations() * tiles.size());
 }
 
+void RunForTileMaskPerPixelLight(benchmark::State &state, TileType tileType, MaskType maskType, LightingKernel kernel)
+{
+	if (!IsLightingKernelSupported(kernel)) {
+		state.SkipWithError("Lighting kernel is not supported by this CPU");
+		return;
+	}
+	const Surface out = Surface(SdlSurface.get());
+	const Lightmap lightmap(out.at(0, 0), BmLightmapBuffer, out.pitch(), LightTables, FullyLitLightTable, FullyDarkLightTable);
+	const std::span<const LevelCelBlock> tiles = Tiles[tileType];
+	const LightingKernel previousKernel = ActiveLightingKernel;
+	SetLightingKernel(kernel);
+	GetOptions().Graphics.perPixelLighting.SetValue(true);
+	for (auto _ : state) {
+		for (const LevelCelBlock &levelCelBlock : tiles) {
+			RenderTile(out, lightmap, Point { 320, 240 }, BmDunCelData.get(), levelCelBlock, maskType, LightTables[5].data());
+			uint8_t color = out[Point { 310, 200 }];
+			benchmark::DoNotOptimize(color);
+		}
+	}
+	GetOptions().Graphics.perPixelLighting.SetValue(false);
+	SetLightingKernel(previousKernel);
+	state.SetItemsProcessed(state.iterations() * tiles.size());
+}
+
 using GetLightTableFn = const uint8_t *();
 
 const uint8_t *FullyLit() { return LightTables[0].data(); }
@@ -96,6 +132,13 @@ void Render(benchmark::State &state)
 	RunForTileMaskLight(state, TileT, MaskT, GetLightTableFnT());
 }
 
+template <TileType TileT, MaskType MaskT, LightingKernel KernelT>
+void RenderPerPixel(benchmark::State &state)
+{
+	InitOnce();
+	RunForTileMaskPerPixelLight(state, TileT, MaskT, KernelT);
+}
+
 // Define aliases in order to have shorter benchmark names.
 constexpr auto LeftTriangle = TileType::LeftTriangle;
 constexpr auto RightTriangle = TileType::RightTriangle;
@@ -105,11 +148,15 @@ constexpr auto LeftTrapezoid = TileType::LeftTrapezoid;
 constexpr auto RightTrapezoid = TileType::RightTrapezoid;
 constexpr auto Transparent = MaskType::Transparent;
 constexpr auto Solid = MaskType::Solid;
-
-#define DEFINE_FOR_TILE_AND_MASK_TYPE(TILE_TYPE, MASK_TYPE)      \
-	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyLit);  \
-	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyDark); \
-	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, PartiallyLit);
+constexpr auto Scalar = LightingKernel::Scalar;
+constexpr auto Avx2 = LightingKernel::Avx2;
+
+#define DEFINE_FOR_TILE_AND_MASK_TYPE(TILE_TYPE, MASK_TYPE)           \
+	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyLit);       \
+	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, FullyDark);      \
+	BENCHMARK_TEMPLATE(Render, TILE_TYPE, MASK_TYPE, PartiallyLit);   \
+	BENCHMARK_TEMPLATE(RenderPerPixel, TILE_TYPE, MASK_TYPE, Scalar); \
+	BENCHMARK_TEMPLATE(RenderPerPixel, TILE_TYPE, MASK_TYPE, Avx2);
 
 #define DEFINE_FOR_TILE_TYPE(TILE_TYPE)             \
 	DEFINE_FOR_TILE_AND_MASK_TYPE(TILE_TYPE, Solid) \
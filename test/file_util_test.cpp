@@ -1,8 +1,10 @@
 #include <gtest/gtest.h>
 
 #include <cstdio>
+#include <string_view>
 
 #include "utils/file_util.h"
+#include "utils/positional_file.hpp"
 
 using namespace devilution;
 
@@ -82,4 +84,28 @@ TEST(FileUtil, RecursivelyCreateDir)
 	EXPECT_TRUE(DirectoryExists(path.c_str()));
 }
 
+TEST(FileUtil, PositionalFileReadAt)
+{
+	const std::string path = GetTmpPathName();
+	FILE *file = std::fopen(path.c_str(), "wb");
+	ASSERT_TRUE(file != nullptr);
+	std::fputs("0123456789", file);
+	std::fclose(file);
+
+	PositionalFile positionalFile;
+	EXPECT_FALSE(positionalFile.IsOpen());
+	ASSERT_TRUE(positionalFile.Open(path.c_str()));
+	char buf[4] = {};
+	ASSERT_TRUE(positionalFile.ReadAt(6, buf, 4));
+	EXPECT_EQ(std::string_view(buf, 4), "6789");
+	ASSERT_TRUE(positionalFile.ReadAt(1, buf, 2));
+	EXPECT_EQ(std::string_view(buf, 2), "12");
+	EXPECT_FALSE(positionalFile.ReadAt(8, buf, 4));
+
+	const PositionalFile moved = std::move(positionalFile);
+	EXPECT_FALSE(positionalFile.IsOpen());
+	EXPECT_TRUE(moved.IsOpen());
+	EXPECT_FALSE(PositionalFile().Open("this-file-should-not-exist"));
+}
+
 } // namespace
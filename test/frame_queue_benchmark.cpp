@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include <benchmark/benchmark.h>
+
+#include "dvlnet/frame_queue.h"
+
+namespace devilution {
+namespace net {
+namespace {
+
+// Type, source, destination, sequence number and value, as in an unencrypted PT_TURN packet.
+constexpr size_t TurnPacketSize = 3 + sizeof(turn_t);
+constexpr size_t FramesInStream = 1024;
+
+buffer_t MakeTurnStream()
+{
+	buffer_t stream;
+	for (size_t i = 0; i < FramesInStream; ++i) {
+		const buffer_t frame = *frame_queue::MakeFrame(buffer_t(TurnPacketSize, static_cast<unsigned char>(i)));
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+	return stream;
+}
+
+/** @brief Receives a stream of turn packets in chunks of `state.range(0)` bytes, as a socket would deliver them. */
+void BM_ReadTurnPackets(benchmark::State &state)
+{
+	const buffer_t stream = MakeTurnStream();
+	const size_t chunkSize = static_cast<size_t>(state.range(0));
+	frame_queue queue;
+	for (auto _ : state) {
+		for (size_t offset = 0; offset < stream.size(); offset += chunkSize) {
+			const size_t size = std::min(chunkSize, stream.size() - offset);
+			const std::span<unsigned char> buf = queue.WriteBuffer(frame_queue::max_frame_size);
+			std::memcpy(buf.data(), stream.data() + offset, size);
+			queue.CommitWrite(size);
+			while (*queue.PacketReady()) {
+				const std::span<const unsigned char> packet = *queue.ReadPacket();
+				benchmark::DoNotOptimize(packet.data());
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * FramesInStream);
+	state.SetBytesProcessed(state.iterations() * stream.size());
+}
+
+BENCHMARK(BM_ReadTurnPackets)->Arg(7)->Arg(64)->Arg(1460)->Arg(frame_queue::max_frame_size);
+
+} // namespace
+} // namespace net
+} // namespace devilution
@@ -0,0 +1,93 @@
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/render/light_render.hpp"
+
+namespace devilution {
+namespace {
+
+class LookupPixels2DTest : public ::testing::TestWithParam<LightingKernel> {
+protected:
+	void SetUp() override
+	{
+		if (!IsLightingKernelSupported(GetParam()))
+			GTEST_SKIP() << "Kernel is not supported by this CPU";
+		previousKernel_ = ActiveLightingKernel;
+		SetLightingKernel(GetParam());
+	}
+
+	void TearDown() override
+	{
+		ActiveLightingKernel = previousKernel_;
+	}
+
+private:
+	LightingKernel previousKernel_ = LightingKernel::Scalar;
+};
+
+std::vector<uint8_t> MakeTable(unsigned numRows)
+{
+	std::vector<uint8_t> table(numRows * 256);
+	uint32_t state = 0x12345678;
+	for (uint8_t &value : table) {
+		state = state * 1664525 + 1013904223;
+		value = static_cast<uint8_t>(state >> 24);
+	}
+	return table;
+}
+
+void ExpectMatchesTable(unsigned numRows)
+{
+	const std::vector<uint8_t> table = MakeTable(numRows);
+	for (unsigned length = 1; length <= 100; length++) {
+		std::vector<uint8_t> rows(length);
+		std::vector<uint8_t> columns(length);
+		for (unsigned i = 0; i < length; i++) {
+			// Cover the last bytes of the table, where the wide loads have to be shifted back.
+			rows[i] = static_cast<uint8_t>((numRows - 1 - i) % numRows);
+			columns[i] = static_cast<uint8_t>(255 - (i * 7) % 256);
+		}
+		std::vector<uint8_t> dst(length);
+		LookupPixels2D(dst.data(), rows.data(), columns.data(), length, table.data(), numRows);
+		for (unsigned i = 0; i < length; i++) {
+			ASSERT_EQ(dst[i], table[rows[i] * 256 + columns[i]]) << "length " << length << " index " << i;
+		}
+	}
+}
+
+TEST_P(LookupPixels2DTest, MatchesLightTables)
+{
+	ExpectMatchesTable(NumLightingLevels);
+}
+
+TEST_P(LookupPixels2DTest, MatchesBlendingTable)
+{
+	ExpectMatchesTable(256);
+}
+
+TEST_P(LookupPixels2DTest, SupportsInPlaceLookup)
+{
+	const std::vector<uint8_t> table = MakeTable(256);
+	std::vector<uint8_t> dst(64);
+	std::vector<uint8_t> columns(64);
+	for (unsigned i = 0; i < dst.size(); i++) {
+		dst[i] = static_cast<uint8_t>(i * 3);
+		columns[i] = static_cast<uint8_t>(i * 5);
+	}
+	std::vector<uint8_t> expected(dst.size());
+	for (unsigned i = 0; i < dst.size(); i++)
+		expected[i] = table[dst[i] * 256 + columns[i]];
+
+	LookupPixels2D(dst.data(), dst.data(), columns.data(), static_cast<unsigned>(dst.size()), table.data(), 256);
+	EXPECT_EQ(dst, expected);
+}
+
+INSTANTIATE_TEST_SUITE_P(Kernels, LookupPixels2DTest, ::testing::Values(LightingKernel::Scalar, LightingKernel::Avx2),
+    [](const ::testing::TestParamInfo<LightingKernel> &info) {
+	    return info.param == LightingKernel::Scalar ? "Scalar" : "Avx2";
+    });
+
+} // namespace
+} // namespace devilution
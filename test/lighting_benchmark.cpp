@@ -0,0 +1,50 @@
+#include <cstdint>
+#include <cstring>
+
+#include <benchmark/benchmark.h>
+
+#include "levels/gendung.h"
+#include "lighting.h"
+
+namespace devilution {
+namespace {
+
+/**
+ * @brief A Nest level with the maximum number of lights, some of which move every tick (e.g. missiles).
+ */
+template <bool ReapplyAll>
+void BM_ProcessLightList(benchmark::State &state)
+{
+	const int numMoving = static_cast<int>(state.range(0));
+	leveltype = DTYPE_NEST;
+	MakeLightTable();
+	memset(dPreLight, 15, sizeof(dPreLight));
+	memset(dPiece, 0, sizeof(dPiece));
+	memcpy(dLight, dPreLight, sizeof(dLight));
+	InitLighting();
+
+	int lightIds[MAXLIGHTS];
+	for (int i = 0; i < MAXLIGHTS; i++) {
+		lightIds[i] = AddLight({ 16 + (i % 8) * 10, 16 + (i / 8) * 20 }, static_cast<uint8_t>(3 + i % 6));
+	}
+	ProcessLightList();
+
+	int tick = 0;
+	for (auto _ : state) {
+		for (int i = 0; i < numMoving; i++) {
+			const int step = (tick + i) % 16;
+			ChangeLightOffset(lightIds[i], { static_cast<int8_t>(step < 8 ? step : 15 - step), static_cast<int8_t>(step / 2) });
+		}
+		tick++;
+		if (ReapplyAll)
+			TestReapplyAllLights();
+		ProcessLightList();
+		benchmark::DoNotOptimize(dLight);
+	}
+}
+
+BENCHMARK_TEMPLATE(BM_ProcessLightList, /*ReapplyAll=*/true)->Arg(1)->Arg(8)->Arg(MAXLIGHTS);
+BENCHMARK_TEMPLATE(BM_ProcessLightList, /*ReapplyAll=*/false)->Arg(1)->Arg(8)->Arg(MAXLIGHTS);
+
+} // namespace
+} // namespace devilution
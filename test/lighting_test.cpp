@@ -0,0 +1,104 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "engine/random.hpp"
+#include "levels/gendung.h"
+#include "lighting.h"
+
+using namespace devilution;
+
+namespace {
+
+using LightMap = std::vector<uint8_t>;
+
+Point RandomTile()
+{
+	return { GenerateRnd(MAXDUNX), GenerateRnd(MAXDUNY) };
+}
+
+/**
+ * @brief Adds, moves and removes lights at random and returns dLight after every ProcessLightList.
+ */
+std::vector<LightMap> SimulateLights(dungeon_type levelType, bool reapplyAll)
+{
+	leveltype = levelType;
+	MakeLightTable();
+	SetRndSeed(42);
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dPreLight[x][y] = static_cast<uint8_t>(GenerateRnd(16));
+			dPiece[x][y] = 0;
+		}
+	}
+	memcpy(dLight, dPreLight, sizeof(dLight));
+	InitLighting();
+
+	std::vector<int> lightIds;
+	std::vector<LightMap> result;
+	for (int tick = 0; tick < 500; tick++) {
+		for (int i = GenerateRnd(6); i > 0; i--) {
+			const int action = GenerateRnd(8);
+			if (action == 0 && lightIds.size() < MAXLIGHTS) {
+				lightIds.push_back(AddLight(RandomTile(), static_cast<uint8_t>(GenerateRnd(16))));
+				continue;
+			}
+			if (lightIds.empty())
+				continue;
+			const size_t index = GenerateRnd(static_cast<int32_t>(lightIds.size()));
+			const int id = lightIds[index];
+			switch (action) {
+			case 1:
+				AddUnLight(id);
+				lightIds[index] = lightIds.back();
+				lightIds.pop_back();
+				break;
+			case 2:
+				ChangeLightRadius(id, static_cast<uint8_t>(GenerateRnd(16)));
+				break;
+			case 3:
+			case 4: {
+				const Point position = Lights[id].position.tile + Displacement { GenerateRnd(3) - 1, GenerateRnd(3) - 1 };
+				if (InDungeonBounds(position))
+					ChangeLightXY(id, position);
+			} break;
+			case 5:
+			case 6:
+				ChangeLightOffset(id, { static_cast<int8_t>(GenerateRnd(15) - 7), static_cast<int8_t>(GenerateRnd(15) - 7) });
+				break;
+			default:
+				ChangeLight(id, RandomTile(), static_cast<uint8_t>(GenerateRnd(16)));
+				break;
+			}
+		}
+		if (reapplyAll)
+			TestReapplyAllLights();
+		ProcessLightList();
+		result.emplace_back(&dLight[0][0], &dLight[0][0] + sizeof(dLight));
+	}
+	return result;
+}
+
+void ExpectIncrementalUpdatesMatch(dungeon_type levelType)
+{
+	const std::vector<LightMap> expected = SimulateLights(levelType, /*reapplyAll=*/true);
+	const std::vector<LightMap> actual = SimulateLights(levelType, /*reapplyAll=*/false);
+	ASSERT_EQ(actual.size(), expected.size());
+	for (size_t tick = 0; tick < expected.size(); tick++) {
+		ASSERT_EQ(actual[tick], expected[tick]) << "dLight differs after tick " << tick;
+	}
+}
+
+TEST(Lighting, IncrementalUpdatesMatchFullUpdates)
+{
+	ExpectIncrementalUpdatesMatch(DTYPE_CATHEDRAL);
+}
+
+TEST(Lighting, IncrementalUpdatesMatchFullUpdatesInNest)
+{
+	ExpectIncrementalUpdatesMatch(DTYPE_NEST);
+}
+
+} // namespace
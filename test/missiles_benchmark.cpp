@@ -0,0 +1,90 @@
+#include <cstdint>
+#include <list>
+
+#include <benchmark/benchmark.h>
+
+#include "missiles.h"
+#include "utils/slot_map.hpp"
+
+namespace devilution {
+namespace {
+
+/** @brief Ticks that each missile lives for, roughly a Fire Wall segment. */
+constexpr int Lifetime = 64;
+
+void SpawnMissile(Missile &missile, int i)
+{
+	missile._mitype = MissileID::FireWall;
+	missile.duration = Lifetime;
+	missile.position.tile = { static_cast<WorldTileCoord>(16 + i % 64), static_cast<WorldTileCoord>(16 + (i / 64) % 64) };
+	missile.position.velocity = { 1 + i % 3, 1 + i % 5 };
+}
+
+void ProcessMissile(Missile &missile)
+{
+	missile.position.traveled += missile.position.velocity;
+	missile.position.offset = { missile.position.traveled.deltaX >> 16, missile.position.traveled.deltaY >> 16 };
+	missile._miAnimFrame++;
+	if (--missile.duration == 0)
+		missile._miDelFlag = true;
+}
+
+/**
+ * @brief Simulates `ProcessMissiles` with a steady number of live missiles.
+ *
+ * Every tick a batch of new missiles is spawned, all missiles are processed and the expired ones are deleted.
+ */
+template <typename Container>
+void BM_ProcessMissiles(benchmark::State &state)
+{
+	const int numMissiles = static_cast<int>(state.range(0));
+	const int spawnedPerTick = numMissiles / Lifetime;
+	Container missiles;
+	int spawned = 0;
+	const auto tick = [&]() {
+		for (int i = 0; i < spawnedPerTick; ++i) {
+			SpawnMissile(missiles.emplace_back(), spawned++);
+		}
+		for (Missile &missile : missiles) {
+			ProcessMissile(missile);
+		}
+		missiles.remove_if([](const Missile &missile) { return missile._miDelFlag; });
+	};
+
+	for (int i = 0; i < Lifetime; ++i) {
+		tick();
+	}
+	for (auto _ : state) {
+		tick();
+		benchmark::DoNotOptimize(missiles.size());
+	}
+	state.SetItemsProcessed(state.iterations() * missiles.size());
+}
+
+/**
+ * @brief Spawns a burst of missiles (e.g. many Novas cast at once), walks them once and clears them.
+ */
+template <typename Container>
+void BM_SpawnMissiles(benchmark::State &state)
+{
+	const int numMissiles = static_cast<int>(state.range(0));
+	Container missiles;
+	for (auto _ : state) {
+		for (int i = 0; i < numMissiles; ++i) {
+			SpawnMissile(missiles.emplace_back(), i);
+		}
+		for (Missile &missile : missiles) {
+			ProcessMissile(missile);
+		}
+		missiles.clear();
+	}
+	state.SetItemsProcessed(state.iterations() * numMissiles);
+}
+
+BENCHMARK_TEMPLATE(BM_ProcessMissiles, std::list<Missile>)->RangeMultiplier(4)->Range(256, 16384);
+BENCHMARK_TEMPLATE(BM_ProcessMissiles, SlotMap<Missile>)->RangeMultiplier(4)->Range(256, 16384);
+BENCHMARK_TEMPLATE(BM_SpawnMissiles, std::list<Missile>)->RangeMultiplier(4)->Range(256, 16384);
+BENCHMARK_TEMPLATE(BM_SpawnMissiles, SlotMap<Missile>)->RangeMultiplier(4)->Range(256, 16384);
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,60 @@
+#include <cstddef>
+#include <numeric>
+
+#include <benchmark/benchmark.h>
+
+#include "engine/random.hpp"
+#include "levels/gendung.h"
+#include "monster.h"
+#include "player.h"
+
+namespace devilution {
+namespace {
+
+constexpr size_t NumMonsters = 200;
+
+/**
+ * @brief A crowded level: 200 monsters spread over a few rooms, 2 golems and a berserked monster.
+ */
+void InitLevel()
+{
+	Players.clear();
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			dTransVal[x][y] = static_cast<int8_t>(1 + (x / 28) + 4 * (y / 28));
+		}
+	}
+
+	SetRndSeed(0);
+	ActiveMonsterCount = NumMonsters;
+	std::iota(std::begin(ActiveMonsters), std::end(ActiveMonsters), 0U);
+	for (size_t i = 0; i < NumMonsters; i++) {
+		Monster &monster = Monsters[i];
+		monster.position.tile = { static_cast<WorldTileCoord>(16 + GenerateRnd(80)), static_cast<WorldTileCoord>(16 + GenerateRnd(80)) };
+		monster.position.future = monster.position.tile;
+		monster.hitPoints = 100 << 6;
+		monster.talkMsg = TEXT_NONE;
+		monster.ai = i % 4 == 0 ? MonsterAIID::SkeletonRanged : MonsterAIID::SkeletonMelee;
+		monster.flags = 0;
+	}
+	Monsters[0].flags = MFLAG_GOLEM;
+	Monsters[1].flags = MFLAG_GOLEM;
+	Monsters[NumMonsters - 1].flags = MFLAG_GOLEM | MFLAG_BERSERK;
+}
+
+template <bool UseGolemTargets>
+void BM_UpdateEnemies(benchmark::State &state)
+{
+	InitLevel();
+	for (auto _ : state) {
+		TestUpdateEnemies(UseGolemTargets);
+		benchmark::DoNotOptimize(Monsters[NumMonsters / 2].enemy);
+	}
+	state.SetItemsProcessed(state.iterations() * NumMonsters);
+}
+
+BENCHMARK_TEMPLATE(BM_UpdateEnemies, /*UseGolemTargets=*/false);
+BENCHMARK_TEMPLATE(BM_UpdateEnemies, /*UseGolemTargets=*/true);
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,100 @@
+#include <array>
+#include <cstddef>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include "engine/random.hpp"
+#include "levels/gendung.h"
+#include "monster.h"
+#include "player.h"
+
+using namespace devilution;
+
+namespace {
+
+struct EnemyState {
+	uint32_t flags;
+	uint8_t enemy;
+	WorldTilePosition enemyPosition;
+};
+
+void PlaceMonsters(size_t count)
+{
+	Players.clear();
+	for (int x = 0; x < MAXDUNX; x++) {
+		for (int y = 0; y < MAXDUNY; y++) {
+			// Four rooms with a gap between them.
+			dTransVal[x][y] = static_cast<int8_t>(1 + (x / 56) + 2 * (y / 56));
+		}
+	}
+
+	ActiveMonsterCount = count;
+	std::iota(std::begin(ActiveMonsters), std::end(ActiveMonsters), 0U);
+	// Shuffle the order of the active monsters, since it is used to break ties.
+	for (size_t i = count - 1; i > 0; i--) {
+		std::swap(ActiveMonsters[i], ActiveMonsters[GenerateRnd(static_cast<int32_t>(i + 1))]);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		Monster &monster = Monsters[i];
+		monster.position.tile = { static_cast<WorldTileCoord>(16 + GenerateRnd(80)), static_cast<WorldTileCoord>(16 + GenerateRnd(80)) };
+		monster.position.future = monster.position.tile;
+		monster.hitPoints = GenerateRnd(4) == 0 ? 0 : 100 << 6;
+		monster.talkMsg = TEXT_NONE;
+		monster.ai = GenerateRnd(3) == 0 ? MonsterAIID::SkeletonRanged : MonsterAIID::SkeletonMelee;
+		monster.flags = 0;
+		switch (GenerateRnd(16)) {
+		case 0:
+			monster.flags = MFLAG_GOLEM;
+			break;
+		case 1:
+			monster.flags = MFLAG_GOLEM | MFLAG_BERSERK;
+			break;
+		}
+		monster.enemy = 0;
+		monster.enemyPosition = {};
+	}
+}
+
+std::array<EnemyState, MaxMonsters> GetEnemyStates()
+{
+	std::array<EnemyState, MaxMonsters> result;
+	for (size_t i = 0; i < MaxMonsters; i++) {
+		result[i] = { Monsters[i].flags, Monsters[i].enemy, Monsters[i].enemyPosition };
+	}
+	return result;
+}
+
+void SetEnemyStates(const std::array<EnemyState, MaxMonsters> &states)
+{
+	for (size_t i = 0; i < MaxMonsters; i++) {
+		Monsters[i].flags = states[i].flags;
+		Monsters[i].enemy = states[i].enemy;
+		Monsters[i].enemyPosition = states[i].enemyPosition;
+	}
+}
+
+TEST(Monster, UpdateEnemyWithGolemTargetsPicksSameEnemy)
+{
+	for (uint32_t seed = 0; seed < 20; seed++) {
+		SetRndSeed(seed);
+		PlaceMonsters(200);
+		const std::array<EnemyState, MaxMonsters> initial = GetEnemyStates();
+
+		TestUpdateEnemies(/*useGolemTargets=*/false);
+		const std::array<EnemyState, MaxMonsters> expected = GetEnemyStates();
+
+		SetEnemyStates(initial);
+		TestUpdateEnemies(/*useGolemTargets=*/true);
+		const std::array<EnemyState, MaxMonsters> actual = GetEnemyStates();
+
+		for (size_t i = 0; i < MaxMonsters; i++) {
+			EXPECT_EQ(actual[i].flags, expected[i].flags) << "seed " << seed << ", monster " << i;
+			EXPECT_EQ(actual[i].enemy, expected[i].enemy) << "seed " << seed << ", monster " << i;
+			EXPECT_EQ(actual[i].enemyPosition, expected[i].enemyPosition) << "seed " << seed << ", monster " << i;
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "mpq/mpq_block_cache.hpp"
+
+namespace devilution {
+namespace {
+
+MpqBlockRef MakeBlock(std::size_t size, uint8_t value)
+{
+	auto block = std::make_shared<MpqBlock>();
+	block->data = std::unique_ptr<uint8_t[]> { new uint8_t[size] };
+	block->size = size;
+	for (std::size_t i = 0; i < size; ++i)
+		block->data[i] = value;
+	return block;
+}
+
+class MpqBlockCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		defaultCapacity = mpq_block_cache::GetCapacity();
+		mpq_block_cache::SetCapacity(3 * 4096);
+		archiveId = mpq_block_cache::NewArchiveId();
+	}
+
+	void TearDown() override
+	{
+		mpq_block_cache::SetCapacity(defaultCapacity);
+	}
+
+	std::size_t defaultCapacity;
+	uint32_t archiveId;
+};
+
+TEST_F(MpqBlockCacheTest, FindReturnsInsertedBlock)
+{
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 1, 0), nullptr);
+	const MpqBlockRef block = MakeBlock(4096, 7);
+	EXPECT_EQ(mpq_block_cache::Insert(archiveId, 1, 0, block), block);
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 1, 0), block);
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 1, 1), nullptr);
+	EXPECT_EQ(mpq_block_cache::Find(archiveId + 1, 1, 0), nullptr);
+	EXPECT_EQ(mpq_block_cache::GetSize(), 4096);
+}
+
+TEST_F(MpqBlockCacheTest, InsertReturnsExistingBlock)
+{
+	const MpqBlockRef first = MakeBlock(4096, 1);
+	mpq_block_cache::Insert(archiveId, 1, 0, first);
+	EXPECT_EQ(mpq_block_cache::Insert(archiveId, 1, 0, MakeBlock(4096, 2)), first);
+	EXPECT_EQ(mpq_block_cache::GetSize(), 4096);
+}
+
+TEST_F(MpqBlockCacheTest, EvictsLeastRecentlyUsed)
+{
+	const MpqBlockRef evicted = MakeBlock(4096, 1);
+	mpq_block_cache::Insert(archiveId, 1, 0, MakeBlock(4096, 0));
+	mpq_block_cache::Insert(archiveId, 1, 1, evicted);
+	mpq_block_cache::Insert(archiveId, 1, 2, MakeBlock(4096, 2));
+	ASSERT_NE(mpq_block_cache::Find(archiveId, 1, 0), nullptr);
+
+	mpq_block_cache::Insert(archiveId, 1, 3, MakeBlock(4096, 3));
+	mpq_block_cache::Insert(archiveId, 1, 4, MakeBlock(4096, 4));
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 1, 1), nullptr);
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 1, 2), nullptr);
+	EXPECT_NE(mpq_block_cache::Find(archiveId, 1, 0), nullptr);
+	EXPECT_NE(mpq_block_cache::Find(archiveId, 1, 3), nullptr);
+	EXPECT_NE(mpq_block_cache::Find(archiveId, 1, 4), nullptr);
+	EXPECT_EQ(mpq_block_cache::GetSize(), 3 * 4096);
+
+	// Evicted blocks stay valid while referenced.
+	EXPECT_EQ(evicted->span()[4095], 1);
+}
+
+TEST_F(MpqBlockCacheTest, DoesNotCacheBlocksLargerThanCapacity)
+{
+	const MpqBlockRef block = MakeBlock(4 * 4096, 1);
+	EXPECT_EQ(mpq_block_cache::Insert(archiveId, 1, 0, block), block);
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 1, 0), nullptr);
+	EXPECT_EQ(mpq_block_cache::GetSize(), 0);
+}
+
+TEST_F(MpqBlockCacheTest, EraseArchive)
+{
+	const uint32_t otherArchiveId = mpq_block_cache::NewArchiveId();
+	mpq_block_cache::Insert(archiveId, 1, 0, MakeBlock(1024, 0));
+	mpq_block_cache::Insert(archiveId, 2, 5, MakeBlock(1024, 0));
+	mpq_block_cache::Insert(otherArchiveId, 1, 0, MakeBlock(1024, 0));
+	mpq_block_cache::EraseArchive(archiveId);
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 1, 0), nullptr);
+	EXPECT_EQ(mpq_block_cache::Find(archiveId, 2, 5), nullptr);
+	EXPECT_NE(mpq_block_cache::Find(otherArchiveId, 1, 0), nullptr);
+	EXPECT_EQ(mpq_block_cache::GetSize(), 1024);
+}
+
+TEST_F(MpqBlockCacheTest, IsCacheable)
+{
+	EXPECT_TRUE(mpq_block_cache::IsCacheable(0));
+	EXPECT_TRUE(mpq_block_cache::IsCacheable(3 * 4096 / 8));
+	EXPECT_FALSE(mpq_block_cache::IsCacheable(3 * 4096 / 8 + 1));
+}
+
+} // namespace
+} // namespace devilution
@@ -0,0 +1,105 @@
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include "dvlnet/packet.h"
+
+namespace devilution {
+namespace net {
+namespace {
+
+buffer_t MakeMessageData(packet_factory &factory, plr_t src, plr_t dest, const buffer_t &message)
+{
+	tl::expected<std::unique_ptr<packet>, PacketError> pkt = factory.make_packet<PT_MESSAGE>(src, dest, message);
+	EXPECT_TRUE(pkt.has_value());
+	return (*pkt)->Data();
+}
+
+void ExpectMessage(packet &pkt, plr_t src, plr_t dest, const buffer_t &message)
+{
+	EXPECT_EQ(pkt.Type(), PT_MESSAGE);
+	EXPECT_EQ(pkt.Source(), src);
+	EXPECT_EQ(pkt.Destination(), dest);
+	tl::expected<const buffer_t *, PacketError> received = pkt.Message();
+	ASSERT_TRUE(received.has_value());
+	EXPECT_EQ(**received, message);
+}
+
+TEST(PacketTest, RoundTrip)
+{
+	packet_factory factory;
+	const buffer_t message { 1, 2, 3, 4, 5 };
+	const buffer_t data = MakeMessageData(factory, 2, PLR_BROADCAST, message);
+
+	tl::expected<std::unique_ptr<packet>, PacketError> pkt = factory.make_packet(data);
+	ASSERT_TRUE(pkt.has_value()) << pkt.error().what();
+	ExpectMessage(**pkt, 2, PLR_BROADCAST, message);
+}
+
+TEST(PacketTest, UnencryptedPacketsAreAlwaysCompatible)
+{
+	const packet_factory factory;
+	EXPECT_TRUE(factory.IsCompatible(buffer_t {}));
+	EXPECT_TRUE(factory.IsCompatible(buffer_t { PT_MESSAGE, 0, PLR_BROADCAST, ProtocolVersion + 1 }));
+}
+
+#ifdef PACKET_ENCRYPTION
+TEST(PacketTest, EncryptedRoundTrip)
+{
+	packet_factory factory("password");
+	const buffer_t message { 1, 2, 3, 4, 5 };
+	const buffer_t data = MakeMessageData(factory, 2, 3, message);
+
+	// The routing header and the version are in the clear.
+	ASSERT_GE(data.size(), EncryptedHeaderSize);
+	EXPECT_EQ(data[0], PT_MESSAGE);
+	EXPECT_EQ(data[1], 2);
+	EXPECT_EQ(data[2], 3);
+	EXPECT_EQ(data[RoutingHeaderSize], ProtocolVersion);
+	EXPECT_TRUE(factory.IsCompatible(data));
+
+	tl::expected<std::unique_ptr<packet>, PacketError> pkt = factory.make_packet(data);
+	ASSERT_TRUE(pkt.has_value()) << pkt.error().what();
+	ExpectMessage(**pkt, 2, 3, message);
+}
+
+TEST(PacketTest, RejectsTamperedRoutingHeader)
+{
+	packet_factory factory("password");
+	buffer_t data = MakeMessageData(factory, 2, 3, buffer_t { 1, 2, 3 });
+
+	data[2] = PLR_BROADCAST;
+	tl::expected<std::unique_ptr<packet>, PacketError> pkt = factory.make_packet(data);
+	ASSERT_FALSE(pkt.has_value());
+	EXPECT_EQ(pkt.error().what(), std::string_view("Packet routing header mismatch"));
+}
+
+TEST(PacketTest, RejectsOtherProtocolVersion)
+{
+	packet_factory factory("password");
+	buffer_t data = MakeMessageData(factory, 2, 3, buffer_t { 1, 2, 3 });
+
+	data[RoutingHeaderSize] = ProtocolVersion + 1;
+	EXPECT_FALSE(factory.IsCompatible(data));
+	tl::expected<std::unique_ptr<packet>, PacketError> pkt = factory.make_packet(data);
+	ASSERT_FALSE(pkt.has_value());
+	EXPECT_EQ(pkt.error().what(), IncompatibleVersionError().what());
+
+	EXPECT_FALSE(factory.IsCompatible(buffer_t { PT_MESSAGE, 2, 3 }));
+	EXPECT_TRUE(factory.IsCompatible(packet_factory::MakeVersionPacket()));
+}
+
+TEST(PacketTest, RejectsWrongPassword)
+{
+	packet_factory factory("password");
+	packet_factory otherFactory("other password");
+	const buffer_t data = MakeMessageData(factory, 2, 3, buffer_t { 1, 2, 3 });
+
+	EXPECT_TRUE(otherFactory.IsCompatible(data));
+	EXPECT_FALSE(otherFactory.make_packet(data).has_value());
+}
+#endif
+
+} // namespace
+} // namespace net
+} // namespace devilution
@@ -29,6 +29,21 @@ void BM_GenerateBlendedLookupTable(benchmark::State &state)
 {
 	std::array<SDL_Color, 256> palette;
 	GeneratePalette(palette.data());
+	SetBlendedLookupTableThreadCount(static_cast<unsigned>(state.range(0)));
+	for (auto _ : state) {
+		ClearBlendedLookupTableCache();
+		GenerateBlendedLookupTable(palette.data());
+		int result = paletteTransparencyLookup[17][98];
+		benchmark::DoNotOptimize(result);
+	}
+	SetBlendedLookupTableThreadCount(0);
+}
+
+void BM_GenerateBlendedLookupTableCached(benchmark::State &state)
+{
+	std::array<SDL_Color, 256> palette;
+	GeneratePalette(palette.data());
+	GenerateBlendedLookupTable(palette.data());
 	for (auto _ : state) {
 		GenerateBlendedLookupTable(palette.data());
 		int result = paletteTransparencyLookup[17][98];
@@ -66,7 +81,8 @@ void BM_FindNearestNeighbor(benchmark::State &state)
 	state.SetItemsProcessed(state.iterations() * 256 * 256 * 256);
 }
 
-BENCHMARK(BM_GenerateBlendedLookupTable);
+BENCHMARK(BM_GenerateBlendedLookupTable)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK(BM_GenerateBlendedLookupTableCached);
 BENCHMARK(BM_BuildTree);
 BENCHMARK(BM_FindNearestNeighbor);
 
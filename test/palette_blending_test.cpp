@@ -2,6 +2,9 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <iostream>
 
 #include <SDL.h>
@@ -80,5 +83,71 @@ TEST(GenerateBlendedLookupTableTest, BasicTest)
 #endif
 }
 
+TEST(GenerateBlendedLookupTableTest, ThreadedAndCachedMatchSerial)
+{
+	std::array<SDL_Color, 256> palette;
+	GeneratePalette(palette.data());
+
+	static uint8_t expected[256][256];
+	ClearBlendedLookupTableCache();
+	SetBlendedLookupTableThreadCount(1);
+	GenerateBlendedLookupTable(palette.data(), /*skipFrom=*/1, /*skipTo=*/15);
+	std::memcpy(expected, paletteTransparencyLookup, sizeof(expected));
+
+	ClearBlendedLookupTableCache();
+	SetBlendedLookupTableThreadCount(3);
+	GenerateBlendedLookupTable(palette.data(), /*skipFrom=*/1, /*skipTo=*/15);
+	SetBlendedLookupTableThreadCount(0);
+	EXPECT_EQ(std::memcmp(expected, paletteTransparencyLookup, sizeof(expected)), 0);
+
+	// A different skip range must not be served from the cache.
+	GenerateBlendedLookupTable(palette.data());
+	EXPECT_NE(std::memcmp(expected, paletteTransparencyLookup, sizeof(expected)), 0);
+
+	RotateBlendedLookupTable(1, 2, 15);
+	GenerateBlendedLookupTable(palette.data(), /*skipFrom=*/1, /*skipTo=*/15);
+	EXPECT_EQ(std::memcmp(expected, paletteTransparencyLookup, sizeof(expected)), 0);
+}
+
+void RotateNaive(uint8_t table[256][256], unsigned from, unsigned middle, unsigned to)
+{
+	for (unsigned i = 0; i < 256; ++i) {
+		std::rotate(std::begin(table[i]) + from, std::begin(table[i]) + middle, std::begin(table[i]) + to + 1);
+	}
+	// Rotate the rows left by one `middle - from` times.
+	for (unsigned i = from; i < middle; ++i) {
+		for (unsigned j = from; j < to; ++j) {
+			std::swap_ranges(std::begin(table[j]), std::end(table[j]), std::begin(table[j + 1]));
+		}
+	}
+}
+
+TEST(RotateBlendedLookupTableTest, RotatesRowsAndColumns)
+{
+	std::array<SDL_Color, 256> palette;
+	GeneratePalette(palette.data());
+	GenerateBlendedLookupTable(palette.data(), /*skipFrom=*/1, /*skipTo=*/31);
+
+	static uint8_t expected[256][256];
+	std::memcpy(expected, paletteTransparencyLookup, sizeof(expected));
+
+	RotateNaive(expected, 1, 2, 31);
+	RotateBlendedLookupTable(1, 2, 31);
+	EXPECT_EQ(std::memcmp(expected, paletteTransparencyLookup, sizeof(expected)), 0);
+
+	RotateNaive(expected, 16, 31, 31);
+	RotateBlendedLookupTable(16, 31, 31);
+	EXPECT_EQ(std::memcmp(expected, paletteTransparencyLookup, sizeof(expected)), 0);
+
+#if DEVILUTIONX_PALETTE_TRANSPARENCY_BLACK_16_LUT
+	RefreshTransparencyLookupBlack16();
+	for (unsigned i = 0; i < 256; ++i) {
+		for (unsigned j = 0; j < 256; ++j) {
+			ASSERT_EQ(paletteTransparencyLookupBlack16[i | (j << 8)], expected[0][i] | (expected[0][j] << 8)) << i << " " << j;
+		}
+	}
+#endif
+}
+
 } // namespace
 } // namespace devilution
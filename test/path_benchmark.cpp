@@ -1,5 +1,6 @@
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 #include <benchmark/benchmark.h>
 #include <utility>
@@ -34,11 +35,11 @@ std::pair<Point, Point> FindStartDest(const Map &m)
 	return { start, dest };
 }
 
+template <size_t MaxPathLength = MaxPathLengthMonsters>
 void BenchmarkMap(const Map &map, benchmark::State &state)
 {
 	const auto [start, dest] = FindStartDest(map);
 	const auto posOk = /*posOk=*/[&map](Point p) { return map[p] != '#'; };
-	constexpr size_t MaxPathLength = 25;
 	for (auto _ : state) {
 		int8_t path[MaxPathLength];
 		int result = FindPath(/*canStep=*/[](Point, Point) { return true; },
@@ -47,6 +48,44 @@ void BenchmarkMap(const Map &map, benchmark::State &state)
 	}
 }
 
+/**
+ * @brief Builds a dungeon-sized map that is walled in, with the start and destination on the same row.
+ *
+ * @param wallSpacing If non-zero, the map is crossed by vertical walls this many tiles apart,
+ * each with a single gap at a pseudo-random row at most 10 tiles away from the start.
+ */
+std::string MakeDungeonMap(Size size, Point start, Point dest, int wallSpacing)
+{
+	std::string data(static_cast<size_t>(size.width * size.height), '.');
+	uint32_t seed = 1;
+	for (int x = 0; x < size.width; ++x) {
+		const bool isWall = x == 0 || x == size.width - 1 || (wallSpacing != 0 && x % wallSpacing == 0);
+		seed = seed * 1103515245 + 12345;
+		const int gap = start.y - 10 + static_cast<int>((seed >> 16) % 21);
+		for (int y = 0; y < size.height; ++y) {
+			if (y == 0 || y == size.height - 1 || (isWall && (y != gap || x == 0 || x == size.width - 1)))
+				data[y * size.width + x] = '#';
+		}
+	}
+	data[start.y * size.width + start.x] = 'S';
+	data[dest.y * size.width + dest.x] = 'E';
+	return data;
+}
+
+void BM_LargeOpenMap(benchmark::State &state)
+{
+	constexpr Size MapSize { 112, 112 };
+	const std::string data = MakeDungeonMap(MapSize, { 10, 20 }, { 100, 80 }, /*wallSpacing=*/0);
+	BenchmarkMap<MaxPathLengthPlayer>(Map { MapSize, data.c_str() }, state);
+}
+
+void BM_LargeMaze(benchmark::State &state)
+{
+	constexpr Size MapSize { 112, 112 };
+	const std::string data = MakeDungeonMap(MapSize, { 4, 56 }, { 92, 56 }, /*wallSpacing=*/8);
+	BenchmarkMap<MaxPathLengthPlayer>(Map { MapSize, data.c_str() }, state);
+}
+
 void BM_SinglePath(benchmark::State &state)
 {
 	BenchmarkMap(
@@ -158,6 +197,8 @@ BENCHMARK(BM_SinglePath);
 BENCHMARK(BM_Bridges);
 BENCHMARK(BM_NoPath);
 BENCHMARK(BM_NoPathBig);
+BENCHMARK(BM_LargeOpenMap);
+BENCHMARK(BM_LargeMaze);
 
 } // namespace
 } // namespace devilution
@@ -4,6 +4,7 @@
 #include <array>
 #include <cstddef>
 #include <span>
+#include <string_view>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -162,6 +163,67 @@ TEST(PathTest, LongPaths)
 	CheckPath(startingPosition, startingPosition + Displacement { 25, 25 }, {});
 }
 
+TEST(PathTest, DistanceFieldFindsShortestPaths)
+{
+	constexpr int Size = 15;
+	constexpr std::string_view Map = "###############"
+	                                 "#...#...#.....#"
+	                                 "#.#.#.#.#.###.#"
+	                                 "#.#...#.#.#...#"
+	                                 "#######.#.#.###"
+	                                 "##...##.#.#...#"
+	                                 "#######.#.###.#"
+	                                 "###...#...#...#"
+	                                 "###.#######.###"
+	                                 "#...###...#...#"
+	                                 "#.#####.#.###.#"
+	                                 "#.#...#.#.#...#"
+	                                 "#.#.#.#.#.#.###"
+	                                 "#...#...#...###"
+	                                 "###############";
+	const auto posOk = [&](Point p) { return p.x >= 0 && p.y >= 0 && p.x < Size && p.y < Size && Map[p.y * Size + p.x] != '#'; };
+	const auto canStep = [](Point, Point) { return true; };
+	constexpr Point Destination { 11, 5 };
+	constexpr size_t MaxPathLength = 25;
+
+	// Steps are numbered like Dir.
+	constexpr Displacement StepDisplacements[9] = { { 0, 0 }, { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 }, { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+	const auto stepCost = [](Displacement d) { return d.deltaX != 0 && d.deltaY != 0 ? PathDiagonalStepCost : PathAxisAlignedStepCost; };
+
+	PathDistanceField field;
+	field.build(canStep, posOk, Destination, MaxPathLength);
+	EXPECT_EQ(field.getFirstStep(canStep, Destination), -1);
+
+	for (int y = 0; y < Size; ++y) {
+		for (int x = 0; x < Size; ++x) {
+			const Point start { x, y };
+			if (!posOk(start) || start == Destination) continue;
+
+			int8_t path[MaxPathLength];
+			const int pathLength = FindPath(canStep, posOk, start, Destination, path, MaxPathLength);
+			int expectedCost = 0;
+			for (int i = 0; i < pathLength; ++i)
+				expectedCost += stepCost(StepDisplacements[path[i]]);
+
+			int cost = 0;
+			Point position = start;
+			for (size_t i = 0; i < MaxPathLength && position != Destination; ++i) {
+				const int8_t step = field.getFirstStep(canStep, position);
+				if (step == -1) break;
+				position += StepDisplacements[step];
+				cost += stepCost(StepDisplacements[step]);
+			}
+
+			if (pathLength == 0) {
+				EXPECT_NE(position, Destination) << "Only the distance field found a path from " << start;
+			} else {
+				EXPECT_EQ(position, Destination) << "No path from " << start;
+				EXPECT_EQ(cost, expectedCost) << "Path from " << start << " is not the shortest";
+			}
+		}
+	}
+}
+
 TEST(PathTest, FindClosest)
 {
 	{
@@ -0,0 +1,111 @@
+#include <iterator>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "utils/slot_map.hpp"
+
+using namespace devilution;
+
+namespace {
+
+template <typename T, size_t ChunkSize>
+std::vector<T> ToVector(const SlotMap<T, ChunkSize> &map)
+{
+	return std::vector<T>(map.begin(), map.end());
+}
+
+TEST(SlotMap, IteratesInInsertionOrder)
+{
+	SlotMap<int, 4> map;
+	for (int i = 0; i < 10; ++i) {
+		map.emplace_back(i);
+	}
+	EXPECT_EQ(map.size(), 10);
+	EXPECT_EQ(map.capacity(), 12);
+	EXPECT_EQ(ToVector(map), (std::vector<int> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+	EXPECT_EQ(map.front(), 0);
+	EXPECT_EQ(map.back(), 9);
+}
+
+TEST(SlotMap, RemoveIfKeepsOrder)
+{
+	SlotMap<int, 4> map;
+	for (int i = 0; i < 10; ++i) {
+		map.emplace_back(i);
+	}
+	EXPECT_EQ(map.remove_if([](int value) { return value % 3 == 0; }), 4);
+	EXPECT_EQ(ToVector(map), (std::vector<int> { 1, 2, 4, 5, 7, 8 }));
+}
+
+TEST(SlotMap, ReusesFreeSlots)
+{
+	SlotMap<int, 4> map;
+	for (int i = 0; i < 8; ++i) {
+		map.emplace_back(i);
+	}
+	const int *third = &*std::next(map.begin(), 2);
+	map.remove_if([](int value) { return value == 2; });
+	const int &added = map.emplace_back(8);
+	EXPECT_EQ(&added, third);
+	EXPECT_EQ(map.capacity(), 8);
+	// New elements are still visited last.
+	EXPECT_EQ(ToVector(map), (std::vector<int> { 0, 1, 3, 4, 5, 6, 7, 8 }));
+}
+
+TEST(SlotMap, AddressesAreStable)
+{
+	SlotMap<int, 4> map;
+	const int *first = &map.emplace_back(0);
+	for (int i = 1; i < 100; ++i) {
+		map.emplace_back(i);
+	}
+	EXPECT_EQ(first, &map.front());
+}
+
+TEST(SlotMap, VisitsElementsAddedDuringIteration)
+{
+	SlotMap<int, 4> map;
+	map.emplace_back(3);
+	std::vector<int> visited;
+	for (const int value : map) {
+		visited.push_back(value);
+		if (value > 0)
+			map.emplace_back(value - 1);
+	}
+	EXPECT_EQ(visited, (std::vector<int> { 3, 2, 1, 0 }));
+}
+
+TEST(SlotMap, HandlesAreInvalidatedOnRemoval)
+{
+	SlotMap<int, 4> map;
+	map.emplace_back(1);
+	map.emplace_back(2);
+	const SlotMap<int, 4>::Handle handle = map.handleOf(map.back());
+	ASSERT_NE(map.get(handle), nullptr);
+	EXPECT_EQ(*map.get(handle), 2);
+
+	map.remove_if([](int value) { return value == 2; });
+	EXPECT_EQ(map.get(handle), nullptr);
+
+	// The slot is reused, but the old handle still refers to the removed element.
+	map.emplace_back(3);
+	EXPECT_EQ(map.get(handle), nullptr);
+	EXPECT_EQ(*map.get(map.handleOf(map.back())), 3);
+}
+
+TEST(SlotMap, ClearStartsFromFirstSlot)
+{
+	SlotMap<int, 4> map;
+	const int *first = &map.emplace_back(0);
+	for (int i = 1; i < 6; ++i) {
+		map.emplace_back(i);
+	}
+	map.remove_if([](int value) { return value == 4; });
+	map.clear();
+	EXPECT_TRUE(map.empty());
+	EXPECT_EQ(map.capacity(), 8);
+	EXPECT_EQ(&map.emplace_back(10), first);
+}
+
+} // namespace
@@ -0,0 +1,184 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <asio/connect.hpp>
+#include <gtest/gtest.h>
+
+#include "dvlnet/frame_queue.h"
+#include "dvlnet/packet.h"
+#include "dvlnet/tcp_server.h"
+
+namespace devilution {
+namespace net {
+namespace {
+
+/** @brief A player connected to the server over loopback, speaking the protocol by hand. */
+class TestPlayer {
+public:
+	TestPlayer(asio::io_context &ioc, packet_factory &pktfty)
+	    : socket_(ioc)
+	    , pktfty_(pktfty)
+	{
+	}
+
+	void Connect(unsigned short port)
+	{
+		socket_.connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port));
+		socket_.non_blocking(true);
+	}
+
+	template <packet_type t, typename... Args>
+	void Send(Args... args)
+	{
+		tl::expected<std::unique_ptr<packet>, PacketError> pkt = pktfty_.make_packet<t>(args...);
+		ASSERT_TRUE(pkt.has_value());
+		tl::expected<buffer_t, PacketError> frame = frame_queue::MakeFrame((*pkt)->Data());
+		ASSERT_TRUE(frame.has_value());
+		asio::write(socket_, asio::buffer(*frame));
+	}
+
+	/** @brief Reads everything that has arrived so far. */
+	std::vector<std::unique_ptr<packet>> Receive()
+	{
+		std::vector<std::unique_ptr<packet>> packets;
+		while (true) {
+			const std::span<unsigned char> buf = recvQueue_.WriteBuffer(frame_queue::max_frame_size);
+			asio::error_code ec;
+			const size_t bytesRead = socket_.read_some(asio::buffer(buf.data(), buf.size()), ec);
+			if (ec)
+				break;
+			recvQueue_.CommitWrite(bytesRead);
+		}
+		while (recvQueue_.PacketReady().value_or(false)) {
+			tl::expected<std::unique_ptr<packet>, PacketError> pkt
+			    = recvQueue_.ReadPacket().and_then([&](std::span<const unsigned char> data) { return pktfty_.make_packet(data); });
+			if (pkt.has_value())
+				packets.push_back(std::move(*pkt));
+		}
+		return packets;
+	}
+
+private:
+	asio::ip::tcp::socket socket_;
+	packet_factory &pktfty_;
+	frame_queue recvQueue_;
+};
+
+class TcpServerTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		server_ = std::make_unique<tcp_server>(ioc_, "127.0.0.1", 0, pktfty_);
+	}
+
+	/** @brief Lets the server process everything that the players have sent. */
+	void RunServer()
+	{
+		ioc_.run_for(std::chrono::milliseconds(50));
+	}
+
+	/**
+	 * @brief Joins a new player and returns its ID.
+	 *
+	 * @param features The features that the player advertises, or std::nullopt for a build that predates them.
+	 * @param answerEcho Whether to answer the server's echo request right away.
+	 */
+	plr_t Join(TestPlayer &player, std::optional<features_t> features, bool answerEcho = true)
+	{
+		player.Connect(server_->Port());
+		// A valid `GameData` starts with its size.
+		const buffer_t gameData { 8, 0, 0, 0, 1, 2, 3, 4 };
+		player.Send<PT_JOIN_REQUEST>(PLR_BROADCAST, PLR_MASTER, cookie_t { 42 }, gameData);
+		RunServer();
+		plr_t self = PLR_BROADCAST;
+		for (const std::unique_ptr<packet> &pkt : player.Receive()) {
+			if (pkt->Type() == PT_JOIN_ACCEPT) {
+				self = pkt->NewPlayer().value_or(PLR_BROADCAST);
+			} else if (pkt->Type() == PT_ECHO_REQUEST && answerEcho) {
+				AnswerEcho(player, self, *pkt, features);
+			}
+		}
+		RunServer();
+		return self;
+	}
+
+	static void AnswerEcho(TestPlayer &player, plr_t self, packet &request, std::optional<features_t> features)
+	{
+		const timestamp_t time = request.Time().value_or(0);
+		if (features)
+			player.Send<PT_ECHO_REPLY>(self, PLR_MASTER, time, *features);
+		else
+			player.Send<PT_ECHO_REPLY>(self, PLR_MASTER, time);
+	}
+
+	asio::io_context ioc_;
+	packet_factory pktfty_;
+	std::unique_ptr<tcp_server> server_;
+};
+
+std::vector<packet_type> ReceivedTypes(TestPlayer &player, plr_t src)
+{
+	std::vector<packet_type> types;
+	for (const std::unique_ptr<packet> &pkt : player.Receive()) {
+		if (pkt->Source() == src)
+			types.push_back(pkt->Type());
+	}
+	return types;
+}
+
+TEST_F(TcpServerTest, RelaysBatchesOnlyToPlayersThatSupportThem)
+{
+	TestPlayer a(ioc_, pktfty_);
+	TestPlayer b(ioc_, pktfty_);
+	TestPlayer c(ioc_, pktfty_);
+	const plr_t playerA = Join(a, FEATURE_BATCH);
+	const plr_t playerB = Join(b, FEATURE_BATCH);
+	ASSERT_EQ(playerA, 0);
+	ASSERT_EQ(playerB, 1);
+
+	// A player running an older build joins while the others are batching, and has not answered the echo yet.
+	const plr_t playerC = Join(c, std::nullopt, /*answerEcho=*/false);
+	ASSERT_EQ(playerC, 2);
+	a.Receive();
+	b.Receive();
+
+	a.Send<PT_BATCH>(playerA, PLR_BROADCAST, buffer_t { 1, 2, 3 });
+	a.Send<PT_TURN>(playerA, PLR_BROADCAST, turn_t { 1, 2 });
+	RunServer();
+	EXPECT_EQ(ReceivedTypes(b, playerA), (std::vector<packet_type> { PT_BATCH, PT_TURN }));
+	EXPECT_EQ(ReceivedTypes(c, playerA), (std::vector<packet_type> { PT_TURN }));
+
+	// Answering without the features field keeps it from receiving batches.
+	c.Send<PT_ECHO_REPLY>(playerC, PLR_MASTER, timestamp_t { 0 });
+	RunServer();
+	a.Send<PT_BATCH>(playerA, PLR_BROADCAST, buffer_t { 4, 5, 6 });
+	a.Send<PT_BATCH>(playerA, playerC, buffer_t { 7, 8, 9 });
+	a.Send<PT_MESSAGE>(playerA, PLR_BROADCAST, buffer_t { 10 });
+	RunServer();
+	EXPECT_EQ(ReceivedTypes(b, playerA), (std::vector<packet_type> { PT_BATCH, PT_MESSAGE }));
+	EXPECT_EQ(ReceivedTypes(c, playerA), (std::vector<packet_type> { PT_MESSAGE }));
+}
+
+TEST_F(TcpServerTest, RejectsJoinsUntilAGameIsCreated)
+{
+	TestPlayer joiner(ioc_, pktfty_);
+	joiner.Connect(server_->Port());
+	// Players joining a game send no game info.
+	joiner.Send<PT_JOIN_REQUEST>(PLR_BROADCAST, PLR_MASTER, cookie_t { 42 }, buffer_t {});
+	RunServer();
+	const std::vector<std::unique_ptr<packet>> packets = joiner.Receive();
+	ASSERT_EQ(packets.size(), 1);
+	EXPECT_EQ(packets[0]->Type(), PT_DISCONNECT);
+	EXPECT_EQ(packets[0]->NewPlayer().value_or(0), PLR_BROADCAST);
+	EXPECT_EQ(packets[0]->LeaveInfo().value_or(0), static_cast<leaveinfo_t>(LEAVE_NO_GAME));
+
+	// The rejected player does not take up a slot.
+	TestPlayer creator(ioc_, pktfty_);
+	EXPECT_EQ(Join(creator, FEATURE_BATCH), 0);
+}
+
+} // namespace
+} // namespace net
+} // namespace devilution
@@ -0,0 +1,141 @@
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "dvlnet/turn_batch.h"
+
+namespace devilution {
+namespace net {
+namespace {
+
+struct DecodedBatch {
+	std::vector<turn_t> turns;
+	std::vector<buffer_t> messages;
+};
+
+tl::expected<DecodedBatch, PacketError> Decode(batch_decoder &decoder, const buffer_t &payload)
+{
+	DecodedBatch result;
+	tl::expected<void, PacketError> status = decoder.Decode(
+	    payload,
+	    [&](turn_t turn) { result.turns.push_back(turn); },
+	    [&](std::span<const unsigned char> message) { result.messages.emplace_back(message.begin(), message.end()); });
+	if (!status.has_value())
+		return tl::make_unexpected(status.error());
+	return result;
+}
+
+void ExpectTurn(const turn_t &actual, seq_t sequenceNumber, int32_t value)
+{
+	EXPECT_EQ(actual.SequenceNumber, sequenceNumber);
+	EXPECT_EQ(actual.Value, value);
+}
+
+TEST(TurnBatchTest, RoundTrip)
+{
+	batch_encoder encoder;
+	encoder.AddTurn({ 5, 1000 });
+	encoder.AddTurn({ 6, 1001 });
+	const buffer_t message { 1, 2, 3 };
+	encoder.AddMessage(message);
+	encoder.AddTurn({ 7, static_cast<int32_t>(0x80000000) });
+	const buffer_t payload = encoder.Finish();
+	EXPECT_TRUE(encoder.empty());
+
+	batch_decoder decoder;
+	tl::expected<DecodedBatch, PacketError> decoded = Decode(decoder, payload);
+	ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+	ASSERT_EQ(decoded->turns.size(), 3);
+	ExpectTurn(decoded->turns[0], 5, 1000);
+	ExpectTurn(decoded->turns[1], 6, 1001);
+	ExpectTurn(decoded->turns[2], 7, static_cast<int32_t>(0x80000000));
+	ASSERT_EQ(decoded->messages.size(), 1);
+	EXPECT_EQ(decoded->messages[0], message);
+}
+
+TEST(TurnBatchTest, DeltaEncodesTurnsAcrossPayloads)
+{
+	batch_encoder encoder;
+	batch_decoder decoder;
+	encoder.AddTurn({ 255, 123456 });
+	ASSERT_TRUE(Decode(decoder, encoder.Finish()).has_value());
+
+	encoder.AddTurn({ 0, 123457 });
+	const buffer_t payload = encoder.Finish();
+	// Flags, entry type and a one byte difference.
+	EXPECT_EQ(payload.size(), 3);
+	tl::expected<DecodedBatch, PacketError> decoded = Decode(decoder, payload);
+	ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+	ASSERT_EQ(decoded->turns.size(), 1);
+	ExpectTurn(decoded->turns[0], 0, 123457);
+}
+
+TEST(TurnBatchTest, SkipsDeltaWithoutPreviousTurn)
+{
+	batch_encoder encoder;
+	encoder.AddTurn({ 1, 10 });
+	encoder.Finish();
+	encoder.AddTurn({ 2, 11 });
+	const buffer_t message { 4, 5 };
+	encoder.AddMessage(message);
+
+	batch_decoder decoder;
+	tl::expected<DecodedBatch, PacketError> decoded = Decode(decoder, encoder.Finish());
+	ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+	EXPECT_TRUE(decoded->turns.empty());
+	ASSERT_EQ(decoded->messages.size(), 1);
+	EXPECT_EQ(decoded->messages[0], message);
+}
+
+TEST(TurnBatchTest, ResetSendsFullTurn)
+{
+	batch_encoder encoder;
+	encoder.AddTurn({ 1, 10 });
+	encoder.Finish();
+	encoder.Reset();
+	encoder.AddTurn({ 2, 11 });
+
+	batch_decoder decoder;
+	tl::expected<DecodedBatch, PacketError> decoded = Decode(decoder, encoder.Finish());
+	ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+	ASSERT_EQ(decoded->turns.size(), 1);
+	ExpectTurn(decoded->turns[0], 2, 11);
+}
+
+TEST(TurnBatchTest, CompressesLargePayloads)
+{
+	batch_encoder encoder;
+	buffer_t message(400);
+	for (size_t i = 0; i < message.size(); ++i)
+		message[i] = static_cast<unsigned char>(i % 8);
+	encoder.AddMessage(message);
+	encoder.AddMessage(message);
+	const size_t uncompressedSize = encoder.size();
+	const buffer_t payload = encoder.Finish();
+	EXPECT_LT(payload.size(), uncompressedSize);
+
+	batch_decoder decoder;
+	tl::expected<DecodedBatch, PacketError> decoded = Decode(decoder, payload);
+	ASSERT_TRUE(decoded.has_value()) << decoded.error().what();
+	ASSERT_EQ(decoded->messages.size(), 2);
+	EXPECT_EQ(decoded->messages[0], message);
+	EXPECT_EQ(decoded->messages[1], message);
+}
+
+TEST(TurnBatchTest, RejectsTruncatedPayload)
+{
+	batch_encoder encoder;
+	encoder.AddMessage(buffer_t { 1, 2, 3 });
+	buffer_t payload = encoder.Finish();
+	payload.pop_back();
+
+	batch_decoder decoder;
+	EXPECT_FALSE(Decode(decoder, payload).has_value());
+	EXPECT_FALSE(Decode(decoder, buffer_t {}).has_value());
+}
+
+} // namespace
+} // namespace net
+} // namespace devilution
@@ -0,0 +1,71 @@
+#include "engine/render/upscale.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace devilution {
+namespace {
+
+constexpr int Pitch = 160;
+
+std::vector<uint8_t> MakeImage()
+{
+	std::vector<uint8_t> pixels(Pitch * 100);
+	for (size_t i = 0; i < pixels.size(); ++i) {
+		pixels[i] = static_cast<uint8_t>(i * 7 + i / Pitch);
+	}
+	return pixels;
+}
+
+/** @brief Reference implementation: the first row and column take the remainder. */
+std::vector<uint8_t> UpscaleNaive(std::vector<uint8_t> pixels, unsigned dstOffsetX, unsigned dstWidth, unsigned dstHeight, unsigned factor)
+{
+	const std::vector<uint8_t> src = pixels;
+	const unsigned firstColumnCopies = dstWidth - (dstWidth - 1) / factor * factor;
+	const unsigned firstRowCopies = dstHeight - (dstHeight - 1) / factor * factor;
+	for (unsigned y = 0; y < dstHeight; ++y) {
+		const unsigned srcY = y < firstRowCopies ? 0 : 1 + (y - firstRowCopies) / factor;
+		for (unsigned x = 0; x < dstWidth; ++x) {
+			const unsigned srcX = x < firstColumnCopies ? 0 : 1 + (x - firstColumnCopies) / factor;
+			pixels[y * Pitch + dstOffsetX + x] = src[srcY * Pitch + srcX];
+		}
+	}
+	return pixels;
+}
+
+TEST(UpscaleTest, MatchesNaive)
+{
+	for (unsigned factor = 1; factor <= 5; ++factor) {
+		for (unsigned dstOffsetX : { 0, 3, 16 }) {
+			for (unsigned dstWidth : { 1, 2, 17, 64, 97, 141 }) {
+				if (dstOffsetX + dstWidth > Pitch) continue;
+				for (unsigned dstHeight : { 1, 7, 40, 99 }) {
+					std::vector<uint8_t> pixels = MakeImage();
+					const std::vector<uint8_t> expected = UpscaleNaive(pixels, dstOffsetX, dstWidth, dstHeight, factor);
+					UpscaleInPlace(pixels.data(), Pitch, dstOffsetX, dstWidth, dstHeight, factor);
+					ASSERT_EQ(pixels, expected) << "factor " << factor << " offset " << dstOffsetX << " size " << dstWidth << "x" << dstHeight;
+				}
+			}
+		}
+	}
+}
+
+TEST(UpscaleTest, RowOverlappingSource)
+{
+	for (unsigned factor = 1; factor <= 5; ++factor) {
+		std::vector<uint8_t> row = MakeImage();
+		row.resize(Pitch);
+		const std::vector<uint8_t> src = row;
+		UpscaleRow(row.data(), row.data(), 150, factor);
+		const unsigned firstPixelCopies = 150 - (150 - 1) / factor * factor;
+		for (unsigned x = 0; x < 150; ++x) {
+			const unsigned srcX = x < firstPixelCopies ? 0 : 1 + (x - firstPixelCopies) / factor;
+			ASSERT_EQ(row[x], src[srcX]) << "factor " << factor << " x " << x;
+		}
+	}
+}
+
+} // namespace
+} // namespace devilution